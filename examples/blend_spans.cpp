@@ -0,0 +1,278 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_pixfmt_rgba.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+enum flip_y_e { flip_y = true };
+
+typedef agg::pixfmt_bgra32       pixfmt;
+typedef agg::pixfmt_bgra32_pre   pixfmt_pre;
+typedef agg::pixfmt_bgra32_plain pixfmt_plain;
+#define pix_format agg::pix_format_bgra32
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+//----------------------------------------------------------------------------
+// The spans blended pixel by pixel, the way pixfmt_alpha_blend_rgba does
+// it without span_blender_rgba. It's the reference for both, the speed
+// and the result.
+template<class PixFmt> struct per_pixel_blender
+{
+    typedef typename PixFmt::color_type color_type;
+    typedef typename PixFmt::value_type value_type;
+    typedef typename PixFmt::blender_type blender_type;
+    typedef typename PixFmt::cob_type cob_type;
+    typedef typename PixFmt::order_type order_type;
+
+    static void blend_solid_hspan(PixFmt& pixf, int x, int y, unsigned len,
+                                  const color_type& c, const agg::int8u* covers)
+    {
+        value_type* p = (value_type*)pixf.pix_ptr(x, y);
+        do
+        {
+            unsigned alpha = (unsigned(c.a) * (unsigned(*covers) + 1)) >> 8;
+            if(alpha == color_type::base_mask)
+            {
+                p[order_type::R] = c.r;
+                p[order_type::G] = c.g;
+                p[order_type::B] = c.b;
+                p[order_type::A] = color_type::base_mask;
+            }
+            else
+            {
+                blender_type::blend_pix(p, c.r, c.g, c.b, alpha, *covers);
+            }
+            p += 4;
+            ++covers;
+        }
+        while(--len);
+    }
+
+    static void blend_color_hspan(PixFmt& pixf, int x, int y, unsigned len,
+                                  const color_type* colors, const agg::int8u* covers)
+    {
+        value_type* p = (value_type*)pixf.pix_ptr(x, y);
+        do
+        {
+            cob_type::copy_or_blend_pix(p, colors->r, colors->g, colors->b, colors->a,
+                                        *covers++);
+            p += 4;
+            ++colors;
+        }
+        while(--len);
+    }
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8> m_blender;
+
+public:
+    typedef agg::renderer_base<pixfmt>       renderer_base;
+    typedef agg::renderer_base<pixfmt_pre>   renderer_base_pre;
+    typedef agg::renderer_base<pixfmt_plain> renderer_base_plain;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_blender(5.0, 5.0, 130.0, 60.0, !flip_y)
+    {
+        parse_lion();
+        add_ctrl(m_blender);
+        m_blender.add_item("blender_rgba");
+        m_blender.add_item("blender_rgba_pre");
+        m_blender.add_item("blender_rgba_plain");
+        m_blender.cur_item(0);
+    }
+
+    template<class RenBase> void draw_lion(RenBase& rb)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::trans_affine mtx;
+        double s = (width() < height() ? width() : height()) / (g_y2 - g_y1);
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(width() / 2, height() / 2);
+        agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+        agg::renderer_scanline_aa_solid<RenBase> r(rb);
+        agg::render_all_paths(ras, sl, r, trans, g_colors, g_path_idx, g_npaths);
+    }
+
+    virtual void on_draw()
+    {
+        switch(m_blender.cur_item())
+        {
+        case 0:
+            {
+                pixfmt pixf(rbuf_window());
+                renderer_base rb(pixf);
+                rb.clear(agg::rgba(1, 1, 1));
+                draw_lion(rb);
+            }
+            break;
+
+        case 1:
+            {
+                pixfmt_pre pixf(rbuf_window());
+                renderer_base_pre rb(pixf);
+                rb.clear(agg::rgba(1, 1, 1));
+                draw_lion(rb);
+            }
+            break;
+
+        case 2:
+            {
+                pixfmt_plain pixf(rbuf_window());
+                renderer_base_plain rb(pixf);
+                rb.clear(agg::rgba(1, 1, 1));
+                draw_lion(rb);
+            }
+            break;
+        }
+
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_blender);
+    }
+
+    // Blends "num_spans" spans of random length up to "max_len" with
+    // random covers and colors; solid spans if "solid" is true.
+    // Returns the time in milliseconds.
+    template<class PixFmt> double run_spans(bool per_pixel, bool solid,
+                                            agg::int8u* buf, unsigned w, unsigned h,
+                                            unsigned num_spans, unsigned max_len)
+    {
+        typedef typename PixFmt::color_type color_type;
+        agg::rendering_buffer rbuf(buf, w, h, w * 4);
+        PixFmt pixf(rbuf);
+        memset(buf, 0x80, w * h * 4);
+
+        agg::int8u* covers = new agg::int8u[w];
+        color_type* colors = new color_type[w];
+        unsigned i;
+        for(i = 0; i < w; i++)
+        {
+            covers[i] = (i & 7) ? 255 : agg::int8u(rand());
+            colors[i] = color_type(rand() & 0xFF, rand() & 0xFF, rand() & 0xFF, rand() & 0xFF);
+        }
+
+        srand(321);
+        start_timer();
+        for(i = 0; i < num_spans; i++)
+        {
+            unsigned len = 1 + rand() % max_len;
+            int x = rand() % (w - len + 1);
+            int y = rand() % h;
+            color_type c = colors[i % w];
+            c.a = c.a | 1;
+            if(solid)
+            {
+                if(per_pixel) per_pixel_blender<PixFmt>::blend_solid_hspan(pixf, x, y, len, c, covers);
+                else          pixf.blend_solid_hspan(x, y, len, c, covers);
+            }
+            else
+            {
+                if(per_pixel) per_pixel_blender<PixFmt>::blend_color_hspan(pixf, x, y, len, colors, covers);
+                else          pixf.blend_color_hspan(x, y, len, colors, covers, 255);
+            }
+        }
+        double t = elapsed_time();
+        delete [] colors;
+        delete [] covers;
+        return t;
+    }
+
+    template<class PixFmt> void run_test(const char* name, char* buf)
+    {
+        const unsigned w = 1024;
+        const unsigned h = 256;
+        const unsigned num_spans = 200000;
+        const unsigned max_len = 256;
+        agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+        agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+
+        sprintf(buf + strlen(buf), "%s:", name);
+        unsigned solid;
+        for(solid = 0; solid < 2; solid++)
+        {
+            srand(123);
+            double t0 = run_spans<PixFmt>(true, solid != 0, ref_buf, w, h, num_spans, max_len);
+            srand(123);
+            double t1 = run_spans<PixFmt>(false, solid != 0, tst_buf, w, h, num_spans, max_len);
+            double pixels = num_spans * (max_len + 1) / 2.0;
+            bool identical = memcmp(ref_buf, tst_buf, w * h * 4) == 0;
+            sprintf(buf + strlen(buf), " %s: per-pixel=%.1f span=%.1f Mpix/sec (x%.2f)%s",
+                    solid ? "solid" : "color",
+                    pixels / (t0 + 1e-6) / 1000.0,
+                    pixels / (t1 + 1e-6) / 1000.0,
+                    t0 / (t1 + 1e-6),
+                    identical ? "" : " !DIFF");
+        }
+        strcat(buf, "\n");
+        delete [] tst_buf;
+        delete [] ref_buf;
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            char buf[1024];
+            buf[0] = 0;
+            run_test<pixfmt>      ("blender_rgba",       buf);
+            run_test<pixfmt_pre>  ("blender_rgba_pre",   buf);
+            run_test<pixfmt_plain>("blender_rgba_plain", buf);
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Blending Spans (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
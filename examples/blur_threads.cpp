@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_blur.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_method;
+    agg::slider_ctrl<agg::rgba8> m_radius;
+    agg::slider_ctrl<agg::rgba8> m_threads;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::recursive_blur<agg::rgba8, agg::recursive_blur_calc_rgba<> > recursive_blur_type;
+    typedef agg::stack_blur<agg::rgba8, agg::stack_blur_calc_rgba<> > stack_blur_type;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_method (5.0, 5.0, 150.0, 45.0, !flip_y),
+        m_radius (160, 5,  512-5, 12, !flip_y),
+        m_threads(160, 20, 512-5, 27, !flip_y)
+    {
+        parse_lion();
+
+        add_ctrl(m_method);
+        m_method.add_item("Stack Blur");
+        m_method.add_item("Recursive Blur");
+        m_method.cur_item(0);
+
+        add_ctrl(m_radius);
+        m_radius.range(0, 254);
+        m_radius.value(10);
+        m_radius.label("Blur Radius=%.0f");
+
+        add_ctrl(m_threads);
+        m_threads.range(1, 16);
+        m_threads.num_steps(15);
+        m_threads.value(4);
+        m_threads.label("Threads=%.0f");
+    }
+
+    void draw_lion(renderer_base& rb, double w, double h)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::trans_affine mtx;
+        double s = (w < h ? w : h) / (g_y2 - g_y1);
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+        agg::renderer_scanline_aa_solid<renderer_base> r(rb);
+        agg::render_all_paths(ras, sl, r, trans, g_colors, g_path_idx, g_npaths);
+    }
+
+    void blur(pixfmt& pixf, unsigned method, unsigned radius, unsigned threads)
+    {
+        if(method == 0)
+        {
+            agg::stack_blur_rgba32(pixf, radius, radius, threads);
+        }
+        else
+        {
+            recursive_blur_type rb;
+            rb.num_threads(threads);
+            rb.blur(pixf, radius);
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+        draw_lion(rb, width(), height());
+
+        blur(pixf,
+             m_method.cur_item(),
+             unsigned(m_radius.value()),
+             unsigned(m_threads.value()));
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_method);
+        agg::render_ctrl(ras, sl, rb, m_radius);
+        agg::render_ctrl(ras, sl, rb, m_threads);
+    }
+
+    // Blurs a 1920x1080 image with radii 1...254, one thread and
+    // "Threads" threads, and checks that the results are identical.
+    // Then compares the vertical pass of stack_blur<> on a 4K image.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            static const unsigned radii[] = { 1, 2, 4, 8, 16, 32, 64, 128, 254 };
+            static const char* method_names[] = { "Stack", "Recursive" };
+            const unsigned w = 1920;
+            const unsigned h = 1080;
+            unsigned threads = unsigned(m_threads.value());
+            char buf[2048];
+
+            agg::int8u* src_buf = new agg::int8u[w * h * 4];
+            agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+            agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+            agg::rendering_buffer src_rbuf(src_buf, w, h, w * 4);
+            agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+            pixfmt src_pixf(src_rbuf);
+            pixfmt ref_pixf(ref_rbuf);
+            pixfmt tst_pixf(tst_rbuf);
+            renderer_base src_ren(src_pixf);
+            src_ren.clear(agg::rgba(1, 1, 1));
+            draw_lion(src_ren, w, h);
+
+            sprintf(buf, "1920x1080, 1 thread vs %u threads:\n", threads);
+            unsigned method;
+            for(method = 0; method < 2; method++)
+            {
+                sprintf(buf + strlen(buf), "%s:", method_names[method]);
+                unsigned i;
+                for(i = 0; i < sizeof(radii) / sizeof(radii[0]); i++)
+                {
+                    memcpy(ref_buf, src_buf, w * h * 4);
+                    memcpy(tst_buf, src_buf, w * h * 4);
+                    start_timer();
+                    blur(ref_pixf, method, radii[i], 1);
+                    double t1 = elapsed_time();
+                    start_timer();
+                    blur(tst_pixf, method, radii[i], threads);
+                    double t2 = elapsed_time();
+                    bool identical = memcmp(ref_buf, tst_buf, w * h * 4) == 0;
+                    sprintf(buf + strlen(buf), " r=%u:%.1f/%.1fms%s",
+                            radii[i], t1, t2, identical ? "" : "!DIFF");
+                }
+                strcat(buf, "\n");
+            }
+            delete [] tst_buf;
+            delete [] ref_buf;
+            delete [] src_buf;
+
+            // The vertical pass of stack_blur<> on a 4K image: column by 
+            // column through pixfmt_transposer vs pixfmt_transposed_strip.
+            const unsigned w4 = 3840;
+            const unsigned h4 = 2160;
+            ref_buf = new agg::int8u[w4 * h4 * 4];
+            tst_buf = new agg::int8u[w4 * h4 * 4];
+            ref_rbuf.attach(ref_buf, w4, h4, w4 * 4);
+            tst_rbuf.attach(tst_buf, w4, h4, w4 * 4);
+            renderer_base ref_ren(ref_pixf);
+            ref_ren.clear(agg::rgba(1, 1, 1));
+            draw_lion(ref_ren, w4, h4);
+            memcpy(tst_buf, ref_buf, w4 * h4 * 4);
+
+            stack_blur_type sb;
+            agg::pixfmt_transposer<pixfmt> transposer(ref_pixf);
+            start_timer();
+            sb.blur_x(transposer, 16);
+            double t1 = elapsed_time();
+            start_timer();
+            sb.blur_y(tst_pixf, 16);
+            double t2 = elapsed_time();
+            bool identical = memcmp(ref_buf, tst_buf, w4 * h4 * 4) == 0;
+            sprintf(buf + strlen(buf), 
+                    "stack_blur<>::blur_y 3840x2160: transposer=%.1fms strip=%.1fms%s\n",
+                    t1, t2, identical ? "" : " !DIFF");
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Blur in Parallel (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
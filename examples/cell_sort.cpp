@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_conv_stroke.h"
+#include "agg_bounding_rect.h"
+#include "agg_gsv_text.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+inline double frand(double x)
+{
+    return ((((rand() << 15) | rand()) & 0x3FFFFFFF) % 1000000) * x / 1000000.0;
+}
+
+static const char g_text[] =
+    "Anti-Grain Geometry is an Open Source, free of charge graphic library, "
+    "written in industrially standard C++. The terms and conditions of use "
+    "AGG are described on The License page. AGG doesn't depend on any "
+    "graphic API or technology. Basically, you can think of AGG as of a "
+    "rendering engine that produces pixel images in memory from some "
+    "vectorial data.";
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_scene;
+    agg::slider_ctrl<agg::rgba8> m_num_points;
+    agg::path_storage            m_poly;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scene(5.0, 5.0, 150.0, 60.0, !flip_y),
+        m_num_points(160, 5, 600-5, 12, !flip_y)
+    {
+        parse_lion();
+
+        add_ctrl(m_scene);
+        m_scene.add_item("Random Polygon");
+        m_scene.add_item("Text");
+        m_scene.add_item("Lion");
+        m_scene.cur_item(0);
+
+        add_ctrl(m_num_points);
+        m_num_points.range(4, 2000);
+        m_num_points.value(200);
+        m_num_points.label("Polygon Points=%.0f");
+    }
+
+    void make_polygon(double w, double h)
+    {
+        srand(100);
+        m_poly.remove_all();
+        unsigned n = unsigned(m_num_points.value());
+        m_poly.move_to(frand(w), frand(h));
+        for(unsigned i = 1; i < n; i++)
+        {
+            m_poly.line_to(frand(w), frand(h));
+        }
+        m_poly.close_polygon();
+    }
+
+    void lion_mtx(agg::trans_affine& mtx, double w, double h)
+    {
+        double s = (w < h ? w : h) / (g_y2 - g_y1);
+        mtx.reset();
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+    }
+
+    // Adds the scene paths one by one into "ras" and calls f(ras, idx)
+    // for each of them.
+    template<class Rasterizer, class Func>
+    void process_scene(unsigned scene, Rasterizer& ras, Func& f, double w, double h)
+    {
+        unsigned i;
+        switch(scene)
+        {
+        case 0:
+            ras.reset();
+            ras.filling_rule(agg::fill_even_odd);
+            ras.add_path(m_poly);
+            f(ras, 0);
+            ras.filling_rule(agg::fill_non_zero);
+            break;
+
+        case 1:
+            {
+                agg::gsv_text txt;
+                agg::conv_stroke<agg::gsv_text> stroke(txt);
+                stroke.width(1.2);
+                txt.size(14.0);
+                txt.line_space(2.0);
+                txt.text(g_text);
+                for(i = 0; i < 20; i++)
+                {
+                    txt.start_point(10.0, 70.0 + i * 20.0);
+                    ras.reset();
+                    ras.add_path(stroke);
+                    f(ras, 0);
+                }
+            }
+            break;
+
+        case 2:
+            {
+                agg::trans_affine mtx;
+                lion_mtx(mtx, w, h);
+                agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+                for(i = 0; i < g_npaths; i++)
+                {
+                    ras.reset();
+                    ras.add_path(trans, g_path_idx[i]);
+                    f(ras, i);
+                }
+            }
+            break;
+        }
+    }
+
+    struct draw_func
+    {
+        agg::scanline_u8* sl;
+        renderer_base*    rb;
+        unsigned          scene;
+
+        template<class Rasterizer> void operator() (Rasterizer& ras, unsigned i)
+        {
+            agg::render_scanlines_aa_solid(ras, *sl, *rb,
+                                           scene == 2 ? g_colors[i] : agg::rgba8(0,0,0,200));
+        }
+    };
+
+    struct sort_func
+    {
+        double   time;
+        unsigned cells;
+        agg::platform_support* app;
+
+        template<class Rasterizer> void operator() (Rasterizer& ras, unsigned)
+        {
+            app->start_timer();
+            ras.sort();
+            time  += app->elapsed_time();
+            cells += ras.total_cells();
+        }
+    };
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+
+        make_polygon(width(), height());
+        draw_func f;
+        f.sl = &sl;
+        f.rb = &rb;
+        f.scene = m_scene.cur_item();
+        process_scene(m_scene.cur_item(), ras, f, width(), height());
+
+        agg::render_ctrl(ras, sl, rb, m_scene);
+        agg::render_ctrl(ras, sl, rb, m_num_points);
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            static const char* scene_names[] = { "Polygon", "Text", "Lion" };
+            static const char* sort_names[] = { "auto", "quick", "radix" };
+            char buf[1024];
+            buf[0] = 0;
+
+            agg::rasterizer_scanline_aa<> ras;
+            make_polygon(width(), height());
+
+            unsigned scene;
+            for(scene = 0; scene < 3; scene++)
+            {
+                sprintf(buf + strlen(buf), "%s:", scene_names[scene]);
+                unsigned s;
+                for(s = 0; s < 3; s++)
+                {
+                    ras.cell_sort(agg::cell_sort_e(s));
+                    sort_func f;
+                    f.time  = 0;
+                    f.cells = 0;
+                    f.app   = this;
+                    unsigned i;
+                    for(i = 0; i < 20; i++)
+                    {
+                        process_scene(scene, ras, f, width(), height());
+                    }
+                    sprintf(buf + strlen(buf), " %s=%.2fM cells/sec",
+                            sort_names[s],
+                            f.cells / (f.time + 1e-6) / 1000.0);
+                }
+                strcat(buf, "\n");
+            }
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Sorting Cells: Quick vs Radix (click to run the test)");
+
+    if(app.init(600, 500, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
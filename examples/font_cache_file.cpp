@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_pixfmt_rgb.h"
+#include "agg_font_freetype.h"
+#include "platform/agg_platform_support.h"
+
+#include "ctrl/agg_cbox_ctrl.h"
+
+enum flip_y_e { flip_y = true };
+
+
+#define pix_format agg::pix_format_bgr24
+typedef agg::pixfmt_bgr24 pixfmt_type;
+
+static const char text[] =
+"Anti-Grain Geometry is designed as a set of loosely coupled "
+"algorithms and class templates united with a common idea, "
+"so that all the components can be easily combined. Also, "
+"the template based design allows you to replace any part of "
+"the library without the necessity to modify a single byte in "
+"the existing code. ";
+
+
+
+class the_application : public agg::platform_support
+{
+    typedef agg::renderer_base<pixfmt_type> base_ren_type;
+    typedef agg::renderer_scanline_aa_solid<base_ren_type> renderer_solid;
+    typedef agg::font_engine_freetype_int32 font_engine_type;
+    typedef agg::font_cache_manager<font_engine_type> font_manager_type;
+
+    agg::cbox_ctrl<agg::rgba8> m_use_file;
+    agg::font_cache_file       m_file;
+
+public:
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_use_file(5, 5, "Use Glyph Cache File", !flip_y)
+    {
+        add_ctrl(m_use_file);
+        m_use_file.status(true);
+    }
+
+    // Requests the printable ASCII glyphs of several sizes in the
+    // native gray8 and outline formats, which is what an application
+    // typically does at startup. Returns false if the font isn't found.
+    bool load_glyphs(font_engine_type& feng, font_manager_type& fman)
+    {
+        static const agg::glyph_rendering gren[] =
+        {
+            agg::glyph_ren_native_gray8,
+            agg::glyph_ren_outline
+        };
+        unsigned i;
+        for(i = 0; i < 2; i++)
+        {
+            if(!feng.load_font(full_file_name("timesi.ttf"), 0, gren[i])) return false;
+            feng.hinting(true);
+            feng.flip_y(false);
+            int h;
+            for(h = 10; h <= 32; h += 2)
+            {
+                feng.height(h);
+                feng.width(h);
+                fman.precache(' ', '~');
+            }
+        }
+        return true;
+    }
+
+    void draw_text(base_ren_type& rb, font_engine_type& feng, font_manager_type& fman)
+    {
+        renderer_solid ren_solid(rb);
+        ren_solid.color(agg::rgba8(0, 0, 0));
+
+        feng.load_font(full_file_name("timesi.ttf"), 0, agg::glyph_ren_native_gray8);
+        feng.hinting(true);
+        feng.flip_y(false);
+        feng.height(16);
+        feng.width(16);
+
+        double x = 10.0;
+        double y = height() - 50.0;
+        const char* p = text;
+        while(*p)
+        {
+            const agg::glyph_cache* glyph = fman.glyph(*p);
+            if(glyph)
+            {
+                fman.add_kerning(&x, &y);
+                if(x >= width() - 20)
+                {
+                    x = 10.0;
+                    y -= 20.0;
+                }
+                fman.init_embedded_adaptors(glyph, x, y);
+                agg::render_scanlines(fman.gray8_adaptor(),
+                                      fman.gray8_scanline(),
+                                      ren_solid);
+                x += glyph->advance_x;
+                y += glyph->advance_y;
+            }
+            ++p;
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt_type pf(rbuf_window());
+        base_ren_type ren_base(pf);
+        ren_base.clear(agg::rgba(1,1,1));
+
+        font_engine_type  feng;
+        font_manager_type fman(feng);
+        if(m_use_file.status())
+        {
+            if(!m_file.is_open()) m_file.open(full_file_name("glyph_cache.dat"));
+            fman.cache_file(&m_file);
+        }
+        draw_text(ren_base, feng, fman);
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, ren_base, m_use_file);
+    }
+
+    // Measures the time to get the glyphs by a new font engine and
+    // cache manager, that is, at the startup, with and without the
+    // glyph cache file. The file is created by the first run.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            const char* file_name = full_file_name("glyph_cache.dat");
+            char buf[256];
+            double t1 = 0;
+            double t2 = 0;
+            unsigned i;
+
+            m_file.close();
+            for(i = 0; i < 5; i++)
+            {
+                start_timer();
+                font_engine_type  feng;
+                font_manager_type fman(feng);
+                if(!load_glyphs(feng, fman))
+                {
+                    message("Please copy file timesi.ttf to the current directory\n"
+                            "or download it from http://www.antigrain.com/timesi.zip");
+                    return;
+                }
+                t1 += elapsed_time();
+                if(i == 0 && !fman.write_cache_file(file_name))
+                {
+                    message("Can't write glyph_cache.dat");
+                    return;
+                }
+            }
+
+            for(i = 0; i < 5; i++)
+            {
+                start_timer();
+                agg::font_cache_file file;
+                file.open(file_name);
+                font_engine_type  feng;
+                font_manager_type fman(feng);
+                fman.cache_file(&file);
+                load_glyphs(feng, fman);
+                t2 += elapsed_time();
+            }
+
+            m_file.open(file_name);
+            FILE* fd = fopen(file_name, "rb");
+            long size = 0;
+            if(fd)
+            {
+                fseek(fd, 0, SEEK_END);
+                size = ftell(fd);
+                fclose(fd);
+            }
+            sprintf(buf, "FreeType: %.2fms\nGlyph cache file: %.2fms (%ld bytes)",
+                    t1 / 5, t2 / 5, size);
+            message(buf);
+            force_redraw();
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Glyph Cache File (click to run the test)");
+
+    if(app.init(640, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_pixfmt_rgb.h"
+#include "agg_glyph_atlas.h"
+#include "agg_font_freetype.h"
+#include "platform/agg_platform_support.h"
+
+#include "ctrl/agg_cbox_ctrl.h"
+
+enum flip_y_e { flip_y = true };
+
+
+#define pix_format agg::pix_format_bgr24
+typedef agg::pixfmt_bgr24 pixfmt_type;
+
+static const char* labels[] =
+{
+    "Main St", "Oak Ave", "Park Rd", "River Ln", "Hill Dr", "Elm St",
+    "Station", "Harbor", "Museum", "Library", "Market Sq", "Bridge Rd",
+    "North Gate", "Old Town", "Mill Pond", "City Hall", "Airport",
+    "Cedar Ct", "Lake View", "West End", "Canal St", "School",
+    0
+};
+
+enum { num_labels = 2000 };
+
+
+
+class the_application : public agg::platform_support
+{
+    typedef agg::renderer_base<pixfmt_type> base_ren_type;
+    typedef agg::renderer_scanline_aa_solid<base_ren_type> renderer_solid;
+    typedef agg::renderer_glyph_atlas<base_ren_type> renderer_atlas;
+    typedef agg::font_engine_freetype_int32 font_engine_type;
+    typedef agg::font_cache_manager<font_engine_type> font_manager_type;
+
+    agg::cbox_ctrl<agg::rgba8> m_use_atlas;
+    font_engine_type           m_feng;
+    font_manager_type          m_fman;
+    agg::glyph_atlas           m_atlas;
+
+public:
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_use_atlas(5, 5, "Use Glyph Atlas", !flip_y),
+        m_fman(m_feng),
+        m_atlas(512, 512)
+    {
+        add_ctrl(m_use_atlas);
+        m_use_atlas.status(true);
+    }
+
+    // The labels of a map: many short strings of a few sizes and
+    // colors at pseudo-random positions.
+    template<class Draw> void draw_labels(Draw& draw)
+    {
+        static const agg::rgba8 colors[] =
+        {
+            agg::rgba8(0, 0, 0),
+            agg::rgba8(0, 0, 160),
+            agg::rgba8(120, 40, 0)
+        };
+        unsigned seed = 1;
+        unsigned num_strings = 0;
+        while(labels[num_strings]) ++num_strings;
+
+        // The labels are grouped by style, as changing the font
+        // size is expensive.
+        unsigned i, j;
+        for(i = 0; i < 3; i++)
+        {
+            m_feng.height(9 + i * 2);
+            m_feng.width(9 + i * 2);
+            for(j = i; j < num_labels; j += 3)
+            {
+                seed = seed * 1103515245 + 12345;
+                double x = (seed >> 8) % unsigned(width());
+                seed = seed * 1103515245 + 12345;
+                double y = (seed >> 8) % unsigned(height() - 30) + 30;
+                draw(labels[j % num_strings], x, y, colors[i]);
+            }
+        }
+    }
+
+    struct draw_scanlines
+    {
+        renderer_solid     ren;
+        font_manager_type* fman;
+
+        draw_scanlines(base_ren_type& rb, font_manager_type& fm) :
+            ren(rb), fman(&fm) {}
+
+        void operator() (const char* p, double x, double y, const agg::rgba8& c)
+        {
+            ren.color(c);
+            for(; *p; ++p)
+            {
+                const agg::glyph_cache* glyph = fman->glyph(*p);
+                if(glyph)
+                {
+                    fman->add_kerning(&x, &y);
+                    fman->init_embedded_adaptors(glyph, x, y);
+                    agg::render_scanlines(fman->gray8_adaptor(),
+                                          fman->gray8_scanline(),
+                                          ren);
+                    x += glyph->advance_x;
+                    y += glyph->advance_y;
+                }
+            }
+        }
+    };
+
+    struct draw_atlas
+    {
+        renderer_atlas     ren;
+        font_manager_type* fman;
+
+        draw_atlas(base_ren_type& rb, agg::glyph_atlas& atlas, font_manager_type& fm) :
+            ren(rb, atlas), fman(&fm) {}
+
+        void operator() (const char* p, double x, double y, const agg::rgba8& c)
+        {
+            ren.color(c);
+            ren.add_text(*fman, p, &x, &y);
+        }
+    };
+
+    bool load_font()
+    {
+        if(!m_feng.load_font(full_file_name("timesi.ttf"), 0, agg::glyph_ren_native_gray8))
+        {
+            return false;
+        }
+        m_feng.hinting(true);
+        m_feng.flip_y(false);
+        return true;
+    }
+
+    void draw(base_ren_type& rb, bool use_atlas)
+    {
+        if(use_atlas)
+        {
+            draw_atlas d(rb, m_atlas, m_fman);
+            draw_labels(d);
+            d.ren.render();
+        }
+        else
+        {
+            draw_scanlines d(rb, m_fman);
+            draw_labels(d);
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt_type pf(rbuf_window());
+        base_ren_type ren_base(pf);
+        ren_base.clear(agg::rgba(1,1,1));
+
+        if(load_font()) draw(ren_base, m_use_atlas.status());
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, ren_base, m_use_atlas);
+    }
+
+    // Draws the labels a number of times with the serialized scanlines
+    // of every glyph and with the atlas, and compares the images.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            if(!load_font())
+            {
+                message("Please copy file timesi.ttf to the current directory\n"
+                        "or download it from http://www.antigrain.com/timesi.zip");
+                return;
+            }
+
+            unsigned w = width();
+            unsigned h = height();
+            agg::pod_array<agg::int8u> buf1(w * h * 3);
+            agg::pod_array<agg::int8u> buf2(w * h * 3);
+            agg::rendering_buffer rbuf1(&buf1[0], w, h, w * 3);
+            agg::rendering_buffer rbuf2(&buf2[0], w, h, w * 3);
+            pixfmt_type pf1(rbuf1);
+            pixfmt_type pf2(rbuf2);
+            base_ren_type rb1(pf1);
+            base_ren_type rb2(pf2);
+
+            // Warm up the font cache and the atlas
+            rb1.clear(agg::rgba(1,1,1));
+            rb2.clear(agg::rgba(1,1,1));
+            draw(rb1, false);
+            draw(rb2, true);
+
+            double t1 = 0;
+            double t2 = 0;
+            unsigned i;
+            for(i = 0; i < 10; i++)
+            {
+                rb1.clear(agg::rgba(1,1,1));
+                start_timer();
+                draw(rb1, false);
+                t1 += elapsed_time();
+
+                rb2.clear(agg::rgba(1,1,1));
+                start_timer();
+                draw(rb2, true);
+                t2 += elapsed_time();
+            }
+
+            unsigned diff = 0;
+            for(i = 0; i < h; i++)
+            {
+                if(memcmp(rbuf1.row_ptr(i), rbuf2.row_ptr(i), w * 3) != 0) ++diff;
+            }
+
+            char buf[256];
+            sprintf(buf, "%d labels\nScanlines: %.2fms\nGlyph atlas: %.2fms\n"
+                         "Different rows: %u",
+                    int(num_labels), t1 / 10, t2 / 10, diff);
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Glyph Atlas (click to run the test)");
+
+    if(app.init(640, 480, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
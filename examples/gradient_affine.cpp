@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_span_allocator.h"
+#include "agg_span_gradient.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_gradient_lut.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_gradient;
+    agg::slider_ctrl<agg::rgba8> m_angle;
+    agg::cbox_ctrl<agg::rgba8>   m_affine;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::gradient_lut<agg::color_interpolator<agg::rgba8>, 256> color_func_type;
+    typedef agg::span_interpolator_linear<> interpolator_type;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_gradient(5.0, 5.0, 110.0, 60.0, !flip_y),
+        m_angle   (120, 5, 512-5, 12, !flip_y),
+        m_affine  (120, 20, "span_gradient_affine", !flip_y)
+    {
+        add_ctrl(m_gradient);
+        m_gradient.add_item("gradient_x");
+        m_gradient.add_item("gradient_y");
+        m_gradient.add_item("gradient_radial");
+        m_gradient.cur_item(2);
+
+        add_ctrl(m_angle);
+        m_angle.range(0.0, 360.0);
+        m_angle.value(30.0);
+        m_angle.label("Angle=%.1f");
+
+        add_ctrl(m_affine);
+        m_affine.status(true);
+    }
+
+    void calc_colors(color_func_type& colors)
+    {
+        colors.remove_all();
+        colors.add_color(0.0, agg::rgba8(0,   50,  50));
+        colors.add_color(0.3, agg::rgba8(255, 255, 100));
+        colors.add_color(0.7, agg::rgba8(50,  50,  200));
+        colors.add_color(1.0, agg::rgba8(200, 0,   50));
+        colors.build_lut();
+    }
+
+    template<class SpanGen> double render_gradient(renderer_base& rb,
+                                                   double w, double h,
+                                                   SpanGen& sg)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::span_allocator<color_type> sa;
+
+        ras.move_to_d(0, 0);
+        ras.line_to_d(w, 0);
+        ras.line_to_d(w, h);
+        ras.line_to_d(0, h);
+
+        start_timer();
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+        return elapsed_time();
+    }
+
+    // Renders the gradient to the rectangle (0,0,w,h) with span_gradient
+    // or span_gradient_affine and returns the time in milliseconds.
+    template<class GradientF> double render(renderer_base& rb,
+                                            double w, double h,
+                                            bool affine)
+    {
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_rotation(agg::deg2rad(m_angle.value()));
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        mtx.invert();
+
+        interpolator_type inter(mtx);
+        GradientF gradient;
+        color_func_type colors;
+        calc_colors(colors);
+        double d = (w < h ? w : h) / 3;
+
+        if(affine)
+        {
+            agg::span_gradient_affine<color_type,
+                                      interpolator_type,
+                                      GradientF,
+                                      color_func_type> sg(inter, gradient, colors, 0, d);
+            return render_gradient(rb, w, h, sg);
+        }
+        agg::span_gradient<color_type,
+                           interpolator_type,
+                           GradientF,
+                           color_func_type> sg(inter, gradient, colors, 0, d);
+        return render_gradient(rb, w, h, sg);
+    }
+
+    double render(renderer_base& rb, unsigned idx, double w, double h, bool affine)
+    {
+        switch(idx)
+        {
+        case 0:  return render<agg::gradient_x>(rb, w, h, affine);
+        case 1:  return render<agg::gradient_y>(rb, w, h, affine);
+        }
+        return render<agg::gradient_radial>(rb, w, h, affine);
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        render(rb, m_gradient.cur_item(), width(), height(), m_affine.status());
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_gradient);
+        agg::render_ctrl(ras, sl, rb, m_angle);
+        agg::render_ctrl(ras, sl, rb, m_affine);
+    }
+
+    // Renders all the gradients to a 1024x768 buffer 10 times with
+    // span_gradient and span_gradient_affine and reports the time and
+    // the maximal difference of the components.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            static const char* names[] = { "gradient_x", "gradient_y", "gradient_radial" };
+            const unsigned w = 1024;
+            const unsigned h = 768;
+            char buf[1024];
+            buf[0] = 0;
+
+            agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+            agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+            agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+            pixfmt ref_pixf(ref_rbuf);
+            pixfmt tst_pixf(tst_rbuf);
+            renderer_base ref_ren(ref_pixf);
+            renderer_base tst_ren(tst_pixf);
+
+            unsigned i;
+            for(i = 0; i < 3; i++)
+            {
+                double t1 = 0;
+                double t2 = 0;
+                unsigned j;
+                for(j = 0; j < 10; j++)
+                {
+                    t1 += render(ref_ren, i, w, h, false);
+                    t2 += render(tst_ren, i, w, h, true);
+                }
+                int max_diff = 0;
+                for(j = 0; j < w * h * 4; j++)
+                {
+                    int d = abs(int(ref_buf[j]) - int(tst_buf[j]));
+                    if(d > max_diff) max_diff = d;
+                }
+                sprintf(buf + strlen(buf), "%s: %.2f/%.2fms (diff %d)\n",
+                        names[i], t1 / 10, t2 / 10, max_diff);
+            }
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Incremental Affine Gradients (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
@@ -0,0 +1,274 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_trans_affine.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_image_accessors.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_image_pyramid.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_method;
+    agg::slider_ctrl<agg::rgba8> m_scale;
+    agg::cbox_ctrl<agg::rgba8>   m_gaussian;
+    agg::int8u*                  m_img_buf;
+    agg::rendering_buffer        m_img;
+
+public:
+    enum img_size_e { img_size = 2048 };
+
+    typedef agg::renderer_base<pixfmt>     renderer_base;
+    typedef agg::renderer_base<pixfmt_pre> renderer_base_pre;
+    typedef agg::image_accessor_clone<pixfmt> source_type;
+    typedef agg::image_pyramid<pixfmt> pyramid_type;
+    typedef agg::span_interpolator_linear<> interpolator_type;
+    typedef agg::span_image_resample_rgba_affine<source_type> resample_type;
+    typedef agg::span_image_pyramid_rgba<pyramid_type, interpolator_type> pyramid_span_type;
+
+    virtual ~the_application()
+    {
+        delete [] m_img_buf;
+    }
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_method  (5.0, 5.0, 150.0, 60.0, !flip_y),
+        m_scale   (160, 5, 512-5, 12, !flip_y),
+        m_gaussian(160, 20, "Gaussian Pyramid", !flip_y),
+        m_img_buf(new agg::int8u[img_size * img_size * 4]),
+        m_img(m_img_buf, img_size, img_size, img_size * 4)
+    {
+        parse_lion();
+
+        add_ctrl(m_method);
+        m_method.add_item("Resample");
+        m_method.add_item("Pyramid");
+        m_method.add_item("Pyramid Trilinear");
+        m_method.cur_item(2);
+
+        add_ctrl(m_scale);
+        m_scale.range(1.0/64.0, 1.0);
+        m_scale.value(0.1);
+        m_scale.label("Scale=%.3f");
+
+        add_ctrl(m_gaussian);
+
+        pixfmt pixf(m_img);
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+        draw_lion(rb, img_size, img_size);
+    }
+
+    void draw_lion(renderer_base& rb, double w, double h)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::trans_affine mtx;
+        double s = (w < h ? w : h) / (g_y2 - g_y1);
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+        agg::renderer_scanline_aa_solid<renderer_base> r(rb);
+        agg::render_all_paths(ras, sl, r, trans, g_colors, g_path_idx, g_npaths);
+    }
+
+    // Renders the image scaled by "scale" to the rectangle (0,0,w,h)
+    // with the span generator "sg" and returns the time in milliseconds.
+    template<class SpanGen> double render_image(renderer_base_pre& rb,
+                                                double w, double h,
+                                                SpanGen& sg)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::span_allocator<color_type> sa;
+
+        ras.move_to_d(0, 0);
+        ras.line_to_d(w, 0);
+        ras.line_to_d(w, h);
+        ras.line_to_d(0, h);
+
+        start_timer();
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+        return elapsed_time();
+    }
+
+    void image_mtx(agg::trans_affine& mtx, double w, double h, double scale)
+    {
+        mtx.reset();
+        mtx *= agg::trans_affine_translation(-img_size / 2.0, -img_size / 2.0);
+        mtx *= agg::trans_affine_scaling(scale);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        mtx.invert();
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt_pre pixf(rbuf_window());
+        renderer_base_pre rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::trans_affine mtx;
+        image_mtx(mtx, width(), height(), m_scale.value());
+        interpolator_type interpolator(mtx);
+
+        if(m_method.cur_item() == 0)
+        {
+            pixfmt img_pixf(m_img);
+            source_type source(img_pixf);
+            agg::image_filter_lut filter(agg::image_filter_bilinear(), true);
+            resample_type sg(source, interpolator, filter);
+            render_image(rb, width(), height(), sg);
+        }
+        else
+        {
+            pyramid_type pyramid(m_img, m_gaussian.status() ?
+                                            agg::image_pyramid_gaussian :
+                                            agg::image_pyramid_box);
+            pyramid_span_type sg(pyramid, interpolator, m_method.cur_item() == 2);
+            render_image(rb, width(), height(), sg);
+        }
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_method);
+        agg::render_ctrl(ras, sl, rb, m_scale);
+        agg::render_ctrl(ras, sl, rb, m_gaussian);
+    }
+
+    // Reduces the 2048x2048 image 2...32 times with the resampler (the
+    // bilinear filter) and with the pyramid, the nearest level and the
+    // trilinear filtering. Reports the time and the mean difference of
+    // the components from the resampler.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            static const unsigned factors[] = { 2, 3, 4, 6, 8, 12, 16, 24, 32 };
+            char buf[2048];
+
+            agg::int8u* ref_buf = new agg::int8u[img_size * img_size * 4];
+            agg::int8u* tst_buf = new agg::int8u[img_size * img_size * 4];
+            agg::rendering_buffer ref_rbuf(ref_buf, img_size, img_size, img_size * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, img_size, img_size, img_size * 4);
+            pixfmt_pre ref_pixf(ref_rbuf);
+            pixfmt_pre tst_pixf(tst_rbuf);
+            renderer_base_pre ref_ren(ref_pixf);
+            renderer_base_pre tst_ren(tst_pixf);
+
+            pixfmt img_pixf(m_img);
+            source_type source(img_pixf);
+            agg::image_filter_lut filter(agg::image_filter_bilinear(), true);
+
+            start_timer();
+            pyramid_type pyramid(m_img, m_gaussian.status() ?
+                                            agg::image_pyramid_gaussian :
+                                            agg::image_pyramid_box);
+            sprintf(buf, "2048x2048, %s pyramid built in %.1fms\n"
+                         "resample/pyramid/trilinear:\n",
+                    m_gaussian.status() ? "Gaussian" : "box",
+                    elapsed_time());
+
+            unsigned i;
+            for(i = 0; i < sizeof(factors) / sizeof(factors[0]); i++)
+            {
+                double w = double(img_size) / factors[i];
+                agg::trans_affine mtx;
+                image_mtx(mtx, w, w, 1.0 / factors[i]);
+                interpolator_type interpolator(mtx);
+
+                ref_ren.clear(agg::rgba(1, 1, 1));
+                resample_type sg1(source, interpolator, filter);
+                double t1 = render_image(ref_ren, w, w, sg1);
+
+                double t[2];
+                double diff[2];
+                unsigned k;
+                for(k = 0; k < 2; k++)
+                {
+                    tst_ren.clear(agg::rgba(1, 1, 1));
+                    pyramid_span_type sg2(pyramid, interpolator, k == 1);
+                    t[k] = render_image(tst_ren, w, w, sg2);
+
+                    double sum = 0;
+                    unsigned row;
+                    for(row = 0; row < unsigned(w); row++)
+                    {
+                        const agg::int8u* p1 = ref_rbuf.row_ptr(row);
+                        const agg::int8u* p2 = tst_rbuf.row_ptr(row);
+                        unsigned j;
+                        for(j = 0; j < unsigned(w) * 4; j++)
+                        {
+                            sum += abs(int(p1[j]) - int(p2[j]));
+                        }
+                    }
+                    diff[k] = sum / (w * w * 4);
+                }
+                sprintf(buf + strlen(buf),
+                        "1/%u: %.2f/%.2f/%.2fms (diff %.2f/%.2f)\n",
+                        factors[i], t1, t[0], t[1], diff[0], diff[1]);
+            }
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Image Pyramid (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
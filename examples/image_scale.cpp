@@ -0,0 +1,254 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_trans_affine.h"
+#include "agg_span_allocator.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_image_accessors.h"
+#include "agg_span_image_filter_rgba.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_filter;
+    agg::slider_ctrl<agg::rgba8> m_scale;
+    agg::cbox_ctrl<agg::rgba8>   m_separable;
+    agg::int8u*                  m_img_buf;
+    agg::rendering_buffer        m_img;
+
+public:
+    enum img_size_e { img_size = 1024 };
+
+    typedef agg::renderer_base<pixfmt>     renderer_base;
+    typedef agg::renderer_base<pixfmt_pre> renderer_base_pre;
+    typedef agg::image_accessor_clone<pixfmt> source_type;
+    typedef agg::span_interpolator_linear<> interpolator_type;
+    typedef agg::span_image_resample_rgba_affine<source_type> resample_2d_type;
+    typedef agg::span_image_resample_rgba_separable<source_type> resample_separable_type;
+
+    virtual ~the_application()
+    {
+        delete [] m_img_buf;
+    }
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_filter   (5.0, 5.0, 110.0, 60.0, !flip_y),
+        m_scale    (120, 5, 512-5, 12, !flip_y),
+        m_separable(120, 20, "Separable", !flip_y),
+        m_img_buf(new agg::int8u[img_size * img_size * 4]),
+        m_img(m_img_buf, img_size, img_size, img_size * 4)
+    {
+        parse_lion();
+
+        add_ctrl(m_filter);
+        m_filter.add_item("bicubic");
+        m_filter.add_item("mitchell");
+        m_filter.add_item("lanczos3");
+        m_filter.cur_item(0);
+
+        add_ctrl(m_scale);
+        m_scale.range(0.03, 4.0);
+        m_scale.value(0.35);
+        m_scale.label("Scale=%.3f");
+
+        add_ctrl(m_separable);
+        m_separable.status(true);
+
+        pixfmt pixf(m_img);
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+        draw_lion(rb, img_size, img_size);
+    }
+
+    void draw_lion(renderer_base& rb, double w, double h)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::trans_affine mtx;
+        double s = (w < h ? w : h) / (g_y2 - g_y1);
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+        agg::renderer_scanline_aa_solid<renderer_base> r(rb);
+        agg::render_all_paths(ras, sl, r, trans, g_colors, g_path_idx, g_npaths);
+    }
+
+    void calc_filter(agg::image_filter_lut& filter, unsigned idx)
+    {
+        switch(idx)
+        {
+        case 0: filter.calculate(agg::image_filter_bicubic());  break;
+        case 1: filter.calculate(agg::image_filter_mitchell()); break;
+        case 2: filter.calculate(agg::image_filter_lanczos(3)); break;
+        }
+    }
+
+    // Renders the image scaled by "scale" to the rectangle (0,0,w,h)
+    // and returns the time in milliseconds.
+    template<class SpanGen> double render_image(renderer_base_pre& rb,
+                                                double w, double h,
+                                                double scale,
+                                                const agg::image_filter_lut& filter)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::span_allocator<color_type> sa;
+        pixfmt img_pixf(m_img);
+        source_type source(img_pixf);
+
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_translation(-img_size / 2.0, -img_size / 2.0);
+        mtx *= agg::trans_affine_scaling(scale);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+        mtx.invert();
+        interpolator_type interpolator(mtx);
+        SpanGen sg(source, interpolator, filter);
+
+        ras.move_to_d(0, 0);
+        ras.line_to_d(w, 0);
+        ras.line_to_d(w, h);
+        ras.line_to_d(0, h);
+
+        start_timer();
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+        return elapsed_time();
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt_pre pixf(rbuf_window());
+        renderer_base_pre rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::image_filter_lut filter;
+        calc_filter(filter, m_filter.cur_item());
+        if(m_separable.status())
+        {
+            render_image<resample_separable_type>(rb, width(), height(),
+                                                  m_scale.value(), filter);
+        }
+        else
+        {
+            render_image<resample_2d_type>(rb, width(), height(),
+                                           m_scale.value(), filter);
+        }
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_filter);
+        agg::render_ctrl(ras, sl, rb, m_scale);
+        agg::render_ctrl(ras, sl, rb, m_separable);
+    }
+
+    // Scales the 1024x1024 image to a 1024x768 window with the 2D
+    // filter and the separable one and compares the time and the result.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            static const double scales[] = { 2.0, 1.0, 0.5, 0.25, 0.125 };
+            static const char* filter_names[] = { "bicubic", "mitchell", "lanczos3" };
+            const unsigned w = 1024;
+            const unsigned h = 768;
+            char buf[2048];
+            buf[0] = 0;
+
+            agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+            agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+            agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+            pixfmt_pre ref_pixf(ref_rbuf);
+            pixfmt_pre tst_pixf(tst_rbuf);
+            renderer_base_pre ref_ren(ref_pixf);
+            renderer_base_pre tst_ren(tst_pixf);
+
+            unsigned f;
+            for(f = 0; f < 3; f++)
+            {
+                agg::image_filter_lut filter;
+                calc_filter(filter, f);
+                sprintf(buf + strlen(buf), "%s:", filter_names[f]);
+                unsigned i;
+                for(i = 0; i < sizeof(scales) / sizeof(scales[0]); i++)
+                {
+                    ref_ren.clear(agg::rgba(1, 1, 1));
+                    tst_ren.clear(agg::rgba(1, 1, 1));
+                    double t1 = render_image<resample_2d_type>(ref_ren, w, h,
+                                                               scales[i], filter);
+                    double t2 = render_image<resample_separable_type>(tst_ren, w, h,
+                                                                      scales[i], filter);
+                    int max_diff = 0;
+                    unsigned j;
+                    for(j = 0; j < w * h * 4; j++)
+                    {
+                        int d = abs(int(ref_buf[j]) - int(tst_buf[j]));
+                        if(d > max_diff) max_diff = d;
+                    }
+                    sprintf(buf + strlen(buf), " x%.3g:%.1f/%.1fms(diff %d)",
+                            scales[i], t1, t2, max_diff);
+                }
+                strcat(buf, "\n");
+            }
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Separable Image Scaling (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
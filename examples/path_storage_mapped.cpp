@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_path_storage_mapped.h"
+#include "agg_conv_transform.h"
+#include "agg_trans_affine.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+enum
+{
+    num_paths = 10000,
+    path_size = 200
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::path_storage_mapped32 m_mapped;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y)
+    {
+    }
+
+    // The data set: many short random walks, like the roads of a map
+    void load(agg::path_storage& ps, agg::pod_array<unsigned>& path_ids)
+    {
+        srand(1);
+        unsigned i, j;
+        for(i = 0; i < num_paths; i++)
+        {
+            path_ids[i] = ps.start_new_path();
+            double x = rand() % 1000;
+            double y = rand() % 1000;
+            ps.move_to(x, y);
+            for(j = 1; j < path_size; j++)
+            {
+                x += (rand() % 201 - 100) / 50.0;
+                y += (rand() % 201 - 100) / 50.0;
+                ps.line_to(x, y);
+            }
+        }
+    }
+
+    bool open_paths()
+    {
+        if(m_mapped.is_open()) return true;
+        if(m_mapped.open(full_file_name("paths.bin"))) return true;
+
+        agg::path_storage ps;
+        agg::pod_array<unsigned> path_ids(num_paths);
+        load(ps, path_ids);
+        return agg::path_storage_mapped32::write(full_file_name("paths.bin"),
+                                                 ps, &path_ids[0], num_paths) &&
+               m_mapped.open(full_file_name("paths.bin"));
+    }
+
+    template<class VertexSource>
+    void add_path(agg::rasterizer_scanline_aa<>& ras, VertexSource& vs,
+                  const unsigned* path_ids)
+    {
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_scaling(width() / 1000.0, height() / 1000.0);
+        agg::conv_transform<VertexSource> trans(vs, mtx);
+        unsigned i;
+        for(i = 0; i < num_paths; i++)
+        {
+            ras.add_path(trans, path_ids ? path_ids[i] : i);
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pf(rbuf_window());
+        renderer_base rb(pf);
+        renderer_solid r(rb);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        if(open_paths())
+        {
+            agg::rasterizer_scanline_aa<> ras;
+            agg::scanline_u8 sl;
+            add_path(ras, m_mapped, 0);
+            r.color(agg::rgba(0, 0, 0.5, 0.5));
+            agg::render_scanlines(ras, sl, r);
+        }
+    }
+
+    // Compares loading the data into path_storage with mapping the file
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            if(!open_paths())
+            {
+                message("Can't write file paths.bin");
+                return;
+            }
+
+            agg::path_storage ps;
+            agg::pod_array<unsigned> path_ids(num_paths);
+            start_timer();
+            load(ps, path_ids);
+            double t1 = elapsed_time();
+
+            agg::path_storage_mapped32 mapped;
+            start_timer();
+            mapped.open(full_file_name("paths.bin"));
+            double t2 = elapsed_time();
+
+            agg::rasterizer_scanline_aa<> ras;
+            start_timer();
+            add_path(ras, ps, &path_ids[0]);
+            double t3 = elapsed_time();
+
+            ras.reset();
+            start_timer();
+            add_path(ras, mapped, 0);
+            double t4 = elapsed_time();
+
+            char buf[256];
+            sprintf(buf, "%d paths, %d vertices\n"
+                         "path_storage: load %.1fms, add_path() %.1fms\n"
+                         "path_storage_mapped32: open %.3fms, add_path() %.1fms",
+                    int(num_paths), int(num_paths * path_size),
+                    t1, t3, t2, t4);
+            message(buf);
+        }
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Memory Mapped Paths (click to run the test)");
+
+    if(app.init(640, 480, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
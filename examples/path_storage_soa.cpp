@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_path_storage_soa.h"
+#include "agg_conv_transform.h"
+#include "agg_trans_affine.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+enum { num_vertices = 2000000 };
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8> m_storage;
+    agg::path_storage          m_path;
+    agg::path_storage_float    m_path_float;
+    agg::path_storage_int32    m_path_int32;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_storage(5.0, 5.0, 150.0, 65.0, !flip_y)
+    {
+        m_storage.add_item("path_storage");
+        m_storage.add_item("path_storage_float");
+        m_storage.add_item("path_storage_int32");
+        m_storage.cur_item(1);
+        add_ctrl(m_storage);
+
+        // A random walk with short segments, like a GPS track,
+        // appended to the float storage from arrays
+        agg::pod_array<float> x(num_vertices);
+        agg::pod_array<float> y(num_vertices);
+        x[0] = y[0] = 500.0f;
+        unsigned i;
+        for(i = 1; i < num_vertices; i++)
+        {
+            x[i] = x[i - 1] + (rand() % 201 - 100) / 10.0f;
+            y[i] = y[i - 1] + (rand() % 201 - 100) / 10.0f;
+            if(x[i] < 0.0f) x[i] = 0.0f;
+            if(y[i] < 0.0f) y[i] = 0.0f;
+            if(x[i] > 1000.0f) x[i] = 1000.0f;
+            if(y[i] > 1000.0f) y[i] = 1000.0f;
+        }
+        m_path_float.move_to(x[0], y[0]);
+        m_path_float.vertices().add_vertices(&x[1], &y[1], num_vertices - 1,
+                                             agg::path_cmd_line_to);
+
+        agg::copy_path(m_path, m_path_float);
+        agg::copy_path(m_path_int32, m_path_float);
+    }
+
+    template<class VertexSource>
+    void add_path(agg::rasterizer_scanline_aa<>& ras, VertexSource& vs)
+    {
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_scaling((width() - 20) / 1000.0, (height() - 80) / 1000.0);
+        mtx *= agg::trans_affine_translation(10, 70);
+        agg::conv_transform<VertexSource> trans(vs, mtx);
+        ras.add_path(trans);
+    }
+
+    void add_path(agg::rasterizer_scanline_aa<>& ras, int storage)
+    {
+        switch(storage)
+        {
+            case 0: add_path(ras, m_path);       break;
+            case 1: add_path(ras, m_path_float); break;
+            case 2: add_path(ras, m_path_int32); break;
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pf(rbuf_window());
+        renderer_base rb(pf);
+        renderer_solid r(rb);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+
+        add_path(ras, m_storage.cur_item());
+        r.color(agg::rgba(0, 0, 0.5, 0.5));
+        agg::render_scanlines(ras, sl, r);
+
+        agg::render_ctrl(ras, sl, rb, m_storage);
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            agg::rasterizer_scanline_aa<> ras;
+            double t[3] = { 0, 0, 0 };
+            unsigned i;
+            int j;
+            for(i = 0; i < 3; i++)
+            {
+                for(j = 0; j < 3; j++)
+                {
+                    ras.reset();
+                    start_timer();
+                    add_path(ras, j);
+                    t[j] += elapsed_time();
+                }
+            }
+
+            // vertex_block_storage<double> keeps 2 doubles and a command
+            // byte per vertex, in blocks of 256 vertices.
+            unsigned bytes = (m_path.total_vertices() + 255) / 256 * 256 * 17;
+
+            char buf[512];
+            sprintf(buf, "add_path() of %d vertices\n"
+                         "path_storage: ~%uKB, %.1fms\n"
+                         "path_storage_float: %uKB, %.1fms\n"
+                         "path_storage_int32: %uKB, %.1fms",
+                    int(num_vertices),
+                    bytes / 1024, t[0] / 3,
+                    m_path_float.vertices().byte_size() / 1024, t[1] / 3,
+                    m_path_int32.vertices().byte_size() / 1024, t[2] / 3);
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Compact Path Storage (click to run the test)");
+
+    if(app.init(640, 480, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
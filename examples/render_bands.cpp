@@ -0,0 +1,271 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_renderer_bands.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_rbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+typedef agg::renderer_bands<pixfmt> renderer_bands_type;
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+agg::path_storage g_poly;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+inline double frand(double x)
+{
+    return ((((rand() << 15) | rand()) & 0x3FFFFFFF) % 1000000) * x / 1000000.0;
+}
+
+void make_large_polygon()
+{
+    srand(1234);
+    g_poly.remove_all();
+    g_poly.move_to(frand(1.0), frand(1.0));
+    for(unsigned i = 1; i < 1000; i++)
+    {
+        g_poly.line_to(frand(1.0), frand(1.0));
+    }
+    g_poly.close_polygon();
+}
+
+
+//------------------------------------------------------------------------
+// The scene must be reentrant: all the stateful objects are created on
+// each call. path_storage itself has an iterator, so it's read through
+// path_reader.
+struct lion_scene
+{
+    agg::trans_affine mtx;
+
+    void operator() (renderer_bands_type::rasterizer_type& ras,
+                     renderer_bands_type::scanline_type& sl,
+                     renderer_bands_type::base_ren_type& ren,
+                     renderer_bands_type::span_alloc_type&) const
+    {
+        agg::renderer_scanline_aa_solid<renderer_bands_type::base_ren_type> r(ren);
+        agg::path_reader<agg::path_storage> path(g_path);
+        agg::conv_transform<agg::path_reader<agg::path_storage> > trans(path, mtx);
+        agg::render_all_paths(ras, sl, r, trans, g_colors, g_path_idx, g_npaths);
+    }
+};
+
+struct polygon_scene
+{
+    agg::trans_affine mtx;
+
+    void operator() (renderer_bands_type::rasterizer_type& ras,
+                     renderer_bands_type::scanline_type& sl,
+                     renderer_bands_type::base_ren_type& ren,
+                     renderer_bands_type::span_alloc_type&) const
+    {
+        agg::path_reader<agg::path_storage> path(g_poly);
+        agg::conv_transform<agg::path_reader<agg::path_storage> > trans(path, mtx);
+        ras.filling_rule(agg::fill_even_odd);
+        ras.add_path(trans);
+        agg::render_scanlines_aa_solid(ras, sl, ren, agg::rgba8(0, 60, 120, 160));
+    }
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::rbox_ctrl<agg::rgba8>   m_scene;
+    agg::slider_ctrl<agg::rgba8> m_threads;
+    agg::slider_ctrl<agg::rgba8> m_bands;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scene  (5.0, 5.0, 150.0, 45.0, !flip_y),
+        m_threads(160, 5,  512-5, 12, !flip_y),
+        m_bands  (160, 20, 512-5, 27, !flip_y)
+    {
+        parse_lion();
+        make_large_polygon();
+
+        add_ctrl(m_scene);
+        m_scene.add_item("Lion");
+        m_scene.add_item("Large Polygon");
+        m_scene.cur_item(0);
+
+        add_ctrl(m_threads);
+        m_threads.range(1, 16);
+        m_threads.num_steps(15);
+        m_threads.value(4);
+        m_threads.label("Threads=%.0f");
+
+        add_ctrl(m_bands);
+        m_bands.range(0, 64);
+        m_bands.num_steps(64);
+        m_bands.value(0);
+        m_bands.label("Bands=%.0f (0 - one per thread)");
+    }
+
+    void lion_mtx(agg::trans_affine& mtx, double w, double h)
+    {
+        double s = (w < h ? w : h) / (g_y2 - g_y1);
+        mtx.reset();
+        mtx *= agg::trans_affine_translation(-(g_x1 + g_x2) / 2, -(g_y1 + g_y2) / 2);
+        mtx *= agg::trans_affine_scaling(s, s);
+        mtx *= agg::trans_affine_rotation(agg::pi);
+        mtx *= agg::trans_affine_translation(w / 2, h / 2);
+    }
+
+    void poly_mtx(agg::trans_affine& mtx, double w, double h)
+    {
+        mtx = agg::trans_affine_scaling(w, h);
+    }
+
+    template<class Scene> void render_scene(pixfmt& pixf, const Scene& scene,
+                                            unsigned threads, unsigned bands)
+    {
+        renderer_bands_type rb(pixf, threads);
+        rb.num_bands(bands);
+        rb.render(scene);
+    }
+
+    template<class Scene> void render_serial(pixfmt& pixf, const Scene& scene)
+    {
+        renderer_bands_type::rasterizer_type ras;
+        renderer_bands_type::scanline_type   sl;
+        renderer_bands_type::span_alloc_type alloc;
+        renderer_base ren(pixf);
+        scene(ras, sl, ren, alloc);
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        if(m_scene.cur_item() == 0)
+        {
+            lion_scene scene;
+            lion_mtx(scene.mtx, width(), height());
+            render_scene(pixf, scene, unsigned(m_threads.value()), unsigned(m_bands.value()));
+        }
+        else
+        {
+            polygon_scene scene;
+            poly_mtx(scene.mtx, width(), height());
+            render_scene(pixf, scene, unsigned(m_threads.value()), unsigned(m_bands.value()));
+        }
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+        agg::render_ctrl(ras, sl, rb, m_scene);
+        agg::render_ctrl(ras, sl, rb, m_threads);
+        agg::render_ctrl(ras, sl, rb, m_bands);
+    }
+
+    template<class Scene> void run_test(const Scene& scene,
+                                        unsigned w, unsigned h,
+                                        unsigned num_frames,
+                                        char* buf)
+    {
+        agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+        agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+        agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+        agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+        pixfmt ref_pixf(ref_rbuf);
+        pixfmt tst_pixf(tst_rbuf);
+        renderer_base ref_ren(ref_pixf);
+        renderer_base tst_ren(tst_pixf);
+
+        unsigned i;
+        ref_ren.clear(agg::rgba(1, 1, 1));
+        start_timer();
+        for(i = 0; i < num_frames; i++) render_serial(ref_pixf, scene);
+        double t0 = elapsed_time() / num_frames;
+        sprintf(buf + strlen(buf), " serial=%.1fms", t0);
+
+        unsigned threads;
+        for(threads = 1; threads <= unsigned(m_threads.value()); threads++)
+        {
+            tst_ren.clear(agg::rgba(1, 1, 1));
+            start_timer();
+            for(i = 0; i < num_frames; i++)
+            {
+                render_scene(tst_pixf, scene, threads, unsigned(m_bands.value()));
+            }
+            double t = elapsed_time() / num_frames;
+            bool identical = memcmp(ref_buf, tst_buf, w * h * 4) == 0;
+            sprintf(buf + strlen(buf), " %u:%.1fms(x%.2f)%s",
+                    threads, t, t0 / t, identical ? "" : "!DIFF");
+        }
+        delete [] tst_buf;
+        delete [] ref_buf;
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            const unsigned w = 4096;
+            const unsigned h = 4096;
+            char buf[1024];
+
+            strcpy(buf, "Lion 4096x4096:");
+            lion_scene lion;
+            lion_mtx(lion.mtx, w, h);
+            run_test(lion, w, h, 5, buf);
+            strcat(buf, "\nLarge Polygon 4096x4096:");
+            polygon_scene poly;
+            poly_mtx(poly.mtx, w, h);
+            run_test(poly, w, h, 2, buf);
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Rendering by Bands in Parallel (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
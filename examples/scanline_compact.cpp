@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_p.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_trans_affine.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::slider_ctrl<agg::rgba8> m_scale;
+    agg::cbox_ctrl<agg::rgba8>   m_compact;
+
+    agg::int8u* m_data[100];
+    unsigned    m_size[100];
+    agg::int8u* m_compact_data[100];
+    unsigned    m_compact_size[100];
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scale  (5, 5, 300, 12, !flip_y),
+        m_compact(310, 5, "Compact Format", !flip_y)
+    {
+        parse_lion();
+        memset(m_data, 0, sizeof(m_data));
+        memset(m_compact_data, 0, sizeof(m_compact_data));
+
+        add_ctrl(m_scale);
+        m_scale.range(0.5, 4.0);
+        m_scale.value(1.5);
+        m_scale.label("Scale=%.2f");
+
+        add_ctrl(m_compact);
+        m_compact.status(true);
+    }
+
+    virtual ~the_application()
+    {
+        free_data();
+    }
+
+    void free_data()
+    {
+        unsigned i;
+        for(i = 0; i < 100; i++)
+        {
+            delete [] m_data[i];
+            delete [] m_compact_data[i];
+            m_data[i] = 0;
+            m_compact_data[i] = 0;
+        }
+    }
+
+    // Rasterizes the lion and serializes each path in both formats.
+    void serialize_lion()
+    {
+        free_data();
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::scanline_storage_aa8 storage;
+
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_translation(-g_x1, -g_y1);
+        mtx *= agg::trans_affine_scaling(m_scale.value());
+        mtx *= agg::trans_affine_translation(10.3, 30.6);
+        agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+
+        unsigned i;
+        for(i = 0; i < g_npaths; i++)
+        {
+            ras.reset();
+            ras.add_path(trans, g_path_idx[i]);
+            storage.prepare();
+            agg::render_scanlines(ras, sl, storage);
+
+            m_size[i] = storage.byte_size();
+            m_data[i] = new agg::int8u[m_size[i]];
+            storage.serialize(m_data[i]);
+
+            m_compact_size[i] = storage.byte_size_compact();
+            m_compact_data[i] = new agg::int8u[m_compact_size[i]];
+            storage.serialize_compact(m_compact_data[i]);
+        }
+    }
+
+    void draw_lion(renderer_base& rb, bool compact)
+    {
+        renderer_solid r(rb);
+        unsigned i;
+        for(i = 0; i < g_npaths; i++)
+        {
+            r.color(g_colors[i]);
+            if(compact)
+            {
+                agg::serialized_compact_scanlines_adaptor_aa8 sa(m_compact_data[i], 
+                                                                 m_compact_size[i], 
+                                                                 0, 0);
+                agg::serialized_compact_scanlines_adaptor_aa8::embedded_scanline sl;
+                agg::render_scanlines(sa, sl, r);
+            }
+            else
+            {
+                agg::serialized_scanlines_adaptor_aa8 sa(m_data[i], m_size[i], 0, 0);
+                agg::serialized_scanlines_adaptor_aa8::embedded_scanline sl;
+                agg::render_scanlines(sa, sl, r);
+            }
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        serialize_lion();
+        draw_lion(rb, m_compact.status());
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::render_ctrl(ras, sl, rb, m_scale);
+        agg::render_ctrl(ras, sl, rb, m_compact);
+    }
+
+    // Replays the serialized lion 100 times to a 1024x768 buffer from
+    // both formats and reports the sizes, the time and the maximal 
+    // difference of the components.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            const unsigned w = 1024;
+            const unsigned h = 768;
+            char buf[1024];
+
+            agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+            agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+            agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+            pixfmt ref_pixf(ref_rbuf);
+            pixfmt tst_pixf(tst_rbuf);
+            renderer_base ref_ren(ref_pixf);
+            renderer_base tst_ren(tst_pixf);
+
+            serialize_lion();
+            unsigned size = 0;
+            unsigned compact_size = 0;
+            unsigned i;
+            for(i = 0; i < g_npaths; i++)
+            {
+                size += m_size[i];
+                compact_size += m_compact_size[i];
+            }
+
+            double t1 = 0;
+            double t2 = 0;
+            for(i = 0; i < 100; i++)
+            {
+                ref_ren.clear(agg::rgba(1, 1, 1));
+                start_timer();
+                draw_lion(ref_ren, false);
+                t1 += elapsed_time();
+
+                tst_ren.clear(agg::rgba(1, 1, 1));
+                start_timer();
+                draw_lion(tst_ren, true);
+                t2 += elapsed_time();
+            }
+
+            int max_diff = 0;
+            for(i = 0; i < w * h * 4; i++)
+            {
+                int d = abs(int(ref_buf[i]) - int(tst_buf[i]));
+                if(d > max_diff) max_diff = d;
+            }
+            sprintf(buf, "Serialized: %u bytes, %.3fms\n"
+                         "Compact: %u bytes, %.3fms\n"
+                         "(diff %d)",
+                    size, t1 / 100, compact_size, t2 / 100, max_diff);
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Compact Scanline Serialization (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
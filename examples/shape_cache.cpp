@@ -0,0 +1,212 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_p.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_bounding_rect.h"
+#include "agg_trans_affine.h"
+#include "agg_shape_cache.h"
+#include "ctrl/agg_slider_ctrl.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGRA32
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+agg::path_storage g_path;
+agg::rgba8        g_colors[100];
+unsigned          g_path_idx[100];
+unsigned          g_npaths = 0;
+double            g_x1 = 0;
+double            g_y1 = 0;
+double            g_x2 = 0;
+double            g_y2 = 0;
+
+unsigned parse_lion(agg::path_storage& ps, agg::rgba8* colors, unsigned* path_idx);
+void parse_lion()
+{
+    g_npaths = parse_lion(g_path, g_colors, g_path_idx);
+    agg::pod_array_adaptor<unsigned> path_idx(g_path_idx, 100);
+    agg::bounding_rect(g_path, path_idx, 0, g_npaths, &g_x1, &g_y1, &g_x2, &g_y2);
+}
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::slider_ctrl<agg::rgba8> m_scale;
+    agg::slider_ctrl<agg::rgba8> m_copies;
+    agg::cbox_ctrl<agg::rgba8>   m_use_cache;
+    agg::shape_cache             m_cache;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_scale    (5, 5,  300, 12, !flip_y),
+        m_copies   (5, 20, 300, 27, !flip_y),
+        m_use_cache(310, 5, "Use Shape Cache", !flip_y),
+        m_cache(8 * 1024 * 1024)
+    {
+        parse_lion();
+
+        add_ctrl(m_scale);
+        m_scale.range(0.1, 1.0);
+        m_scale.value(0.4);
+        m_scale.label("Scale=%.2f");
+
+        add_ctrl(m_copies);
+        m_copies.range(1, 64);
+        m_copies.num_steps(63);
+        m_copies.value(16);
+        m_copies.label("Copies=%.0f");
+
+        add_ctrl(m_use_cache);
+        m_use_cache.status(true);
+    }
+
+    // Draws the lions in rows, the copies differ only in the integer
+    // part of the translation, so, they share the cached shapes.
+    void draw_lions(renderer_base& rb, double w, double h, bool use_cache)
+    {
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        renderer_solid r(rb);
+        agg::rect_i clip(0, 0, int(w), int(h));
+        ras.clip_box(0, 0, w, h);
+
+        double s = m_scale.value();
+        double lw = (g_x2 - g_x1) * s;
+        double lh = (g_y2 - g_y1) * s;
+        unsigned per_row = unsigned(w / lw);
+        if(per_row == 0) per_row = 1;
+
+        unsigned n = unsigned(m_copies.value());
+        unsigned i;
+        for(i = 0; i < n; i++)
+        {
+            agg::trans_affine mtx;
+            mtx *= agg::trans_affine_translation(-g_x1, -g_y1);
+            mtx *= agg::trans_affine_scaling(s);
+            mtx *= agg::trans_affine_translation(0.3 + int(lw) * (i % per_row),
+                                                 40.6 + int(lh) * (i / per_row));
+            unsigned j;
+            for(j = 0; j < g_npaths; j++)
+            {
+                r.color(g_colors[j]);
+                if(use_cache)
+                {
+                    m_cache.render(ras, sl, r, g_path, g_path_idx[j], mtx, clip);
+                }
+                else
+                {
+                    agg::conv_transform<agg::path_storage> trans(g_path, mtx);
+                    ras.reset();
+                    ras.add_path(trans, g_path_idx[j]);
+                    agg::render_scanlines(ras, sl, r);
+                }
+            }
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pixf(rbuf_window());
+        renderer_base rb(pixf);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        draw_lions(rb, width(), height(), m_use_cache.status());
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_p8 sl;
+        agg::render_ctrl(ras, sl, rb, m_scale);
+        agg::render_ctrl(ras, sl, rb, m_copies);
+        agg::render_ctrl(ras, sl, rb, m_use_cache);
+    }
+
+    // Draws 20 frames to a 1024x768 buffer with and without the cache
+    // (starting with the empty one) and reports the time and the maximal
+    // difference of the components.
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            const unsigned w = 1024;
+            const unsigned h = 768;
+            char buf[1024];
+
+            agg::int8u* ref_buf = new agg::int8u[w * h * 4];
+            agg::int8u* tst_buf = new agg::int8u[w * h * 4];
+            agg::rendering_buffer ref_rbuf(ref_buf, w, h, w * 4);
+            agg::rendering_buffer tst_rbuf(tst_buf, w, h, w * 4);
+            pixfmt ref_pixf(ref_rbuf);
+            pixfmt tst_pixf(tst_rbuf);
+            renderer_base ref_ren(ref_pixf);
+            renderer_base tst_ren(tst_pixf);
+
+            m_cache.remove_all();
+            double t1 = 0;
+            double t2 = 0;
+            double first = 0;
+            unsigned i;
+            for(i = 0; i < 20; i++)
+            {
+                ref_ren.clear(agg::rgba(1, 1, 1));
+                start_timer();
+                draw_lions(ref_ren, w, h, false);
+                t1 += elapsed_time();
+
+                tst_ren.clear(agg::rgba(1, 1, 1));
+                start_timer();
+                draw_lions(tst_ren, w, h, true);
+                double t = elapsed_time();
+                if(i == 0) first = t;
+                else       t2 += t;
+            }
+
+            int max_diff = 0;
+            for(i = 0; i < w * h * 4; i++)
+            {
+                int d = abs(int(ref_buf[i]) - int(tst_buf[i]));
+                if(d > max_diff) max_diff = d;
+            }
+            sprintf(buf, "Rasterize: %.2fms\n"
+                         "Cache: first frame %.2fms, then %.2fms\n"
+                         "%u shapes, %u bytes, %u hits, %u misses (diff %d)",
+                    t1 / 20, first, t2 / 19,
+                    m_cache.num_shapes(), m_cache.bytes(),
+                    m_cache.hits(), m_cache.misses(), max_diff);
+            delete [] tst_buf;
+            delete [] ref_buf;
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Shape Cache (click to run the test)");
+
+    if(app.init(512, 400, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "agg_basics.h"
+#include "agg_rendering_buffer.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_path_storage.h"
+#include "agg_conv_transform.h"
+#include "agg_trans_affine.h"
+#include "ctrl/agg_cbox_ctrl.h"
+#include "platform/agg_platform_support.h"
+
+#define AGG_BGR24
+#include "pixel_formats.h"
+
+enum flip_y_e { flip_y = true };
+
+enum { num_vertices = 10000000 };
+
+
+
+// Hides vertices() of the source, so that add_path() reads
+// the vertices one by one.
+template<class VertexSource> class vertex_by_vertex
+{
+public:
+    vertex_by_vertex(VertexSource& vs) : m_vs(&vs) {}
+    void rewind(unsigned path_id) { m_vs->rewind(path_id); }
+    unsigned vertex(double* x, double* y) { return m_vs->vertex(x, y); }
+private:
+    VertexSource* m_vs;
+};
+
+
+
+class the_application : public agg::platform_support
+{
+    agg::cbox_ctrl<agg::rgba8> m_blocks;
+    agg::path_storage          m_path;
+
+public:
+    typedef agg::renderer_base<pixfmt> renderer_base;
+    typedef agg::renderer_scanline_aa_solid<renderer_base> renderer_solid;
+    typedef agg::conv_transform<agg::path_storage> trans_path_type;
+
+    the_application(agg::pix_format_e format, bool flip_y) :
+        agg::platform_support(format, flip_y),
+        m_blocks(5, 5, "Read Vertices in Blocks", !flip_y)
+    {
+        add_ctrl(m_blocks);
+        m_blocks.status(true);
+
+        // A random walk with short segments, like a GPS track
+        double x = 0.5;
+        double y = 0.5;
+        m_path.move_to(x, y);
+        unsigned i;
+        for(i = 1; i < num_vertices; i++)
+        {
+            x += (rand() % 201 - 100) / 10000.0;
+            y += (rand() % 201 - 100) / 10000.0;
+            if(x < 0.0) x = 0.0;
+            if(y < 0.0) y = 0.0;
+            if(x > 1.0) x = 1.0;
+            if(y > 1.0) y = 1.0;
+            m_path.line_to(x, y);
+        }
+    }
+
+    void add_path(agg::rasterizer_scanline_aa<>& ras, bool blocks)
+    {
+        agg::trans_affine mtx;
+        mtx *= agg::trans_affine_scaling(width() - 20, height() - 40);
+        mtx *= agg::trans_affine_translation(10, 30);
+        trans_path_type trans(m_path, mtx);
+        if(blocks)
+        {
+            ras.add_path(trans);
+        }
+        else
+        {
+            vertex_by_vertex<trans_path_type> vs(trans);
+            ras.add_path(vs);
+        }
+    }
+
+    virtual void on_draw()
+    {
+        pixfmt pf(rbuf_window());
+        renderer_base rb(pf);
+        renderer_solid r(rb);
+        rb.clear(agg::rgba(1, 1, 1));
+
+        agg::rasterizer_scanline_aa<> ras;
+        agg::scanline_u8 sl;
+
+        add_path(ras, m_blocks.status());
+        r.color(agg::rgba(0, 0, 0.5, 0.5));
+        agg::render_scanlines(ras, sl, r);
+
+        agg::render_ctrl(ras, sl, rb, m_blocks);
+    }
+
+    virtual void on_mouse_button_down(int x, int y, unsigned flags)
+    {
+        if(flags & agg::mouse_left)
+        {
+            agg::rasterizer_scanline_aa<> ras;
+            double t1 = 0;
+            double t2 = 0;
+            unsigned i;
+            for(i = 0; i < 3; i++)
+            {
+                ras.reset();
+                start_timer();
+                add_path(ras, false);
+                t1 += elapsed_time();
+
+                ras.reset();
+                start_timer();
+                add_path(ras, true);
+                t2 += elapsed_time();
+            }
+            char buf[256];
+            sprintf(buf, "add_path() of %d vertices\n"
+                         "Vertex by vertex: %.1fms\nBlocks: %.1fms",
+                    int(num_vertices), t1 / 3, t2 / 3);
+            message(buf);
+        }
+    }
+
+    virtual void on_ctrl_change()
+    {
+        force_redraw();
+    }
+};
+
+
+
+int agg_main(int argc, char* argv[])
+{
+    the_application app(pix_format, flip_y);
+    app.caption("AGG Example. Vertex Blocks (click to run the test)");
+
+    if(app.init(640, 480, agg::window_resize))
+    {
+        return app.run();
+    }
+    return 1;
+}
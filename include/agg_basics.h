@@ -219,6 +219,16 @@ namespace agg
         cover_full  = cover_mask         //----cover_full 
     };
 
+    //---------------------------------------------------------span_full_cover
+    // Returns the length of the part of the span of a scanline where all
+    // the covers are cover_full and its start in x1, or 0. It's known only
+    // for the scanlines that record it, such as scanline_u8. The packed 
+    // ones use the negative length for the spans of the same cover.
+    template<class Span> inline unsigned span_full_cover(const Span&, int*) 
+    { 
+        return 0; 
+    }
+
     //----------------------------------------------------poly_subpixel_scale_e
     // These constants determine the subpixel accuracy, to be more precise, 
     // the number of bits of the fractional part of the coordinates. 
@@ -473,6 +483,27 @@ namespace agg
         return clear_orientation(c) | o;
     }
 
+    //------------------------------------------------------------vertex_block
+    // Reads up to max vertices from a vertex source, the same as that
+    // many calls of vertex() would, but stops after path_cmd_stop, which
+    // is stored as well. Returns the number of vertices stored. The
+    // vertex sources that can produce a block at once have overloads
+    // of it calling their vertices() method; the others use vertex().
+    //------------------------------------------------------------------------
+    template<class VertexSource> 
+    unsigned vertex_block(VertexSource& vs, 
+                          double* x, double* y, unsigned* cmd, 
+                          unsigned max)
+    {
+        unsigned n = 0;
+        while(n < max)
+        {
+            cmd[n] = vs.vertex(x + n, y + n);
+            if(is_stop(cmd[n++])) break;
+        }
+        return n;
+    }
+
     //--------------------------------------------------------------point_base
     template<class T> struct point_base
     {
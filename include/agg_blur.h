@@ -27,8 +27,11 @@
 #ifndef AGG_BLUR_INCLUDED
 #define AGG_BLUR_INCLUDED
 
+#include <string.h>
 #include "agg_array.h"
 #include "agg_pixfmt_transposer.h"
+#include "agg_simd.h"
+#include "agg_threads.h"
 
 namespace agg
 {
@@ -182,18 +185,31 @@ namespace agg
         }
 
         //--------------------------------------------------------------------
+        // The columns are copied to a pixfmt_transposed_strip and 
+        // blurred as rows.
         template<class Img> void blur_y(Img& img, unsigned radius)
         {
-            pixfmt_transposer<Img> img2(img);
-            blur_x(img2, radius);
+            if(radius < 1) return;
+
+            typedef pixfmt_transposed_strip<Img> strip_type;
+            strip_type strip(img);
+            unsigned w = img.width();
+            unsigned x;
+            for(x = 0; x < w; x += strip_type::tile_size)
+            {
+                unsigned n = w - x;
+                if(n > strip_type::tile_size) n = strip_type::tile_size;
+                strip.load(x, n);
+                blur_x(strip, radius);
+                strip.store();
+            }
         }
 
         //--------------------------------------------------------------------
         template<class Img> void blur(Img& img, unsigned radius)
         {
             blur_x(img, radius);
-            pixfmt_transposer<Img> img2(img);
-            blur_x(img2, radius);
+            blur_y(img, radius);
         }
 
     private:
@@ -350,718 +366,378 @@ namespace agg
 
 
 
-    //========================================================stack_blur_gray8
-    template<class Img> 
-    void stack_blur_gray8(Img& img, unsigned rx, unsigned ry)
+    //--------------------------------------------------------stack_blur_sum8
+    // The sums of stack_blur8 for one line. The stack keeps the pixels 
+    // as stack_pix_size bytes each.
+    template<unsigned NumChannels> struct stack_blur_sum8
     {
-        unsigned x, y, xp, yp, i;
-        unsigned stack_ptr;
-        unsigned stack_start;
+        enum { stack_pix_size = NumChannels };
 
-        const int8u* src_pix_ptr;
-              int8u* dst_pix_ptr;
-        unsigned pix;
-        unsigned stack_pix;
-        unsigned sum;
-        unsigned sum_in;
-        unsigned sum_out;
+        unsigned sum[NumChannels];
+        unsigned sum_in[NumChannels];
+        unsigned sum_out[NumChannels];
 
-        unsigned w   = img.width();
-        unsigned h   = img.height();
-        unsigned wm  = w - 1;
-        unsigned hm  = h - 1;
-
-        unsigned div;
-        unsigned mul_sum;
-        unsigned shr_sum;
-
-        pod_vector<int8u> stack;
-
-        if(rx > 0)
+        static AGG_INLINE void copy_pix(int8u* stack_pix, const int8u* pix)
         {
-            if(rx > 254) rx = 254;
-            div = rx * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[rx];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[rx];
-            stack.allocate(div);
+            for(unsigned i = 0; i < NumChannels; i++) stack_pix[i] = pix[i];
+        }
 
-            for(y = 0; y < h; y++)
+        // The first pixel goes to the stack "radius + 1" times with the 
+        // weights 1...radius+1
+        AGG_INLINE void init(const int8u* pix, unsigned radius)
+        {
+            for(unsigned i = 0; i < NumChannels; i++)
             {
-                sum = sum_in = sum_out = 0;
-
-                src_pix_ptr = img.pix_ptr(0, y);
-                pix = *src_pix_ptr;
-                for(i = 0; i <= rx; i++)
-                {
-                    stack[i] = pix;
-                    sum     += pix * (i + 1);
-                    sum_out += pix;
-                }
-                for(i = 1; i <= rx; i++)
-                {
-                    if(i <= wm) src_pix_ptr += Img::pix_step; 
-                    pix = *src_pix_ptr; 
-                    stack[i + rx] = pix;
-                    sum    += pix * (rx + 1 - i);
-                    sum_in += pix;
-                }
-
-                stack_ptr = rx;
-                xp = rx;
-                if(xp > wm) xp = wm;
-                src_pix_ptr = img.pix_ptr(xp, y);
-                dst_pix_ptr = img.pix_ptr(0, y);
-                for(x = 0; x < w; x++)
-                {
-                    *dst_pix_ptr = (sum * mul_sum) >> shr_sum;
-                    dst_pix_ptr += Img::pix_step;
-
-                    sum -= sum_out;
-       
-                    stack_start = stack_ptr + div - rx;
-                    if(stack_start >= div) stack_start -= div;
-                    sum_out -= stack[stack_start];
-
-                    if(xp < wm) 
-                    {
-                        src_pix_ptr += Img::pix_step;
-                        pix = *src_pix_ptr;
-                        ++xp;
-                    }
-        
-                    stack[stack_start] = pix;
-        
-                    sum_in += pix;
-                    sum    += sum_in;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix = stack[stack_ptr];
+                sum[i]     = pix[i] * ((radius + 1) * (radius + 2) / 2);
+                sum_in[i]  = 0;
+                sum_out[i] = pix[i] * (radius + 1);
+            }
+        }
 
-                    sum_out += stack_pix;
-                    sum_in  -= stack_pix;
-                }
+        // The next "radius" pixels with the weights radius...1
+        AGG_INLINE void add(const int8u* pix, unsigned k)
+        {
+            for(unsigned i = 0; i < NumChannels; i++)
+            {
+                sum[i]    += pix[i] * k;
+                sum_in[i] += pix[i];
             }
         }
 
-        if(ry > 0)
+        AGG_INLINE void step(int8u* dst, const int8u* src, 
+                             int8u* stack_start, const int8u* stack_next,
+                             unsigned mul_sum, unsigned shr_sum)
         {
-            if(ry > 254) ry = 254;
-            div = ry * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[ry];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[ry];
-            stack.allocate(div);
-
-            int stride = img.stride();
-            for(x = 0; x < w; x++)
+            for(unsigned i = 0; i < NumChannels; i++)
             {
-                sum = sum_in = sum_out = 0;
+                dst[i]          = int8u((sum[i] * mul_sum) >> shr_sum);
+                sum[i]         -= sum_out[i];
+                sum_out[i]     -= stack_start[i];
+                stack_start[i]  = src[i];
+                sum_in[i]      += src[i];
+                sum[i]         += sum_in[i];
+                sum_out[i]     += stack_next[i];
+                sum_in[i]      -= stack_next[i];
+            }
+        }
+    };
 
-                src_pix_ptr = img.pix_ptr(x, 0);
-                pix = *src_pix_ptr;
-                for(i = 0; i <= ry; i++)
-                {
-                    stack[i] = pix;
-                    sum     += pix * (i + 1);
-                    sum_out += pix;
-                }
-                for(i = 1; i <= ry; i++)
-                {
-                    if(i <= hm) src_pix_ptr += stride; 
-                    pix = *src_pix_ptr; 
-                    stack[i + ry] = pix;
-                    sum    += pix * (ry + 1 - i);
-                    sum_in += pix;
-                }
+#ifdef AGG_SIMD_SSE2
+    //---------------------------------------------------stack_blur_sum8_sse2
+    // 3 or 4 channels, one 32-bit lane each. The sums are kept unaligned,
+    // pod_vector doesn't guarantee the alignment of __m128i.
+    template<unsigned NumChannels> struct stack_blur_sum8_sse2
+    {
+        enum { stack_pix_size = 4 };
 
-                stack_ptr = ry;
-                yp = ry;
-                if(yp > hm) yp = hm;
-                src_pix_ptr = img.pix_ptr(x, yp);
-                dst_pix_ptr = img.pix_ptr(x, 0);
-                for(y = 0; y < h; y++)
-                {
-                    *dst_pix_ptr = (sum * mul_sum) >> shr_sum;
-                    dst_pix_ptr += stride;
+        int32 sum[4];
+        int32 sum_in[4];
+        int32 sum_out[4];
 
-                    sum -= sum_out;
-       
-                    stack_start = stack_ptr + div - ry;
-                    if(stack_start >= div) stack_start -= div;
-                    sum_out -= stack[stack_start];
-
-                    if(yp < hm) 
-                    {
-                        src_pix_ptr += stride;
-                        pix = *src_pix_ptr;
-                        ++yp;
-                    }
-        
-                    stack[stack_start] = pix;
-        
-                    sum_in += pix;
-                    sum    += sum_in;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix = stack[stack_ptr];
+        static AGG_INLINE void copy_pix(int8u* stack_pix, const int8u* pix)
+        {
+            stack_pix[0] = pix[0];
+            stack_pix[1] = pix[1];
+            stack_pix[2] = pix[2];
+            stack_pix[3] = (NumChannels == 4) ? pix[3] : 0;
+        }
 
-                    sum_out += stack_pix;
-                    sum_in  -= stack_pix;
-                }
+        static AGG_INLINE __m128i load_pix(const int8u* pix)
+        {
+            __m128i v;
+            if(NumChannels == 4) 
+            {
+                v = sse2_load4(pix);
+            }
+            else
+            {
+                v = _mm_cvtsi32_si128(pix[0] | (pix[1] << 8) | (pix[2] << 16));
             }
+            return _mm_unpacklo_epi16(sse2_unpack_lo(v), _mm_setzero_si128());
         }
-    }
 
+        AGG_INLINE void init(const int8u* pix, unsigned radius)
+        {
+            __m128i v = load_pix(pix);
+            _mm_storeu_si128((__m128i*)sum, 
+                sse2_mullo_epi32(v, _mm_set1_epi32((radius + 1) * (radius + 2) / 2)));
+            _mm_storeu_si128((__m128i*)sum_in, _mm_setzero_si128());
+            _mm_storeu_si128((__m128i*)sum_out, 
+                sse2_mullo_epi32(v, _mm_set1_epi32(radius + 1)));
+        }
 
+        AGG_INLINE void add(const int8u* pix, unsigned k)
+        {
+            __m128i v = load_pix(pix);
+            __m128i s = _mm_loadu_si128((const __m128i*)sum);
+            __m128i s_in = _mm_loadu_si128((const __m128i*)sum_in);
+            s = _mm_add_epi32(s, sse2_mullo_epi32(v, _mm_set1_epi32(k)));
+            _mm_storeu_si128((__m128i*)sum, s);
+            _mm_storeu_si128((__m128i*)sum_in, _mm_add_epi32(s_in, v));
+        }
 
-    //========================================================stack_blur_rgb24
-    template<class Img> 
-    void stack_blur_rgb24(Img& img, unsigned rx, unsigned ry)
-    {
-        typedef typename Img::color_type color_type;
-        typedef typename Img::order_type order_type;
-        enum order_e 
-        { 
-            R = order_type::R, 
-            G = order_type::G, 
-            B = order_type::B 
-        };
+        AGG_INLINE void step(int8u* dst, const int8u* src, 
+                             int8u* stack_start, const int8u* stack_next,
+                             unsigned mul_sum, unsigned shr_sum)
+        {
+            __m128i s     = _mm_loadu_si128((const __m128i*)sum);
+            __m128i s_in  = _mm_loadu_si128((const __m128i*)sum_in);
+            __m128i s_out = _mm_loadu_si128((const __m128i*)sum_out);
+
+            __m128i v = _mm_srl_epi32(sse2_mullo_epi32(s, _mm_set1_epi32(mul_sum)), 
+                                      _mm_cvtsi32_si128(shr_sum));
+            v = _mm_and_si128(v, _mm_set1_epi32(0xFF));
+            v = _mm_packs_epi32(v, v);
+            int32 d = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+            if(NumChannels == 4)
+            {
+                memcpy(dst, &d, 4);
+            }
+            else
+            {
+                dst[0] = int8u(d);
+                dst[1] = int8u(d >> 8);
+                dst[2] = int8u(d >> 16);
+            }
 
-        unsigned x, y, xp, yp, i;
-        unsigned stack_ptr;
-        unsigned stack_start;
+            __m128i pix = load_pix(src);
+            s     = _mm_sub_epi32(s, s_out);
+            s_out = _mm_sub_epi32(s_out, load_pix(stack_start));
+            copy_pix(stack_start, src);
+            s_in  = _mm_add_epi32(s_in, pix);
+            s     = _mm_add_epi32(s, s_in);
+            pix   = load_pix(stack_next);
+            s_out = _mm_add_epi32(s_out, pix);
+            s_in  = _mm_sub_epi32(s_in, pix);
+
+            _mm_storeu_si128((__m128i*)sum, s);
+            _mm_storeu_si128((__m128i*)sum_in, s_in);
+            _mm_storeu_si128((__m128i*)sum_out, s_out);
+        }
+    };
 
-        const int8u* src_pix_ptr;
-              int8u* dst_pix_ptr;
-        color_type*  stack_pix_ptr;
+    template<> struct stack_blur_sum8<3> : stack_blur_sum8_sse2<3> {};
+    template<> struct stack_blur_sum8<4> : stack_blur_sum8_sse2<4> {};
+#endif
 
-        unsigned sum_r;
-        unsigned sum_g;
-        unsigned sum_b;
-        unsigned sum_in_r;
-        unsigned sum_in_g;
-        unsigned sum_in_b;
-        unsigned sum_out_r;
-        unsigned sum_out_g;
-        unsigned sum_out_b;
+    //=============================================================stack_blur8
+    // The stack blur of 8-bit components, the core of stack_blur_gray8(),
+    // stack_blur_rgb24() and stack_blur_rgba32(). Blurs in place 
+    // "num_lines" lines of "len" pixels; the lines start "line_step" bytes
+    // apart, the pixels of a line are "pix_step" bytes apart. The first 
+    // NumChannels bytes of each pixel are blurred. The lines are processed 
+    // together, pixel by pixel, so that a strip of image columns is read
+    // row by row instead of going through the memory column by column.
+    //------------------------------------------------------------------------
+    template<unsigned NumChannels> class stack_blur8
+    {
+    public:
+        typedef stack_blur_sum8<NumChannels> sum_type;
+        enum { stack_pix_size = sum_type::stack_pix_size };
 
-        unsigned w   = img.width();
-        unsigned h   = img.height();
-        unsigned wm  = w - 1;
-        unsigned hm  = h - 1;
+        void blur(int8u* ptr, unsigned len, int pix_step, 
+                  unsigned num_lines, int line_step, 
+                  unsigned radius)
+        {
+            if(radius > 254) radius = 254;
 
-        unsigned div;
-        unsigned mul_sum;
-        unsigned shr_sum;
+            unsigned x, xp, i, k;
+            unsigned stack_ptr;
+            unsigned stack_start;
+            unsigned lm  = len - 1;
+            unsigned div = radius * 2 + 1;
+            unsigned mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[radius];
+            unsigned shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[radius];
+            unsigned stack_row = num_lines * stack_pix_size;
 
-        pod_vector<color_type> stack;
+            m_sum.allocate(num_lines);
+            m_stack.allocate(div * stack_row);
 
-        if(rx > 0)
-        {
-            if(rx > 254) rx = 254;
-            div = rx * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[rx];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[rx];
-            stack.allocate(div);
+            const int8u* src_pix_ptr = ptr;
+                  int8u* dst_pix_ptr = ptr;
 
-            for(y = 0; y < h; y++)
+            for(k = 0; k < num_lines; k++)
             {
-                sum_r = 
-                sum_g = 
-                sum_b = 
-                sum_in_r = 
-                sum_in_g = 
-                sum_in_b = 
-                sum_out_r = 
-                sum_out_g = 
-                sum_out_b = 0;
-
-                src_pix_ptr = img.pix_ptr(0, y);
-                for(i = 0; i <= rx; i++)
+                const int8u* pix = src_pix_ptr + int(k) * line_step;
+                m_sum[k].init(pix, radius);
+                for(i = 0; i <= radius; i++)
                 {
-                    stack_pix_ptr    = &stack[i];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    sum_r           += src_pix_ptr[R] * (i + 1);
-                    sum_g           += src_pix_ptr[G] * (i + 1);
-                    sum_b           += src_pix_ptr[B] * (i + 1);
-                    sum_out_r       += src_pix_ptr[R];
-                    sum_out_g       += src_pix_ptr[G];
-                    sum_out_b       += src_pix_ptr[B];
+                    sum_type::copy_pix(&m_stack[i * stack_row + k * stack_pix_size], pix);
                 }
-                for(i = 1; i <= rx; i++)
+            }
+            for(i = 1; i <= radius; i++)
+            {
+                if(i <= lm) src_pix_ptr += pix_step;
+                for(k = 0; k < num_lines; k++)
                 {
-                    if(i <= wm) src_pix_ptr += Img::pix_width; 
-                    stack_pix_ptr = &stack[i + rx];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    sum_r           += src_pix_ptr[R] * (rx + 1 - i);
-                    sum_g           += src_pix_ptr[G] * (rx + 1 - i);
-                    sum_b           += src_pix_ptr[B] * (rx + 1 - i);
-                    sum_in_r        += src_pix_ptr[R];
-                    sum_in_g        += src_pix_ptr[G];
-                    sum_in_b        += src_pix_ptr[B];
-                }
-
-                stack_ptr = rx;
-                xp = rx;
-                if(xp > wm) xp = wm;
-                src_pix_ptr = img.pix_ptr(xp, y);
-                dst_pix_ptr = img.pix_ptr(0, y);
-                for(x = 0; x < w; x++)
-                {
-                    dst_pix_ptr[R] = (sum_r * mul_sum) >> shr_sum;
-                    dst_pix_ptr[G] = (sum_g * mul_sum) >> shr_sum;
-                    dst_pix_ptr[B] = (sum_b * mul_sum) >> shr_sum;
-                    dst_pix_ptr   += Img::pix_width;
-
-                    sum_r -= sum_out_r;
-                    sum_g -= sum_out_g;
-                    sum_b -= sum_out_b;
-       
-                    stack_start = stack_ptr + div - rx;
-                    if(stack_start >= div) stack_start -= div;
-                    stack_pix_ptr = &stack[stack_start];
-
-                    sum_out_r -= stack_pix_ptr->r;
-                    sum_out_g -= stack_pix_ptr->g;
-                    sum_out_b -= stack_pix_ptr->b;
-
-                    if(xp < wm) 
-                    {
-                        src_pix_ptr += Img::pix_width;
-                        ++xp;
-                    }
-        
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-        
-                    sum_in_r += src_pix_ptr[R];
-                    sum_in_g += src_pix_ptr[G];
-                    sum_in_b += src_pix_ptr[B];
-                    sum_r    += sum_in_r;
-                    sum_g    += sum_in_g;
-                    sum_b    += sum_in_b;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix_ptr = &stack[stack_ptr];
-
-                    sum_out_r += stack_pix_ptr->r;
-                    sum_out_g += stack_pix_ptr->g;
-                    sum_out_b += stack_pix_ptr->b;
-                    sum_in_r  -= stack_pix_ptr->r;
-                    sum_in_g  -= stack_pix_ptr->g;
-                    sum_in_b  -= stack_pix_ptr->b;
+                    const int8u* pix = src_pix_ptr + int(k) * line_step;
+                    m_sum[k].add(pix, radius + 1 - i);
+                    sum_type::copy_pix(&m_stack[(i + radius) * stack_row + k * stack_pix_size], pix);
                 }
             }
-        }
 
-        if(ry > 0)
-        {
-            if(ry > 254) ry = 254;
-            div = ry * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[ry];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[ry];
-            stack.allocate(div);
-
-            int stride = img.stride();
-            for(x = 0; x < w; x++)
+            stack_ptr = radius;
+            xp = radius;
+            if(xp > lm) xp = lm;
+            src_pix_ptr = ptr + int(xp) * pix_step;
+            for(x = 0; x < len; x++)
             {
-                sum_r = 
-                sum_g = 
-                sum_b = 
-                sum_in_r = 
-                sum_in_g = 
-                sum_in_b = 
-                sum_out_r = 
-                sum_out_g = 
-                sum_out_b = 0;
-
-                src_pix_ptr = img.pix_ptr(x, 0);
-                for(i = 0; i <= ry; i++)
-                {
-                    stack_pix_ptr    = &stack[i];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    sum_r           += src_pix_ptr[R] * (i + 1);
-                    sum_g           += src_pix_ptr[G] * (i + 1);
-                    sum_b           += src_pix_ptr[B] * (i + 1);
-                    sum_out_r       += src_pix_ptr[R];
-                    sum_out_g       += src_pix_ptr[G];
-                    sum_out_b       += src_pix_ptr[B];
-                }
-                for(i = 1; i <= ry; i++)
+                stack_start = stack_ptr + div - radius;
+                if(stack_start >= div) stack_start -= div;
+
+                if(xp < lm) 
                 {
-                    if(i <= hm) src_pix_ptr += stride; 
-                    stack_pix_ptr = &stack[i + ry];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    sum_r           += src_pix_ptr[R] * (ry + 1 - i);
-                    sum_g           += src_pix_ptr[G] * (ry + 1 - i);
-                    sum_b           += src_pix_ptr[B] * (ry + 1 - i);
-                    sum_in_r        += src_pix_ptr[R];
-                    sum_in_g        += src_pix_ptr[G];
-                    sum_in_b        += src_pix_ptr[B];
+                    src_pix_ptr += pix_step;
+                    ++xp;
                 }
 
-                stack_ptr = ry;
-                yp = ry;
-                if(yp > hm) yp = hm;
-                src_pix_ptr = img.pix_ptr(x, yp);
-                dst_pix_ptr = img.pix_ptr(x, 0);
-                for(y = 0; y < h; y++)
-                {
-                    dst_pix_ptr[R] = (sum_r * mul_sum) >> shr_sum;
-                    dst_pix_ptr[G] = (sum_g * mul_sum) >> shr_sum;
-                    dst_pix_ptr[B] = (sum_b * mul_sum) >> shr_sum;
-                    dst_pix_ptr += stride;
-
-                    sum_r -= sum_out_r;
-                    sum_g -= sum_out_g;
-                    sum_b -= sum_out_b;
-       
-                    stack_start = stack_ptr + div - ry;
-                    if(stack_start >= div) stack_start -= div;
+                ++stack_ptr;
+                if(stack_ptr >= div) stack_ptr = 0;
 
-                    stack_pix_ptr = &stack[stack_start];
-                    sum_out_r -= stack_pix_ptr->r;
-                    sum_out_g -= stack_pix_ptr->g;
-                    sum_out_b -= stack_pix_ptr->b;
-
-                    if(yp < hm) 
-                    {
-                        src_pix_ptr += stride;
-                        ++yp;
-                    }
-        
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-        
-                    sum_in_r += src_pix_ptr[R];
-                    sum_in_g += src_pix_ptr[G];
-                    sum_in_b += src_pix_ptr[B];
-                    sum_r    += sum_in_r;
-                    sum_g    += sum_in_g;
-                    sum_b    += sum_in_b;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix_ptr = &stack[stack_ptr];
-
-                    sum_out_r += stack_pix_ptr->r;
-                    sum_out_g += stack_pix_ptr->g;
-                    sum_out_b += stack_pix_ptr->b;
-                    sum_in_r  -= stack_pix_ptr->r;
-                    sum_in_g  -= stack_pix_ptr->g;
-                    sum_in_b  -= stack_pix_ptr->b;
+                int8u* stack_start_ptr = &m_stack[stack_start * stack_row];
+                int8u* stack_next_ptr  = &m_stack[stack_ptr * stack_row];
+                for(k = 0; k < num_lines; k++)
+                {
+                    m_sum[k].step(dst_pix_ptr + int(k) * line_step, 
+                                  src_pix_ptr + int(k) * line_step,
+                                  stack_start_ptr, 
+                                  stack_next_ptr,
+                                  mul_sum, shr_sum);
+                    stack_start_ptr += stack_pix_size;
+                    stack_next_ptr  += stack_pix_size;
                 }
+                dst_pix_ptr += pix_step;
             }
         }
-    }
-
 
+    private:
+        pod_vector<sum_type> m_sum;
+        pod_vector<int8u>    m_stack;
+    };
 
-    //=======================================================stack_blur_rgba32
-    template<class Img> 
-    void stack_blur_rgba32(Img& img, unsigned rx, unsigned ry)
+    //---------------------------------------------------------stack_blur8_job
+    // Job "i" of "num_jobs" blurs its share of the lines, "block" 
+    // lines at a time.
+    template<unsigned NumChannels> struct stack_blur8_job
     {
-        typedef typename Img::color_type color_type;
-        typedef typename Img::order_type order_type;
-        enum order_e 
-        { 
-            R = order_type::R, 
-            G = order_type::G, 
-            B = order_type::B,
-            A = order_type::A 
-        };
-
-        unsigned x, y, xp, yp, i;
-        unsigned stack_ptr;
-        unsigned stack_start;
-
-        const int8u* src_pix_ptr;
-              int8u* dst_pix_ptr;
-        color_type*  stack_pix_ptr;
-
-        unsigned sum_r;
-        unsigned sum_g;
-        unsigned sum_b;
-        unsigned sum_a;
-        unsigned sum_in_r;
-        unsigned sum_in_g;
-        unsigned sum_in_b;
-        unsigned sum_in_a;
-        unsigned sum_out_r;
-        unsigned sum_out_g;
-        unsigned sum_out_b;
-        unsigned sum_out_a;
-
-        unsigned w   = img.width();
-        unsigned h   = img.height();
-        unsigned wm  = w - 1;
-        unsigned hm  = h - 1;
-
-        unsigned div;
-        unsigned mul_sum;
-        unsigned shr_sum;
-
-        pod_vector<color_type> stack;
-
-        if(rx > 0)
+        int8u*   ptr;
+        unsigned len;
+        int      pix_step;
+        unsigned num_lines;
+        int      line_step;
+        unsigned block;
+        unsigned radius;
+        unsigned num_jobs;
+
+        void operator() (unsigned i)
         {
-            if(rx > 254) rx = 254;
-            div = rx * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[rx];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[rx];
-            stack.allocate(div);
-
-            for(y = 0; y < h; y++)
+            unsigned l1 = unsigned(double(num_lines) * i / num_jobs);
+            unsigned l2 = unsigned(double(num_lines) * (i + 1) / num_jobs);
+            stack_blur8<NumChannels> sb;
+            while(l1 < l2)
             {
-                sum_r = 
-                sum_g = 
-                sum_b = 
-                sum_a = 
-                sum_in_r = 
-                sum_in_g = 
-                sum_in_b = 
-                sum_in_a = 
-                sum_out_r = 
-                sum_out_g = 
-                sum_out_b = 
-                sum_out_a = 0;
-
-                src_pix_ptr = img.pix_ptr(0, y);
-                for(i = 0; i <= rx; i++)
-                {
-                    stack_pix_ptr    = &stack[i];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-                    sum_r           += src_pix_ptr[R] * (i + 1);
-                    sum_g           += src_pix_ptr[G] * (i + 1);
-                    sum_b           += src_pix_ptr[B] * (i + 1);
-                    sum_a           += src_pix_ptr[A] * (i + 1);
-                    sum_out_r       += src_pix_ptr[R];
-                    sum_out_g       += src_pix_ptr[G];
-                    sum_out_b       += src_pix_ptr[B];
-                    sum_out_a       += src_pix_ptr[A];
-                }
-                for(i = 1; i <= rx; i++)
-                {
-                    if(i <= wm) src_pix_ptr += Img::pix_width; 
-                    stack_pix_ptr = &stack[i + rx];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-                    sum_r           += src_pix_ptr[R] * (rx + 1 - i);
-                    sum_g           += src_pix_ptr[G] * (rx + 1 - i);
-                    sum_b           += src_pix_ptr[B] * (rx + 1 - i);
-                    sum_a           += src_pix_ptr[A] * (rx + 1 - i);
-                    sum_in_r        += src_pix_ptr[R];
-                    sum_in_g        += src_pix_ptr[G];
-                    sum_in_b        += src_pix_ptr[B];
-                    sum_in_a        += src_pix_ptr[A];
-                }
-
-                stack_ptr = rx;
-                xp = rx;
-                if(xp > wm) xp = wm;
-                src_pix_ptr = img.pix_ptr(xp, y);
-                dst_pix_ptr = img.pix_ptr(0, y);
-                for(x = 0; x < w; x++)
-                {
-                    dst_pix_ptr[R] = (sum_r * mul_sum) >> shr_sum;
-                    dst_pix_ptr[G] = (sum_g * mul_sum) >> shr_sum;
-                    dst_pix_ptr[B] = (sum_b * mul_sum) >> shr_sum;
-                    dst_pix_ptr[A] = (sum_a * mul_sum) >> shr_sum;
-                    dst_pix_ptr += Img::pix_width;
-
-                    sum_r -= sum_out_r;
-                    sum_g -= sum_out_g;
-                    sum_b -= sum_out_b;
-                    sum_a -= sum_out_a;
-       
-                    stack_start = stack_ptr + div - rx;
-                    if(stack_start >= div) stack_start -= div;
-                    stack_pix_ptr = &stack[stack_start];
-
-                    sum_out_r -= stack_pix_ptr->r;
-                    sum_out_g -= stack_pix_ptr->g;
-                    sum_out_b -= stack_pix_ptr->b;
-                    sum_out_a -= stack_pix_ptr->a;
-
-                    if(xp < wm) 
-                    {
-                        src_pix_ptr += Img::pix_width;
-                        ++xp;
-                    }
-        
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-        
-                    sum_in_r += src_pix_ptr[R];
-                    sum_in_g += src_pix_ptr[G];
-                    sum_in_b += src_pix_ptr[B];
-                    sum_in_a += src_pix_ptr[A];
-                    sum_r    += sum_in_r;
-                    sum_g    += sum_in_g;
-                    sum_b    += sum_in_b;
-                    sum_a    += sum_in_a;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix_ptr = &stack[stack_ptr];
-
-                    sum_out_r += stack_pix_ptr->r;
-                    sum_out_g += stack_pix_ptr->g;
-                    sum_out_b += stack_pix_ptr->b;
-                    sum_out_a += stack_pix_ptr->a;
-                    sum_in_r  -= stack_pix_ptr->r;
-                    sum_in_g  -= stack_pix_ptr->g;
-                    sum_in_b  -= stack_pix_ptr->b;
-                    sum_in_a  -= stack_pix_ptr->a;
-                }
+                unsigned n = l2 - l1;
+                if(n > block) n = block;
+                sb.blur(ptr + int(l1) * line_step, len, pix_step, n, line_step, radius);
+                l1 += n;
             }
         }
+    };
 
+    //----------------------------------------------------stack_blur8_image
+    // Blurs the rows with "rx" and then the columns with "ry" of the 
+    // image that starts at "ptr", with up to "num_threads" threads. 
+    // The rows are blurred stack_blur8_rows at a time, which hides the
+    // latency of the sums, the columns in strips of stack_blur8_strip 
+    // bytes wide.
+    //------------------------------------------------------------------------
+    enum stack_blur8_block_e 
+    { 
+        stack_blur8_rows  = 8,
+        stack_blur8_strip = 64 
+    };
+
+    template<unsigned NumChannels> 
+    void stack_blur8_image(int8u* ptr, unsigned w, unsigned h, 
+                           int pix_step, int stride,
+                           unsigned rx, unsigned ry,
+                           unsigned num_threads)
+    {
+        if(w == 0 || h == 0) return;
+        if(num_threads == 0) num_threads = 1;
+
+        stack_blur8_job<NumChannels> job;
+        job.ptr = ptr;
+        if(rx > 0)
+        {
+            job.len       = w;
+            job.pix_step  = pix_step;
+            job.num_lines = h;
+            job.line_step = stride;
+            job.block     = stack_blur8_rows;
+            job.radius    = rx;
+            job.num_jobs  = (num_threads < h) ? num_threads : h;
+            parallel_for(job, job.num_jobs, num_threads);
+        }
         if(ry > 0)
         {
-            if(ry > 254) ry = 254;
-            div = ry * 2 + 1;
-            mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[ry];
-            shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[ry];
-            stack.allocate(div);
-
-            int stride = img.stride();
-            for(x = 0; x < w; x++)
-            {
-                sum_r = 
-                sum_g = 
-                sum_b = 
-                sum_a = 
-                sum_in_r = 
-                sum_in_g = 
-                sum_in_b = 
-                sum_in_a = 
-                sum_out_r = 
-                sum_out_g = 
-                sum_out_b = 
-                sum_out_a = 0;
-
-                src_pix_ptr = img.pix_ptr(x, 0);
-                for(i = 0; i <= ry; i++)
-                {
-                    stack_pix_ptr    = &stack[i];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-                    sum_r           += src_pix_ptr[R] * (i + 1);
-                    sum_g           += src_pix_ptr[G] * (i + 1);
-                    sum_b           += src_pix_ptr[B] * (i + 1);
-                    sum_a           += src_pix_ptr[A] * (i + 1);
-                    sum_out_r       += src_pix_ptr[R];
-                    sum_out_g       += src_pix_ptr[G];
-                    sum_out_b       += src_pix_ptr[B];
-                    sum_out_a       += src_pix_ptr[A];
-                }
-                for(i = 1; i <= ry; i++)
-                {
-                    if(i <= hm) src_pix_ptr += stride; 
-                    stack_pix_ptr = &stack[i + ry];
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-                    sum_r           += src_pix_ptr[R] * (ry + 1 - i);
-                    sum_g           += src_pix_ptr[G] * (ry + 1 - i);
-                    sum_b           += src_pix_ptr[B] * (ry + 1 - i);
-                    sum_a           += src_pix_ptr[A] * (ry + 1 - i);
-                    sum_in_r        += src_pix_ptr[R];
-                    sum_in_g        += src_pix_ptr[G];
-                    sum_in_b        += src_pix_ptr[B];
-                    sum_in_a        += src_pix_ptr[A];
-                }
+            job.len       = h;
+            job.pix_step  = stride;
+            job.num_lines = w;
+            job.line_step = pix_step;
+            job.block     = stack_blur8_strip / pix_step;
+            if(job.block == 0) job.block = 1;
+            job.radius    = ry;
+            job.num_jobs  = (num_threads < w) ? num_threads : w;
+            parallel_for(job, job.num_jobs, num_threads);
+        }
+    }
 
-                stack_ptr = ry;
-                yp = ry;
-                if(yp > hm) yp = hm;
-                src_pix_ptr = img.pix_ptr(x, yp);
-                dst_pix_ptr = img.pix_ptr(x, 0);
-                for(y = 0; y < h; y++)
-                {
-                    dst_pix_ptr[R] = (sum_r * mul_sum) >> shr_sum;
-                    dst_pix_ptr[G] = (sum_g * mul_sum) >> shr_sum;
-                    dst_pix_ptr[B] = (sum_b * mul_sum) >> shr_sum;
-                    dst_pix_ptr[A] = (sum_a * mul_sum) >> shr_sum;
-                    dst_pix_ptr += stride;
-
-                    sum_r -= sum_out_r;
-                    sum_g -= sum_out_g;
-                    sum_b -= sum_out_b;
-                    sum_a -= sum_out_a;
-       
-                    stack_start = stack_ptr + div - ry;
-                    if(stack_start >= div) stack_start -= div;
+    //========================================================stack_blur_gray8
+    // The horizontal pass is parallelized across rows and the vertical
+    // one across column strips, with up to "num_threads" threads. 
+    // The result doesn't depend on the number of threads.
+    template<class Img> 
+    void stack_blur_gray8(Img& img, unsigned rx, unsigned ry, 
+                          unsigned num_threads = 1)
+    {
+        if(img.width() == 0 || img.height() == 0) return;
+        stack_blur8_image<1>(img.pix_ptr(0, 0), img.width(), img.height(),
+                             Img::pix_step, img.stride(), 
+                             rx, ry, num_threads);
+    }
 
-                    stack_pix_ptr = &stack[stack_start];
-                    sum_out_r -= stack_pix_ptr->r;
-                    sum_out_g -= stack_pix_ptr->g;
-                    sum_out_b -= stack_pix_ptr->b;
-                    sum_out_a -= stack_pix_ptr->a;
-
-                    if(yp < hm) 
-                    {
-                        src_pix_ptr += stride;
-                        ++yp;
-                    }
-        
-                    stack_pix_ptr->r = src_pix_ptr[R];
-                    stack_pix_ptr->g = src_pix_ptr[G];
-                    stack_pix_ptr->b = src_pix_ptr[B];
-                    stack_pix_ptr->a = src_pix_ptr[A];
-        
-                    sum_in_r += src_pix_ptr[R];
-                    sum_in_g += src_pix_ptr[G];
-                    sum_in_b += src_pix_ptr[B];
-                    sum_in_a += src_pix_ptr[A];
-                    sum_r    += sum_in_r;
-                    sum_g    += sum_in_g;
-                    sum_b    += sum_in_b;
-                    sum_a    += sum_in_a;
-        
-                    ++stack_ptr;
-                    if(stack_ptr >= div) stack_ptr = 0;
-                    stack_pix_ptr = &stack[stack_ptr];
-
-                    sum_out_r += stack_pix_ptr->r;
-                    sum_out_g += stack_pix_ptr->g;
-                    sum_out_b += stack_pix_ptr->b;
-                    sum_out_a += stack_pix_ptr->a;
-                    sum_in_r  -= stack_pix_ptr->r;
-                    sum_in_g  -= stack_pix_ptr->g;
-                    sum_in_b  -= stack_pix_ptr->b;
-                    sum_in_a  -= stack_pix_ptr->a;
-                }
-            }
-        }
+    //========================================================stack_blur_rgb24
+    template<class Img> 
+    void stack_blur_rgb24(Img& img, unsigned rx, unsigned ry, 
+                          unsigned num_threads = 1)
+    {
+        if(img.width() == 0 || img.height() == 0) return;
+        stack_blur8_image<3>(img.pix_ptr(0, 0), img.width(), img.height(),
+                             Img::pix_width, img.stride(), 
+                             rx, ry, num_threads);
+    }
+
+    //=======================================================stack_blur_rgba32
+    template<class Img> 
+    void stack_blur_rgba32(Img& img, unsigned rx, unsigned ry, 
+                           unsigned num_threads = 1)
+    {
+        if(img.width() == 0 || img.height() == 0) return;
+        stack_blur8_image<4>(img.pix_ptr(0, 0), img.width(), img.height(),
+                             Img::pix_width, img.stride(), 
+                             rx, ry, num_threads);
     }
 
 
 
     //===========================================================recursive_blur
+    // blur_x() is parallelized across rows and blur_y() across columns,
+    // see num_threads(). The lines are processed in groups of "strip_width",
+    // pixel by pixel, so that a strip of columns is read row by row and
+    // the rows are blurred in parallel by the CPU. The result doesn't 
+    // depend on the number of threads.
+    //------------------------------------------------------------------------
     template<class ColorT, class CalculatorT> class recursive_blur
     {
     public:
@@ -1070,11 +746,76 @@ namespace agg
         typedef typename color_type::value_type value_type;
         typedef typename calculator_type::value_type calc_type;
 
+        enum strip_width_e { strip_width = 16 };
+
+        //--------------------------------------------------------------------
+        recursive_blur() : m_num_threads(1) {}
+
+        void num_threads(unsigned n) { m_num_threads = n ? n : 1; }
+        unsigned num_threads() const { return m_num_threads; }
+
         //--------------------------------------------------------------------
         template<class Img> void blur_x(Img& img, double radius)
+        {
+            blur_lines(img, radius, strip_width);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_y(Img& img, double radius)
+        {
+            pixfmt_transposer<Img> img2(img);
+            blur_lines(img2, radius, strip_width);
+        }
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur(Img& img, double radius)
+        {
+            blur_x(img, radius);
+            blur_y(img, radius);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        struct coef_type
+        {
+            calc_type b, b1, b2, b3;
+        };
+
+        //--------------------------------------------------------------------
+        // Job "i" of "num_jobs" blurs its share of the rows, "block" 
+        // rows at a time.
+        template<class Img> struct blur_job
+        {
+            Img*      img;
+            coef_type coef;
+            unsigned  block;
+            unsigned  num_jobs;
+
+            void operator() (unsigned i)
+            {
+                unsigned h  = img->height();
+                unsigned y1 = unsigned(double(h) * i / num_jobs);
+                unsigned y2 = unsigned(double(h) * (i + 1) / num_jobs);
+                pod_vector<calculator_type> sum1;
+                pod_vector<calculator_type> sum2;
+                sum1.allocate(img->width() * block);
+                sum2.allocate(img->width() * block);
+                while(y1 < y2)
+                {
+                    unsigned n = y2 - y1;
+                    if(n > block) n = block;
+                    blur_rows(*img, coef, y1, n, &sum1[0], &sum2[0]);
+                    y1 += n;
+                }
+            }
+        };
+
+        //--------------------------------------------------------------------
+        template<class Img> void blur_lines(Img& img, double radius, unsigned block)
         {
             if(radius < 0.62) return;
             if(img.width() < 3) return;
+            if(img.height() == 0) return;
 
             calc_type s = calc_type(radius * 0.5);
             calc_type q = calc_type((s < 2.5) ?
@@ -1104,66 +845,85 @@ namespace agg
             b2 *= b0;
             b3 *= b0;
 
+            blur_job<Img> job;
+            job.img      = &img;
+            job.coef.b   = b;
+            job.coef.b1  = b1;
+            job.coef.b2  = b2;
+            job.coef.b3  = b3;
+            job.block    = block;
+            job.num_jobs = m_num_threads;
+            if(job.num_jobs > img.height()) job.num_jobs = img.height();
+            parallel_for(job, job.num_jobs, m_num_threads);
+        }
+
+        //--------------------------------------------------------------------
+        // Blurs "n" rows starting from "y1". The sums of pixel "x" in row
+        // "y1 + k" are sum1[x * n + k] and sum2[x * n + k].
+        template<class Img> 
+        static void blur_rows(Img& img, const coef_type& coef, 
+                              int y1, int n, 
+                              calculator_type* sum1, 
+                              calculator_type* sum2)
+        {
+            calc_type b  = coef.b;
+            calc_type b1 = coef.b1;
+            calc_type b2 = coef.b2;
+            calc_type b3 = coef.b3;
+
             int w = img.width();
-            int h = img.height();
             int wm = w-1;
-            int x, y;
+            int x, k;
+            calculator_type c;
+            color_type pix;
 
-            m_sum1.allocate(w);
-            m_sum2.allocate(w);
-            m_buf.allocate(w);
+            for(k = 0; k < n; k++)
+            {
+                calculator_type* s = sum1 + k;
+                c.from_pix(img.pixel(0, y1 + k));
+                s[0].calc(b, b1, b2, b3, c, c, c, c);
+                c.from_pix(img.pixel(1, y1 + k));
+                s[n].calc(b, b1, b2, b3, c, s[0], s[0], s[0]);
+                c.from_pix(img.pixel(2, y1 + k));
+                s[2*n].calc(b, b1, b2, b3, c, s[n], s[0], s[0]);
+            }
 
-            for(y = 0; y < h; y++)
+            for(x = 3; x < w; ++x)
             {
-                calculator_type c;
-                c.from_pix(img.pixel(0, y));
-                m_sum1[0].calc(b, b1, b2, b3, c, c, c, c);
-                c.from_pix(img.pixel(1, y));
-                m_sum1[1].calc(b, b1, b2, b3, c, m_sum1[0], m_sum1[0], m_sum1[0]);
-                c.from_pix(img.pixel(2, y));
-                m_sum1[2].calc(b, b1, b2, b3, c, m_sum1[1], m_sum1[0], m_sum1[0]);
-
-                for(x = 3; x < w; ++x)
-                {
-                    c.from_pix(img.pixel(x, y));
-                    m_sum1[x].calc(b, b1, b2, b3, c, m_sum1[x-1], m_sum1[x-2], m_sum1[x-3]);
-                }
-    
-                m_sum2[wm  ].calc(b, b1, b2, b3, m_sum1[wm  ], m_sum1[wm  ], m_sum1[wm], m_sum1[wm]);
-                m_sum2[wm-1].calc(b, b1, b2, b3, m_sum1[wm-1], m_sum2[wm  ], m_sum2[wm], m_sum2[wm]);
-                m_sum2[wm-2].calc(b, b1, b2, b3, m_sum1[wm-2], m_sum2[wm-1], m_sum2[wm], m_sum2[wm]);
-                m_sum2[wm  ].to_pix(m_buf[wm  ]);
-                m_sum2[wm-1].to_pix(m_buf[wm-1]);
-                m_sum2[wm-2].to_pix(m_buf[wm-2]);
-
-                for(x = wm-3; x >= 0; --x)
+                calculator_type* s = sum1 + x * n;
+                for(k = 0; k < n; k++)
                 {
-                    m_sum2[x].calc(b, b1, b2, b3, m_sum1[x], m_sum2[x+1], m_sum2[x+2], m_sum2[x+3]);
-                    m_sum2[x].to_pix(m_buf[x]);
+                    c.from_pix(img.pixel(x, y1 + k));
+                    s[k].calc(b, b1, b2, b3, c, s[k-n], s[k-2*n], s[k-3*n]);
                 }
-                img.copy_color_hspan(0, y, w, &m_buf[0]);
             }
-        }
 
-        //--------------------------------------------------------------------
-        template<class Img> void blur_y(Img& img, double radius)
-        {
-            pixfmt_transposer<Img> img2(img);
-            blur_x(img2, radius);
-        }
+            for(k = 0; k < n; k++)
+            {
+                const calculator_type* s1 = sum1 + wm * n + k;
+                calculator_type*       s2 = sum2 + wm * n + k;
+                s2[ 0  ].calc(b, b1, b2, b3, s1[ 0  ], s1[ 0], s1[0], s1[0]);
+                s2[-n  ].calc(b, b1, b2, b3, s1[-n  ], s2[ 0], s2[0], s2[0]);
+                s2[-2*n].calc(b, b1, b2, b3, s1[-2*n], s2[-n], s2[0], s2[0]);
+                s2[ 0  ].to_pix(pix); img.copy_pixel(wm,   y1 + k, pix);
+                s2[-n  ].to_pix(pix); img.copy_pixel(wm-1, y1 + k, pix);
+                s2[-2*n].to_pix(pix); img.copy_pixel(wm-2, y1 + k, pix);
+            }
 
-        //--------------------------------------------------------------------
-        template<class Img> void blur(Img& img, double radius)
-        {
-            blur_x(img, radius);
-            pixfmt_transposer<Img> img2(img);
-            blur_x(img2, radius);
+            for(x = wm-3; x >= 0; --x)
+            {
+                const calculator_type* s1 = sum1 + x * n;
+                calculator_type*       s2 = sum2 + x * n;
+                for(k = 0; k < n; k++)
+                {
+                    s2[k].calc(b, b1, b2, b3, s1[k], s2[k+n], s2[k+2*n], s2[k+3*n]);
+                    s2[k].to_pix(pix);
+                    img.copy_pixel(x, y1 + k, pix);
+                }
+            }
         }
 
-    private:
-        agg::pod_vector<calculator_type> m_sum1;
-        agg::pod_vector<calculator_type> m_sum2;
-        agg::pod_vector<color_type>      m_buf;
+        unsigned m_num_threads;
     };
 
 
@@ -1211,6 +971,37 @@ namespace agg
     };
 
 
+#ifdef AGG_SIMD_SSE2
+    //------------------------------------------------------------------------
+    // Two channels per register, the operations in each channel are the 
+    // same as in the plain C++ code, so is the result.
+    template<> 
+    AGG_INLINE void recursive_blur_calc_rgba<double>::calc(double b1, 
+                                                           double b2, 
+                                                           double b3, 
+                                                           double b4,
+                                                           const self_type& c1, 
+                                                           const self_type& c2, 
+                                                           const self_type& c3, 
+                                                           const self_type& c4)
+    {
+        __m128d k1 = _mm_set1_pd(b1);
+        __m128d k2 = _mm_set1_pd(b2);
+        __m128d k3 = _mm_set1_pd(b3);
+        __m128d k4 = _mm_set1_pd(b4);
+        __m128d rg = _mm_mul_pd(k1, _mm_loadu_pd(&c1.r));
+        __m128d ba = _mm_mul_pd(k1, _mm_loadu_pd(&c1.b));
+        rg = _mm_add_pd(rg, _mm_mul_pd(k2, _mm_loadu_pd(&c2.r)));
+        ba = _mm_add_pd(ba, _mm_mul_pd(k2, _mm_loadu_pd(&c2.b)));
+        rg = _mm_add_pd(rg, _mm_mul_pd(k3, _mm_loadu_pd(&c3.r)));
+        ba = _mm_add_pd(ba, _mm_mul_pd(k3, _mm_loadu_pd(&c3.b)));
+        rg = _mm_add_pd(rg, _mm_mul_pd(k4, _mm_loadu_pd(&c4.r)));
+        ba = _mm_add_pd(ba, _mm_mul_pd(k4, _mm_loadu_pd(&c4.b)));
+        _mm_storeu_pd(&r, rg);
+        _mm_storeu_pd(&b, ba);
+    }
+#endif
+
     //=================================================recursive_blur_calc_rgb
     template<class T=double> struct recursive_blur_calc_rgb
     {
@@ -13,19 +13,302 @@
 //          http://www.antigrain.com
 //----------------------------------------------------------------------------
 //
-// classes conv_curve
+// classes conv_curve, curve_cache
 //
 //----------------------------------------------------------------------------
 
 #ifndef AGG_CONV_CURVE_INCLUDED
 #define AGG_CONV_CURVE_INCLUDED
 
+#include <string.h>
 #include "agg_basics.h"
+#include "agg_array.h"
 #include "agg_curves.h"
 
 namespace agg
 {
 
+    //-------------------------------------------------------------curve_cache
+    // The flattened paths of conv_curve kept from frame to frame, see
+    // conv_curve::cache(). A path is found by its vertices and the
+    // approximation parameters, so the paths that didn't change skip the
+    // subdivision whatever vertex source and path id they come from, and
+    // the ones that changed are just not found. Only the paths with curves
+    // are kept. When a new path doesn't fit in max_bytes the least recently
+    // used paths are evicted, so that the rest take at most a half of it,
+    // and the vertices are compacted. The cache isn't thread safe.
+    //------------------------------------------------------------------------
+    class curve_cache
+    {
+    public:
+        typedef pod_bvector<vertex_d, 10> vertex_storage;
+
+        struct params
+        {
+            double   approximation_scale;
+            double   angle_tolerance;
+            double   cusp_limit;
+            unsigned approximation_method;
+        };
+
+        struct path
+        {
+            params   prm;
+            unsigned hash;
+            unsigned next;
+            unsigned stamp;
+            unsigned src;
+            unsigned num_src;
+            unsigned flat;
+            unsigned num_flat;
+        };
+
+        //--------------------------------------------------------------------
+        curve_cache(unsigned max_bytes = 16 << 20) : 
+            m_max_bytes(max_bytes),
+            m_cur(0),
+            m_clock(0),
+            m_version(0),
+            m_buckets(256)
+        {
+            memset(&m_buckets[0], 0, m_buckets.size() * sizeof(unsigned));
+        }
+
+        //--------------------------------------------------------------------
+        void remove_all()
+        {
+            m_storage[m_cur].remove_all();
+            m_paths.remove_all();
+            memset(&m_buckets[0], 0, m_buckets.size() * sizeof(unsigned));
+            ++m_version;
+        }
+
+        //--------------------------------------------------------------------
+        void     max_bytes(unsigned v) { m_max_bytes = v; }
+        unsigned max_bytes() const { return m_max_bytes; }
+
+        unsigned num_paths() const { return m_paths.size(); }
+        unsigned byte_size() const
+        {
+            return m_storage[m_cur].size() * sizeof(vertex_d) + 
+                   m_paths.size()          * sizeof(path) + 
+                   m_buckets.size()        * sizeof(unsigned);
+        }
+
+        //--------------------------------------------------------------------
+        // The storage of the vertices and its version, which changes when
+        // the paths are moved or removed.
+        const vertex_storage& vertices() const { return m_storage[m_cur]; }
+        unsigned version() const { return m_version; }
+
+        //--------------------------------------------------------------------
+        static unsigned calc_hash(const vertex_storage& src, const params& prm)
+        {
+            unsigned h = 2166136261u;
+            h = hash_bytes(h, &prm.approximation_scale, sizeof(double));
+            h = hash_bytes(h, &prm.angle_tolerance,     sizeof(double));
+            h = hash_bytes(h, &prm.cusp_limit,          sizeof(double));
+            h = (h ^ prm.approximation_method) * 16777619u;
+            unsigned i;
+            for(i = 0; i < src.size(); i++)
+            {
+                const vertex_d& v = src[i];
+                h = hash_bytes(h, &v.x, sizeof(double));
+                h = hash_bytes(h, &v.y, sizeof(double));
+                h = (h ^ v.cmd) * 16777619u;
+            }
+            return h;
+        }
+
+        //--------------------------------------------------------------------
+        // Returns the path with the same source vertices and parameters
+        // or 0. The path found becomes the most recently used one.
+        const path* find(unsigned hash, 
+                         const vertex_storage& src, 
+                         const params& prm)
+        {
+            unsigned idx = m_buckets[hash & (m_buckets.size() - 1)];
+            while(idx)
+            {
+                path& p = m_paths[idx - 1];
+                if(p.hash == hash && equal(p, src, prm)) 
+                {
+                    p.stamp = ++m_clock;
+                    return &p;
+                }
+                idx = p.next;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Stores the flattened path, evicting the old ones if needed.
+        // Returns 0 if the path alone doesn't fit.
+        const path* add(unsigned hash, 
+                        const vertex_storage& src, 
+                        const params& prm,
+                        const vertex_storage& flat)
+        {
+            unsigned size = (src.size() + flat.size()) * sizeof(vertex_d) + 
+                            sizeof(path);
+            unsigned buckets_size = m_buckets.size() * sizeof(unsigned);
+            if(size + buckets_size > m_max_bytes) return 0;
+
+            if(byte_size() + size > m_max_bytes)
+            {
+                unsigned keep = (m_max_bytes - buckets_size) / 2;
+                if(keep > m_max_bytes - buckets_size - size) 
+                {
+                    keep = m_max_bytes - buckets_size - size;
+                }
+                evict(keep);
+            }
+
+            // More buckets only if they fit as well, otherwise the chains
+            // just get longer.
+            if(m_paths.size() >= m_buckets.size() &&
+               byte_size() + size + buckets_size <= m_max_bytes)
+            {
+                rehash(m_buckets.size() * 2);
+            }
+
+            vertex_storage& vertices = m_storage[m_cur];
+            path p;
+            p.prm      = prm;
+            p.hash     = hash;
+            p.stamp    = ++m_clock;
+            p.src      = vertices.size();
+            p.num_src  = src.size();
+            p.flat     = p.src + p.num_src;
+            p.num_flat = flat.size();
+            unsigned i;
+            for(i = 0; i < src.size();  i++) vertices.add(src[i]);
+            for(i = 0; i < flat.size(); i++) vertices.add(flat[i]);
+
+            unsigned& bucket = m_buckets[hash & (m_buckets.size() - 1)];
+            p.next = bucket;
+            m_paths.add(p);
+            bucket = m_paths.size();
+            return &m_paths[m_paths.size() - 1];
+        }
+
+    private:
+        curve_cache(const curve_cache&);
+        const curve_cache& operator = (const curve_cache&);
+
+        //--------------------------------------------------------------------
+        static unsigned hash_bytes(unsigned h, const void* p, unsigned size)
+        {
+            const int8u* b = (const int8u*)p;
+            while(size--) h = (h ^ *b++) * 16777619u;
+            return h;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned path_size(const path& p)
+        {
+            return (p.num_src + p.num_flat) * sizeof(vertex_d) + sizeof(path);
+        }
+
+        //--------------------------------------------------------------------
+        struct stamp_greater
+        {
+            const pod_bvector<path, 8>* paths;
+            stamp_greater(const pod_bvector<path, 8>& p) : paths(&p) {}
+            bool operator () (unsigned a, unsigned b) const
+            {
+                return (*paths)[a].stamp > (*paths)[b].stamp;
+            }
+        };
+
+        //--------------------------------------------------------------------
+        bool equal(const path& p, const vertex_storage& src, const params& prm) const
+        {
+            if(p.num_src != src.size() ||
+               p.prm.approximation_scale  != prm.approximation_scale ||
+               p.prm.angle_tolerance      != prm.angle_tolerance ||
+               p.prm.cusp_limit           != prm.cusp_limit ||
+               p.prm.approximation_method != prm.approximation_method)
+            {
+                return false;
+            }
+            const vertex_storage& vertices = m_storage[m_cur];
+            unsigned i;
+            for(i = 0; i < p.num_src; i++)
+            {
+                const vertex_d& v1 = vertices[p.src + i];
+                const vertex_d& v2 = src[i];
+                if(v1.x != v2.x || v1.y != v2.y || v1.cmd != v2.cmd) return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        // Keeps the most recently used paths that take up to keep_bytes
+        // and copies their vertices to the other storage.
+        void evict(unsigned keep_bytes)
+        {
+            pod_array<unsigned> order(m_paths.size());
+            unsigned i;
+            for(i = 0; i < m_paths.size(); i++) order[i] = i;
+            quick_sort(order, stamp_greater(m_paths));
+
+            unsigned min_stamp = m_clock + 1;
+            unsigned bytes = 0;
+            for(i = 0; i < order.size(); i++)
+            {
+                const path& p = m_paths[order[i]];
+                bytes += path_size(p);
+                if(bytes > keep_bytes) break;
+                min_stamp = p.stamp;
+            }
+
+            const vertex_storage& src = m_storage[m_cur];
+            vertex_storage&       dst = m_storage[m_cur ^ 1];
+            dst.remove_all();
+            unsigned num_paths = 0;
+            for(i = 0; i < m_paths.size(); i++)
+            {
+                path p = m_paths[i];
+                if(p.stamp < min_stamp) continue;
+                unsigned start = dst.size();
+                unsigned j;
+                for(j = 0; j < p.num_src + p.num_flat; j++) dst.add(src[p.src + j]);
+                p.src  = start;
+                p.flat = start + p.num_src;
+                m_paths[num_paths++] = p;
+            }
+            m_paths.free_tail(num_paths);
+            m_storage[m_cur].free_all();
+            m_cur ^= 1;
+            ++m_version;
+            rehash(m_buckets.size());
+        }
+
+        //--------------------------------------------------------------------
+        void rehash(unsigned num_buckets)
+        {
+            m_buckets.resize(num_buckets);
+            memset(&m_buckets[0], 0, num_buckets * sizeof(unsigned));
+            unsigned i;
+            for(i = 0; i < m_paths.size(); i++)
+            {
+                unsigned& bucket = m_buckets[m_paths[i].hash & (num_buckets - 1)];
+                m_paths[i].next = bucket;
+                bucket = i + 1;
+            }
+        }
+
+        unsigned                m_max_bytes;
+        vertex_storage          m_storage[2];
+        unsigned                m_cur;
+        unsigned                m_clock;
+        unsigned                m_version;
+        pod_bvector<path, 8>    m_paths;
+        pod_array<unsigned>     m_buckets;
+    };
+
+
 
     //---------------------------------------------------------------conv_curve
     // Curve converter class. Any path storage can have Bezier curves defined 
@@ -61,7 +344,9 @@ namespace agg
         typedef conv_curve<VertexSource, Curve3, Curve4> self_type;
 
         explicit conv_curve(VertexSource& source) :
-          m_source(&source), m_last_x(0.0), m_last_y(0.0) {}
+          m_source(&source), m_last_x(0.0), m_last_y(0.0),
+          m_cache(0), m_hash(0), m_cached(false), m_version(0),
+          m_out(0), m_out_start(0), m_out_idx(0), m_out_end(0) {}
         void attach(VertexSource& source) { m_source = &source; }
 
         void approximation_method(curve_approximation_method_e v) 
@@ -108,6 +393,14 @@ namespace agg
             return m_curve4.cusp_limit();  
         }
 
+        // Opt-in caching of the flattened paths, 0 turns it off. The
+        // cache can be shared by conv_curve objects with the same curve
+        // types and must outlive them. With the cache rewind() reads the
+        // whole source path. If the path being read is moved or evicted
+        // by another conv_curve it's found again or flattened anew.
+        void cache(curve_cache* c) { m_cache = c; m_out = 0; m_cached = false; }
+        curve_cache* cache() const { return m_cache; }
+
         void     rewind(unsigned path_id); 
         unsigned vertex(double* x, double* y);
 
@@ -115,11 +408,53 @@ namespace agg
         conv_curve(const self_type&);
         const self_type& operator = (const self_type&);
 
+        // Reads the source path stored by rewind()
+        class stored_source
+        {
+        public:
+            stored_source(const curve_cache::vertex_storage& v) : 
+                m_vertices(&v), m_idx(0) {}
+
+            unsigned vertex(double* x, double* y)
+            {
+                if(m_idx >= m_vertices->size()) 
+                {
+                    *x = *y = 0.0;
+                    return path_cmd_stop;
+                }
+                const vertex_d& v = (*m_vertices)[m_idx++];
+                *x = v.x;
+                *y = v.y;
+                return v.cmd;
+            }
+
+        private:
+            const curve_cache::vertex_storage* m_vertices;
+            unsigned                           m_idx;
+        };
+
+        template<class Source> unsigned flatten_vertex(Source& src, double* x, double* y);
+        void rewind_cached();
+        void flatten_stored();
+        void relocate();
+
         VertexSource* m_source;
         double        m_last_x;
         double        m_last_y;
         curve3_type   m_curve3;
         curve4_type   m_curve4;
+
+        curve_cache*                        m_cache;
+        curve_cache::vertex_storage         m_src;
+        curve_cache::vertex_storage         m_flat;
+        curve_cache::params                 m_prm;
+        unsigned                            m_hash;
+        bool                                m_cached;
+        unsigned                            m_version;
+        const curve_cache::vertex_storage*  m_out;
+        unsigned                            m_out_start;
+        unsigned                            m_out_idx;
+        unsigned                            m_out_end;
     };
 
 
@@ -133,12 +468,131 @@ namespace agg
         m_last_y = 0.0;
         m_curve3.reset();
         m_curve4.reset();
+        m_out = 0;
+        m_cached = false;
+        if(m_cache) rewind_cached();
+    }
+
+
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Curve3, class Curve4>
+    void conv_curve<VertexSource, Curve3, Curve4>::rewind_cached()
+    {
+        bool has_curves = false;
+        m_src.remove_all();
+        for(;;)
+        {
+            vertex_d v;
+            v.cmd = m_source->vertex(&v.x, &v.y);
+            if(is_stop(v.cmd)) break;
+            if(v.cmd == path_cmd_curve3 || v.cmd == path_cmd_curve4) has_curves = true;
+            m_src.add(v);
+        }
+
+        if(!has_curves)
+        {
+            m_out       = &m_src;
+            m_out_start = 0;
+            m_out_idx   = 0;
+            m_out_end   = m_src.size();
+            return;
+        }
+
+        m_prm.approximation_scale  = m_curve4.approximation_scale();
+        m_prm.angle_tolerance      = m_curve4.angle_tolerance();
+        m_prm.cusp_limit           = m_curve4.cusp_limit();
+        m_prm.approximation_method = m_curve4.approximation_method();
+        m_hash = curve_cache::calc_hash(m_src, m_prm);
+
+        const curve_cache::path* p = m_cache->find(m_hash, m_src, m_prm);
+        if(p == 0)
+        {
+            flatten_stored();
+            p = m_cache->add(m_hash, m_src, m_prm, m_flat);
+            if(p == 0) return;
+        }
+        m_cached    = true;
+        m_version   = m_cache->version();
+        m_out       = &m_cache->vertices();
+        m_out_start = p->flat;
+        m_out_idx   = p->flat;
+        m_out_end   = p->flat + p->num_flat;
+    }
+
+
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Curve3, class Curve4>
+    void conv_curve<VertexSource, Curve3, Curve4>::flatten_stored()
+    {
+        m_last_x = 0.0;
+        m_last_y = 0.0;
+        m_curve3.reset();
+        m_curve4.reset();
+        stored_source src(m_src);
+        m_flat.remove_all();
+        vertex_d v;
+        while(!is_stop(v.cmd = flatten_vertex(src, &v.x, &v.y)))
+        {
+            m_flat.add(v);
+        }
+        m_cached    = false;
+        m_out       = &m_flat;
+        m_out_start = 0;
+        m_out_idx   = 0;
+        m_out_end   = m_flat.size();
+    }
+
+
+    //------------------------------------------------------------------------
+    // The cache has moved or evicted the path being read, continues from
+    // the same vertex of the path found again or flattened anew.
+    template<class VertexSource, class Curve3, class Curve4>
+    void conv_curve<VertexSource, Curve3, Curve4>::relocate()
+    {
+        unsigned pos = m_out_idx - m_out_start;
+        const curve_cache::path* p = m_cache->find(m_hash, m_src, m_prm);
+        if(p)
+        {
+            m_version   = m_cache->version();
+            m_out       = &m_cache->vertices();
+            m_out_start = p->flat;
+            m_out_end   = p->flat + p->num_flat;
+        }
+        else
+        {
+            flatten_stored();
+        }
+        m_out_idx = m_out_start + pos;
     }
 
 
     //------------------------------------------------------------------------
     template<class VertexSource, class Curve3, class Curve4>
     unsigned conv_curve<VertexSource, Curve3, Curve4>::vertex(double* x, double* y)
+    {
+        if(m_out)
+        {
+            if(m_cached && m_version != m_cache->version()) relocate();
+            if(m_out_idx >= m_out_end)
+            {
+                *x = *y = 0.0;
+                return path_cmd_stop;
+            }
+            const vertex_d& v = (*m_out)[m_out_idx++];
+            *x = v.x;
+            *y = v.y;
+            return v.cmd;
+        }
+        return flatten_vertex(*m_source, x, y);
+    }
+
+
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Curve3, class Curve4>
+    template<class Source>
+    unsigned conv_curve<VertexSource, Curve3, Curve4>::flatten_vertex(Source& src, 
+                                                                      double* x, 
+                                                                      double* y)
     {
         if(!is_stop(m_curve3.vertex(x, y)))
         {
@@ -159,11 +613,11 @@ namespace agg
         double end_x;
         double end_y;
 
-        unsigned cmd = m_source->vertex(x, y);
+        unsigned cmd = src.vertex(x, y);
         switch(cmd)
         {
         case path_cmd_curve3:
-            m_source->vertex(&end_x, &end_y);
+            src.vertex(&end_x, &end_y);
 
             m_curve3.init(m_last_x, m_last_y, 
                           *x,       *y, 
@@ -175,8 +629,8 @@ namespace agg
             break;
 
         case path_cmd_curve4:
-            m_source->vertex(&ct2_x, &ct2_y);
-            m_source->vertex(&end_x, &end_y);
+            src.vertex(&ct2_x, &ct2_y);
+            src.vertex(&end_x, &end_y);
 
             m_curve4.init(m_last_x, m_last_y, 
                           *x,       *y, 
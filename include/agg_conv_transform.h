@@ -48,6 +48,29 @@ namespace agg
             return cmd;
         }
 
+        // Reads a block of vertices, see vertex_block()
+        unsigned vertices(double* x, double* y, unsigned* cmd, unsigned max)
+        {
+            unsigned n = vertex_block(*m_source, x, y, cmd, max);
+            unsigned i = 0;
+            while(i < n)
+            {
+                // Runs of vertices are transformed at once
+                unsigned len = 0;
+                while(i + len < n && is_vertex(cmd[i + len])) ++len;
+                if(len)
+                {
+                    transform_array(*m_trans, x + i, y + i, len);
+                    i += len;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            return n;
+        }
+
         void transformer(const Transformer& tr)
         {
             m_trans = &tr;
@@ -62,6 +85,15 @@ namespace agg
         const Transformer* m_trans;
     };
 
+    //------------------------------------------------------------------------
+    template<class VertexSource, class Transformer>
+    inline unsigned vertex_block(conv_transform<VertexSource, Transformer>& vs,
+                                 double* x, double* y, unsigned* cmd, 
+                                 unsigned max)
+    {
+        return vs.vertices(x, y, cmd, max);
+    }
+
 
 }
 
@@ -0,0 +1,300 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Read-only file mapping. Uses MapViewOfFile on Windows and mmap
+// elsewhere. Define AGG_NO_MMAP to read the file into memory instead.
+// The files of 4GB and more are not supported.
+//
+// file_replacement writes a file to be mapped under a unique temporary
+// name and renames it when it's complete, also while the old one is mapped.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_FILE_MAPPING_INCLUDED
+#define AGG_FILE_MAPPING_INCLUDED
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "agg_basics.h"
+#include "agg_threads.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#include <process.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(AGG_NO_MMAP)
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace agg
+{
+
+    //============================================================file_mapping
+    class file_mapping
+    {
+    public:
+        ~file_mapping() { close(); }
+
+        file_mapping() :
+            m_data(0),
+            m_size(0)
+#if !defined(AGG_NO_MMAP) && defined(_WIN32)
+            , m_file(INVALID_HANDLE_VALUE),
+            m_map(0)
+#endif
+        {}
+
+        //--------------------------------------------------------------------
+        // Maps the whole file. Returns false if the file can't be opened,
+        // it's empty or it's too big.
+        bool open(const char* file_name)
+        {
+            close();
+#if defined(AGG_NO_MMAP)
+            FILE* fd = fopen(file_name, "rb");
+            if(fd == 0) return false;
+            fseek(fd, 0, SEEK_END);
+            long size = ftell(fd);
+            fseek(fd, 0, SEEK_SET);
+            if(size > 0 && long(unsigned(size)) == size)
+            {
+                int8u* data = pod_allocator<int8u>::allocate(unsigned(size));
+                if(fread(data, 1, size, fd) == size_t(size))
+                {
+                    m_data = data;
+                    m_size = unsigned(size);
+                }
+                else
+                {
+                    pod_allocator<int8u>::deallocate(data, unsigned(size));
+                }
+            }
+            fclose(fd);
+#elif defined(_WIN32)
+            // FILE_SHARE_DELETE lets file_replacement replace the file
+            // while it's mapped.
+            m_file = CreateFileA(file_name, GENERIC_READ, 
+                                 FILE_SHARE_READ | FILE_SHARE_DELETE, 0,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+            if(m_file == INVALID_HANDLE_VALUE) return false;
+            DWORD size_high = 0;
+            DWORD size = GetFileSize(m_file, &size_high);
+            if(size != INVALID_FILE_SIZE && size_high == 0 && size > 0)
+            {
+                m_map = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+                if(m_map)
+                {
+                    m_data = (const int8u*)MapViewOfFile(m_map, FILE_MAP_READ, 0, 0, 0);
+                    if(m_data) m_size = unsigned(size);
+                }
+            }
+#else
+            int fd = ::open(file_name, O_RDONLY);
+            if(fd < 0) return false;
+            struct stat st;
+            if(fstat(fd, &st) == 0 && st.st_size > 0 &&
+               off_t(unsigned(st.st_size)) == st.st_size)
+            {
+                void* p = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                if(p != MAP_FAILED)
+                {
+                    m_data = (const int8u*)p;
+                    m_size = unsigned(st.st_size);
+                }
+            }
+            ::close(fd);
+#endif
+            if(m_data == 0) close();
+            return m_data != 0;
+        }
+
+        //--------------------------------------------------------------------
+        void close()
+        {
+#if defined(AGG_NO_MMAP)
+            if(m_data) pod_allocator<int8u>::deallocate((int8u*)m_data, m_size);
+#elif defined(_WIN32)
+            if(m_data) UnmapViewOfFile(m_data);
+            if(m_map) CloseHandle(m_map);
+            if(m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+            m_map = 0;
+            m_file = INVALID_HANDLE_VALUE;
+#else
+            if(m_data) munmap((void*)m_data, m_size);
+#endif
+            m_data = 0;
+            m_size = 0;
+        }
+
+        //--------------------------------------------------------------------
+        const int8u* data() const { return m_data; }
+        unsigned     size() const { return m_size; }
+
+    private:
+        file_mapping(const file_mapping&);
+        const file_mapping& operator = (const file_mapping&);
+
+        const int8u* m_data;
+        unsigned     m_size;
+#if !defined(AGG_NO_MMAP) && defined(_WIN32)
+        HANDLE       m_file;
+        HANDLE       m_map;
+#endif
+    };
+
+
+
+    //========================================================file_replacement
+    // Creates a file next to the given one with a unique name, the process
+    // id and a counter, opened with O_EXCL, so that the processes writing
+    // the same file at once never share it. commit() renames it to the
+    // given name, the last commit wins and the readers see either the old
+    // file or a complete new one. The file is removed if it's not
+    // committed. The mappings of the old file stay valid, on Windows 
+    // because file_mapping opens it with FILE_SHARE_DELETE.
+    //
+    //     file_replacement f;
+    //     FILE* fd = f.create(file_name);
+    //     bool ok = fd && write_data(fd) && f.commit();
+    //------------------------------------------------------------------------
+    class file_replacement
+    {
+    public:
+        ~file_replacement() { abort(); }
+
+        file_replacement() :
+            m_fd(0),
+            m_file_name(0),
+            m_tmp_name(0),
+            m_tmp_len(0)
+        {}
+
+        //--------------------------------------------------------------------
+        // Returns 0 if the file can't be created.
+        FILE* create(const char* file_name)
+        {
+            abort();
+            m_file_name = file_name;
+            m_tmp_len = strlen(file_name) + 32;
+            m_tmp_name = pod_allocator<char>::allocate(m_tmp_len);
+            unsigned attempt;
+            for(attempt = 0; attempt < 100; attempt++)
+            {
+                sprintf(m_tmp_name, "%s.%u.%u.tmp", file_name, 
+                        unsigned(process_id()), next_counter());
+#if defined(_WIN32)
+                int fd = _open(m_tmp_name, _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY,
+                               _S_IREAD | _S_IWRITE);
+                if(fd >= 0)
+                {
+                    m_fd = _fdopen(fd, "wb");
+                    if(m_fd == 0) _close(fd);
+                    break;
+                }
+#else
+                int fd = ::open(m_tmp_name, O_CREAT | O_EXCL | O_WRONLY, 0644);
+                if(fd >= 0)
+                {
+                    m_fd = fdopen(fd, "wb");
+                    if(m_fd == 0) ::close(fd);
+                    break;
+                }
+#endif
+                if(errno != EEXIST) break;
+            }
+            if(m_fd == 0) abort();
+            return m_fd;
+        }
+
+        //--------------------------------------------------------------------
+        // Closes the file and renames it. On failure the file is removed.
+        bool commit()
+        {
+            if(m_fd == 0) return false;
+            bool ok = fclose(m_fd) == 0;
+            m_fd = 0;
+#if defined(_WIN32)
+            // Unlike rename() it replaces the existing file at once, so 
+            // there's no moment without the file.
+            if(ok) ok = MoveFileExA(m_tmp_name, m_file_name, 
+                                    MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            if(ok) ok = rename(m_tmp_name, m_file_name) == 0;
+#endif
+            if(ok) release();
+            else   abort();
+            return ok;
+        }
+
+        //--------------------------------------------------------------------
+        void abort()
+        {
+            if(m_fd) 
+            {
+                fclose(m_fd);
+                m_fd = 0;
+            }
+            if(m_tmp_name) remove(m_tmp_name);
+            release();
+        }
+
+    private:
+        file_replacement(const file_replacement&);
+        const file_replacement& operator = (const file_replacement&);
+
+        //--------------------------------------------------------------------
+        static unsigned process_id()
+        {
+#if defined(_WIN32)
+            return unsigned(_getpid());
+#else
+            return unsigned(getpid());
+#endif
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned next_counter()
+        {
+            static volatile int counter = 0;
+            return unsigned(atomic_fetch_add(&counter, 1));
+        }
+
+        //--------------------------------------------------------------------
+        void release()
+        {
+            pod_allocator<char>::deallocate(m_tmp_name, m_tmp_len);
+            m_tmp_name = 0;
+            m_tmp_len = 0;
+            m_file_name = 0;
+        }
+
+        FILE*       m_fd;
+        const char* m_file_name;
+        char*       m_tmp_name;
+        unsigned    m_tmp_len;
+    };
+
+}
+
+#endif
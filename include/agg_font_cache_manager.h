@@ -17,7 +17,10 @@
 #define AGG_FONT_CACHE_MANAGER_INCLUDED
 
 #include <string.h>
+#include <stdio.h>
 #include "agg_array.h"
+#include "agg_file_mapping.h"
+#include "agg_threads.h"
 
 namespace agg
 {
@@ -45,32 +48,63 @@ namespace agg
     };
 
 
+    class font_cache;
+
+    //--------------------------------------------------------font_cache_glyph
+    // The glyph as it's kept in font_cache, one allocation together with
+    // its data. The links are used by font_cache_pool.
+    struct font_cache_glyph : glyph_cache
+    {
+        font_cache_glyph* prev;
+        font_cache_glyph* next;
+        font_cache*       font;
+        unsigned          glyph_code;
+        unsigned          byte_size;
+    };
+
+
     //--------------------------------------------------------------font_cache
     class font_cache
     {
     public:
         enum block_size_e { block_size = 16384-16 };
 
+        //--------------------------------------------------------------------
+        ~font_cache()
+        {
+            remove_all();
+        }
+
         //--------------------------------------------------------------------
         font_cache() : 
             m_allocator(block_size),
-            m_font_signature(0)
-        {}
+            m_font_signature(0),
+            m_num_glyphs(0)
+        {
+            memset(m_glyphs, 0, sizeof(m_glyphs));
+        }
 
         //--------------------------------------------------------------------
         void signature(const char* font_signature)
         {
+            remove_all();
             m_font_signature = (char*)m_allocator.allocate(strlen(font_signature) + 1);
             strcpy(m_font_signature, font_signature);
             memset(m_glyphs, 0, sizeof(m_glyphs));
         }
 
+        //--------------------------------------------------------------------
+        const char* signature() const { return m_font_signature; }
+
         //--------------------------------------------------------------------
         bool font_is(const char* font_signature) const
         {
             return strcmp(font_signature, m_font_signature) == 0;
         }
 
+        //--------------------------------------------------------------------
+        unsigned num_glyphs() const { return m_num_glyphs; }
+
         //--------------------------------------------------------------------
         const glyph_cache* find_glyph(unsigned glyph_code) const
         {
@@ -95,32 +129,76 @@ namespace agg
             if(m_glyphs[msb] == 0)
             {
                 m_glyphs[msb] = 
-                    (glyph_cache**)m_allocator.allocate(sizeof(glyph_cache*) * 256, 
-                                                        sizeof(glyph_cache*));
-                memset(m_glyphs[msb], 0, sizeof(glyph_cache*) * 256);
+                    (font_cache_glyph**)m_allocator.allocate(sizeof(font_cache_glyph*) * 256, 
+                                                             sizeof(font_cache_glyph*));
+                memset(m_glyphs[msb], 0, sizeof(font_cache_glyph*) * 256);
             }
 
             unsigned lsb = glyph_code & 0xFF;
             if(m_glyphs[msb][lsb]) return 0; // Already exists, do not overwrite
 
-            glyph_cache* glyph = 
-                (glyph_cache*)m_allocator.allocate(sizeof(glyph_cache),
-                                                   sizeof(double));
+            unsigned byte_size = sizeof(font_cache_glyph) + data_size;
+            font_cache_glyph* glyph = 
+                (font_cache_glyph*)pod_allocator<int8u>::allocate(byte_size);
 
             glyph->glyph_index        = glyph_index;
-            glyph->data               = m_allocator.allocate(data_size);
+            glyph->data               = (int8u*)(glyph + 1);
             glyph->data_size          = data_size;
             glyph->data_type          = data_type;
             glyph->bounds             = bounds;
             glyph->advance_x          = advance_x;
             glyph->advance_y          = advance_y;
+            glyph->prev               = 0;
+            glyph->next               = 0;
+            glyph->font               = this;
+            glyph->glyph_code         = glyph_code & 0xFFFF;
+            glyph->byte_size          = byte_size;
+            ++m_num_glyphs;
             return m_glyphs[msb][lsb] = glyph;
         }
 
+        //--------------------------------------------------------------------
+        void remove_glyph(unsigned glyph_code)
+        {
+            font_cache_glyph** row = m_glyphs[(glyph_code >> 8) & 0xFF];
+            if(row)
+            {
+                font_cache_glyph*& glyph = row[glyph_code & 0xFF];
+                if(glyph)
+                {
+                    pod_allocator<int8u>::deallocate((int8u*)glyph, glyph->byte_size);
+                    glyph = 0;
+                    --m_num_glyphs;
+                }
+            }
+        }
+
     private:
-        block_allocator m_allocator;
-        glyph_cache**   m_glyphs[256];
-        char*           m_font_signature;
+        font_cache(const font_cache&);
+        const font_cache& operator = (const font_cache&);
+
+        //--------------------------------------------------------------------
+        void remove_all()
+        {
+            unsigned i, j;
+            for(i = 0; i < 256; i++)
+            {
+                if(m_glyphs[i])
+                {
+                    for(j = 0; j < 256; j++)
+                    {
+                        font_cache_glyph* glyph = m_glyphs[i][j];
+                        if(glyph) pod_allocator<int8u>::deallocate((int8u*)glyph, glyph->byte_size);
+                    }
+                }
+            }
+            m_num_glyphs = 0;
+        }
+
+        block_allocator    m_allocator;
+        font_cache_glyph** m_glyphs[256];
+        char*              m_font_signature;
+        unsigned           m_num_glyphs;
     };
 
 
@@ -130,6 +208,14 @@ namespace agg
 
     
     //---------------------------------------------------------font_cache_pool
+    // Keeps up to max_fonts fonts and, if max_bytes isn't zero, removes 
+    // the least recently used glyphs of all the fonts when their total 
+    // size exceeds max_bytes. The two most recently used glyphs are never
+    // removed, so the pointers returned by cache_glyph() and passed to
+    // touch() stay valid until the second next call. When there are too many 
+    // fonts the one of the least recently used glyph is removed. The 
+    // fonts are found by the hash of the signature.
+    //------------------------------------------------------------------------
     class font_cache_pool
     {
     public:
@@ -145,12 +231,22 @@ namespace agg
         }
 
         //--------------------------------------------------------------------
-        font_cache_pool(unsigned max_fonts=32) : 
+        font_cache_pool(unsigned max_fonts=32, unsigned max_bytes=0) : 
             m_fonts(pod_allocator<font_cache*>::allocate(max_fonts)),
             m_max_fonts(max_fonts),
             m_num_fonts(0),
-            m_cur_font(0)
-        {}
+            m_cur_font(0),
+            m_hashes(max_fonts),
+            m_hash_table(hash_table_size(max_fonts)),
+            m_max_bytes(max_bytes),
+            m_bytes(0),
+            m_num_glyphs(0),
+            m_evictions(0),
+            m_lru_head(0),
+            m_lru_tail(0)
+        {
+            rehash();
+        }
 
 
         //--------------------------------------------------------------------
@@ -161,6 +257,7 @@ namespace agg
             {
                 if(reset_cache)
                 {
+                    remove_glyphs(m_fonts[idx]);
                     obj_allocator<font_cache>::deallocate(m_fonts[idx]);
                     m_fonts[idx] = obj_allocator<font_cache>::allocate();
                     m_fonts[idx]->signature(font_signature);
@@ -169,18 +266,17 @@ namespace agg
             }
             else
             {
+                m_cur_font = 0;
                 if(m_num_fonts >= m_max_fonts)
                 {
-                    obj_allocator<font_cache>::deallocate(m_fonts[0]);
-                    memcpy(m_fonts, 
-                           m_fonts + 1, 
-                           (m_max_fonts - 1) * sizeof(font_cache*));
-                    m_num_fonts = m_max_fonts - 1;
+                    remove_font(m_lru_tail ? m_lru_tail->font : m_fonts[0]);
                 }
                 m_fonts[m_num_fonts] = obj_allocator<font_cache>::allocate();
                 m_fonts[m_num_fonts]->signature(font_signature);
+                m_hashes[m_num_fonts] = calc_hash(font_signature);
                 m_cur_font = m_fonts[m_num_fonts];
                 ++m_num_fonts;
+                rehash();
             }
         }
 
@@ -191,12 +287,32 @@ namespace agg
         }
 
         //--------------------------------------------------------------------
+        unsigned num_fonts() const { return m_num_fonts; }
+        const font_cache* font_by_index(unsigned i) const { return m_fonts[i]; }
+
+        //--------------------------------------------------------------------
+        // Doesn't change the order of the glyphs, see touch().
         const glyph_cache* find_glyph(unsigned glyph_code) const
         {
-            if(m_cur_font) return m_cur_font->find_glyph(glyph_code);
+            if(m_cur_font) 
+            {
+                return m_cur_font->find_glyph(glyph_code);
+            }
             return 0;
         }
 
+        //--------------------------------------------------------------------
+        // Makes the glyph returned by find_glyph() the most recently used one.
+        void touch(const glyph_cache* gl)
+        {
+            font_cache_glyph* glyph = (font_cache_glyph*)gl;
+            if(glyph != m_lru_head)
+            {
+                lru_remove(glyph);
+                lru_add(glyph);
+            }
+        }
+
         //--------------------------------------------------------------------
         glyph_cache* cache_glyph(unsigned        glyph_code, 
                                  unsigned        glyph_index,
@@ -208,34 +324,551 @@ namespace agg
         {
             if(m_cur_font) 
             {
-                return m_cur_font->cache_glyph(glyph_code,
-                                               glyph_index,
-                                               data_size,
-                                               data_type,
-                                               bounds,
-                                               advance_x,
-                                               advance_y);
+                glyph_cache* gl = m_cur_font->cache_glyph(glyph_code,
+                                                          glyph_index,
+                                                          data_size,
+                                                          data_type,
+                                                          bounds,
+                                                          advance_x,
+                                                          advance_y);
+                if(gl)
+                {
+                    font_cache_glyph* glyph = (font_cache_glyph*)gl;
+                    lru_add(glyph);
+                    m_bytes += glyph->byte_size;
+                    ++m_num_glyphs;
+                    if(m_max_bytes) shrink();
+                }
+                return gl;
             }
             return 0;
         }
 
 
         //--------------------------------------------------------------------
-        int find_font(const char* font_signature)
+        int find_font(const char* font_signature) const
+        {
+            unsigned hash = calc_hash(font_signature);
+            unsigned mask = m_hash_table.size() - 1;
+            unsigned i = hash & mask;
+            for(;;)
+            {
+                int idx = m_hash_table[i];
+                if(idx < 0) return -1;
+                if(m_hashes[idx] == hash && 
+                   m_fonts[idx]->font_is(font_signature)) return idx;
+                i = (i + 1) & mask;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Zero means no limit.
+        void     max_bytes(unsigned v) { m_max_bytes = v; if(v) shrink(); }
+        unsigned max_bytes() const     { return m_max_bytes; }
+
+        //--------------------------------------------------------------------
+        // The size of the glyphs with their data, the number of glyphs
+        // and the number of glyphs removed to keep within max_bytes.
+        unsigned bytes()      const { return m_bytes;      }
+        unsigned num_glyphs() const { return m_num_glyphs; }
+        unsigned evictions()  const { return m_evictions;  }
+
+    private:
+        font_cache_pool(const font_cache_pool&);
+        const font_cache_pool& operator = (const font_cache_pool&);
+
+        //--------------------------------------------------------------------
+        static unsigned calc_hash(const char* str)
+        {
+            unsigned hash = 2166136261u;
+            for(; *str; ++str) hash = (hash ^ int8u(*str)) * 16777619u;
+            return hash;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned hash_table_size(unsigned max_fonts)
+        {
+            unsigned size = 4;
+            while(size < max_fonts * 2) size <<= 1;
+            return size;
+        }
+
+        //--------------------------------------------------------------------
+        void rehash()
         {
+            unsigned mask = m_hash_table.size() - 1;
             unsigned i;
+            for(i = 0; i < m_hash_table.size(); i++) m_hash_table[i] = -1;
             for(i = 0; i < m_num_fonts; i++)
             {
-                if(m_fonts[i]->font_is(font_signature)) return int(i);
+                unsigned j = m_hashes[i] & mask;
+                while(m_hash_table[j] >= 0) j = (j + 1) & mask;
+                m_hash_table[j] = int(i);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void lru_add(font_cache_glyph* glyph)
+        {
+            glyph->prev = 0;
+            glyph->next = m_lru_head;
+            if(m_lru_head) m_lru_head->prev = glyph;
+            else           m_lru_tail = glyph;
+            m_lru_head = glyph;
+        }
+
+        //--------------------------------------------------------------------
+        void lru_remove(font_cache_glyph* glyph)
+        {
+            if(glyph->prev) glyph->prev->next = glyph->next;
+            else            m_lru_head = glyph->next;
+            if(glyph->next) glyph->next->prev = glyph->prev;
+            else            m_lru_tail = glyph->prev;
+        }
+
+        //--------------------------------------------------------------------
+        void remove_glyph(font_cache_glyph* glyph)
+        {
+            lru_remove(glyph);
+            m_bytes -= glyph->byte_size;
+            --m_num_glyphs;
+            glyph->font->remove_glyph(glyph->glyph_code);
+        }
+
+        //--------------------------------------------------------------------
+        void remove_glyphs(font_cache* font)
+        {
+            font_cache_glyph* glyph = m_lru_head;
+            while(glyph)
+            {
+                font_cache_glyph* next = glyph->next;
+                if(glyph->font == font) remove_glyph(glyph);
+                glyph = next;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void remove_font(font_cache* font)
+        {
+            remove_glyphs(font);
+            unsigned i;
+            for(i = 0; i < m_num_fonts; i++)
+            {
+                if(m_fonts[i] == font)
+                {
+                    obj_allocator<font_cache>::deallocate(font);
+                    --m_num_fonts;
+                    m_fonts[i]  = m_fonts[m_num_fonts];
+                    m_hashes[i] = m_hashes[m_num_fonts];
+                    break;
+                }
+            }
+            rehash();
+        }
+
+        //--------------------------------------------------------------------
+        // Removes the least recently used glyphs, and the fonts left 
+        // without glyphs, except the current one.
+        void shrink()
+        {
+            while(m_bytes > m_max_bytes && 
+                  m_lru_tail && 
+                  m_lru_tail != m_lru_head &&
+                  m_lru_tail != m_lru_head->next)
+            {
+                font_cache* font = m_lru_tail->font;
+                remove_glyph(m_lru_tail);
+                ++m_evictions;
+                if(font != m_cur_font && font->num_glyphs() == 0)
+                {
+                    remove_font(font);
+                }
+            }
+        }
+
+        font_cache**        m_fonts;
+        unsigned            m_max_fonts;
+        unsigned            m_num_fonts;
+        font_cache*         m_cur_font;
+        pod_array<unsigned> m_hashes;
+        pod_array<int>      m_hash_table;
+        unsigned            m_max_bytes;
+        unsigned            m_bytes;
+        unsigned            m_num_glyphs;
+        unsigned            m_evictions;
+        font_cache_glyph*   m_lru_head;
+        font_cache_glyph*   m_lru_tail;
+    };
+
+
+
+
+    //---------------------------------------------------------font_cache_file
+    // The glyphs of font_cache_pool saved to a file that can be mapped to
+    // memory by the next run of the application, see 
+    // font_cache_manager::cache_file(). The fonts are identified by their
+    // signatures, the glyph data are used right from the mapping. The
+    // numbers are in the native byte order, a file written by a different
+    // platform is rejected by open(). The layout is:
+    //
+    //     header
+    //     font_record  [num_fonts]
+    //     For each font:
+    //         int32u       [num_glyphs]    glyph codes, ascending
+    //         glyph_record [num_glyphs]
+    //     glyph data
+    //     font signatures, zero-terminated
+    //
+    // All the offsets are from the beginning of the file and multiple of 8.
+    //------------------------------------------------------------------------
+    class font_cache_file
+    {
+    public:
+        enum version_e { version = 1 };
+
+        struct header
+        {
+            char   magic[8];
+            int32u version;
+            int32u byte_order;
+            int32u glyph_record_size;
+            int32u num_fonts;
+            int32u file_size;
+            int32u reserved;
+        };
+
+        struct font_record
+        {
+            int32u signature;
+            int32u num_glyphs;
+            int32u codes;
+            int32u glyphs;
+        };
+
+        struct glyph_record
+        {
+            int32u glyph_index;
+            int32u data;
+            int32u data_size;
+            int32u data_type;
+            int32  x1;
+            int32  y1;
+            int32  x2;
+            int32  y2;
+            double advance_x;
+            double advance_y;
+        };
+
+        //--------------------------------------------------------------------
+        font_cache_file() : m_fonts(0), m_num_fonts(0) {}
+
+        //--------------------------------------------------------------------
+        // Maps the file and checks it. Returns false if the file doesn't
+        // exist or it's invalid.
+        bool open(const char* file_name)
+        {
+            close();
+            if(!m_file.open(file_name)) return false;
+            if(!init()) 
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void close()
+        {
+            m_file.close();
+            m_glyphs.resize(0);
+            m_first.resize(0);
+            m_fonts = 0;
+            m_num_fonts = 0;
+        }
+
+        //--------------------------------------------------------------------
+        bool is_open() const { return m_fonts != 0; }
+
+        //--------------------------------------------------------------------
+        unsigned num_fonts() const { return m_num_fonts; }
+
+        //--------------------------------------------------------------------
+        const char* font_signature(unsigned i) const
+        {
+            return (const char*)m_file.data() + m_fonts[i].signature;
+        }
+
+        //--------------------------------------------------------------------
+        int find_font(const char* font_signature) const
+        {
+            unsigned i;
+            for(i = 0; i < m_num_fonts; i++)
+            {
+                if(strcmp(font_signature, this->font_signature(i)) == 0) return int(i);
             }
             return -1;
         }
 
+        //--------------------------------------------------------------------
+        // The glyph codes are taken modulo 65536, like in font_cache.
+        const glyph_cache* find_glyph(int font, unsigned glyph_code) const
+        {
+            const font_record& fr = m_fonts[font];
+            const int32u* codes = (const int32u*)(m_file.data() + fr.codes);
+            glyph_code &= 0xFFFF;
+            unsigned lo = 0;
+            unsigned hi = fr.num_glyphs;
+            while(lo < hi)
+            {
+                unsigned mid = (lo + hi) >> 1;
+                if(codes[mid] < glyph_code) lo = mid + 1;
+                else                        hi = mid;
+            }
+            if(lo < fr.num_glyphs && codes[lo] == glyph_code)
+            {
+                return &m_glyphs[m_first[font] + lo];
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Writes all the fonts of the pool. If "merge" isn't null its
+        // glyphs that aren't in the pool are written too, so that the 
+        // file can be updated while it's in use. The file is written under
+        // a unique temporary name and renamed, see file_replacement.
+        static bool write(const char* file_name, 
+                          const font_cache_pool& pool,
+                          const font_cache_file* merge = 0)
+        {
+            pod_bvector<const char*>        signatures;
+            pod_bvector<unsigned>           num_glyphs;
+            pod_bvector<int32u>             codes;
+            pod_bvector<const glyph_cache*> glyphs;
+
+            unsigned i;
+            for(i = 0; i < pool.num_fonts(); i++)
+            {
+                signatures.add(pool.font_by_index(i)->signature());
+            }
+            if(merge)
+            {
+                for(i = 0; i < merge->num_fonts(); i++)
+                {
+                    if(pool.find_font(merge->font_signature(i)) < 0)
+                    {
+                        signatures.add(merge->font_signature(i));
+                    }
+                }
+            }
+
+            for(i = 0; i < signatures.size(); i++)
+            {
+                int pf = pool.find_font(signatures[i]);
+                int mf = merge ? merge->find_font(signatures[i]) : -1;
+                unsigned n = 0;
+                unsigned code;
+                for(code = 0; code <= 0xFFFF; code++)
+                {
+                    const glyph_cache* gl = 0;
+                    if(pf >= 0) gl = pool.font_by_index(pf)->find_glyph(code);
+                    if(gl == 0 && mf >= 0) gl = merge->find_glyph(mf, code);
+                    if(gl)
+                    {
+                        codes.add(code);
+                        glyphs.add(gl);
+                        ++n;
+                    }
+                }
+                num_glyphs.add(n);
+            }
+
+            file_replacement file;
+            FILE* fd = file.create(file_name);
+            return fd && 
+                   write_data(fd, signatures, num_glyphs, codes, glyphs) &&
+                   file.commit();
+        }
+
     private:
-        font_cache** m_fonts;
-        unsigned     m_max_fonts;
-        unsigned     m_num_fonts;
-        font_cache*  m_cur_font;
+        font_cache_file(const font_cache_file&);
+        const font_cache_file& operator = (const font_cache_file&);
+
+        //--------------------------------------------------------------------
+        static const char* magic() { return "AGGGLYPH"; }
+        static int32u byte_order() { return 0x01020304; }
+        static unsigned align(unsigned v) { return (v + 7) & ~7u; }
+
+        //--------------------------------------------------------------------
+        static bool write_padding(FILE* fd, unsigned size)
+        {
+            static const int8u zeros[8] = { 0 };
+            return size == 0 || fwrite(zeros, 1, align(size) - size, fd) == align(size) - size;
+        }
+
+        //--------------------------------------------------------------------
+        static bool write_data(FILE* fd, 
+                               const pod_bvector<const char*>& signatures,
+                               const pod_bvector<unsigned>& num_glyphs,
+                               const pod_bvector<int32u>& codes,
+                               const pod_bvector<const glyph_cache*>& glyphs)
+        {
+            unsigned i, j;
+            unsigned offset = align(sizeof(header) + 
+                                    signatures.size() * sizeof(font_record));
+            pod_array<font_record> fonts(signatures.size());
+            for(i = 0; i < signatures.size(); i++)
+            {
+                fonts[i].num_glyphs = num_glyphs[i];
+                fonts[i].codes = offset;
+                offset = align(offset + num_glyphs[i] * sizeof(int32u));
+                fonts[i].glyphs = offset;
+                offset += num_glyphs[i] * sizeof(glyph_record);
+            }
+            unsigned data_offset = offset;
+            for(i = 0; i < glyphs.size(); i++)
+            {
+                offset = align(offset + glyphs[i]->data_size);
+            }
+            for(i = 0; i < signatures.size(); i++)
+            {
+                fonts[i].signature = offset;
+                offset += strlen(signatures[i]) + 1;
+            }
+
+            header hdr;
+            memcpy(hdr.magic, magic(), sizeof(hdr.magic));
+            hdr.version           = version;
+            hdr.byte_order        = byte_order();
+            hdr.glyph_record_size = sizeof(glyph_record);
+            hdr.num_fonts         = signatures.size();
+            hdr.file_size         = offset;
+            hdr.reserved          = 0;
+            if(fwrite(&hdr, sizeof(hdr), 1, fd) != 1) return false;
+            if(signatures.size() && 
+               fwrite(&fonts[0], sizeof(font_record), fonts.size(), fd) != fonts.size()) return false;
+            if(!write_padding(fd, sizeof(header) + fonts.size() * sizeof(font_record))) return false;
+
+            unsigned first = 0;
+            offset = data_offset;
+            for(i = 0; i < signatures.size(); i++)
+            {
+                for(j = 0; j < num_glyphs[i]; j++)
+                {
+                    if(fwrite(&codes[first + j], sizeof(int32u), 1, fd) != 1) return false;
+                }
+                if(!write_padding(fd, num_glyphs[i] * sizeof(int32u))) return false;
+                for(j = 0; j < num_glyphs[i]; j++)
+                {
+                    const glyph_cache* gl = glyphs[first + j];
+                    glyph_record gr;
+                    gr.glyph_index = gl->glyph_index;
+                    gr.data        = offset;
+                    gr.data_size   = gl->data_size;
+                    gr.data_type   = gl->data_type;
+                    gr.x1          = gl->bounds.x1;
+                    gr.y1          = gl->bounds.y1;
+                    gr.x2          = gl->bounds.x2;
+                    gr.y2          = gl->bounds.y2;
+                    gr.advance_x   = gl->advance_x;
+                    gr.advance_y   = gl->advance_y;
+                    if(fwrite(&gr, sizeof(gr), 1, fd) != 1) return false;
+                    offset = align(offset + gl->data_size);
+                }
+                first += num_glyphs[i];
+            }
+            for(i = 0; i < glyphs.size(); i++)
+            {
+                unsigned size = glyphs[i]->data_size;
+                if(size && fwrite(glyphs[i]->data, 1, size, fd) != size) return false;
+                if(!write_padding(fd, size)) return false;
+            }
+            for(i = 0; i < signatures.size(); i++)
+            {
+                unsigned len = strlen(signatures[i]) + 1;
+                if(fwrite(signatures[i], 1, len, fd) != len) return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        // Checks the header and the offsets and fills m_glyphs.
+        bool init()
+        {
+            const int8u* data = m_file.data();
+            unsigned size = m_file.size();
+            if(size < sizeof(header)) return false;
+
+            const header& hdr = *(const header*)data;
+            if(memcmp(hdr.magic, magic(), sizeof(hdr.magic)) != 0 ||
+               hdr.version != version ||
+               hdr.byte_order != byte_order() ||
+               hdr.glyph_record_size != sizeof(glyph_record) ||
+               hdr.file_size != size ||
+               hdr.num_fonts > (size - sizeof(header)) / sizeof(font_record))
+            {
+                return false;
+            }
+
+            const font_record* fonts = (const font_record*)(data + sizeof(header));
+            unsigned i, j;
+            unsigned total = 0;
+            for(i = 0; i < hdr.num_fonts; i++)
+            {
+                const font_record& fr = fonts[i];
+                if(fr.signature >= size ||
+                   memchr(data + fr.signature, 0, size - fr.signature) == 0 ||
+                   fr.codes % 8 || fr.glyphs % 8 ||
+                   fr.codes > size || fr.glyphs > size ||
+                   fr.num_glyphs > (size - fr.codes) / sizeof(int32u) ||
+                   fr.num_glyphs > (size - fr.glyphs) / sizeof(glyph_record))
+                {
+                    return false;
+                }
+                const int32u* codes = (const int32u*)(data + fr.codes);
+                for(j = 1; j < fr.num_glyphs; j++)
+                {
+                    if(codes[j] <= codes[j - 1]) return false;
+                }
+                total += fr.num_glyphs;
+            }
+
+            m_glyphs.resize(total);
+            m_first.resize(hdr.num_fonts);
+            total = 0;
+            for(i = 0; i < hdr.num_fonts; i++)
+            {
+                const font_record& fr = fonts[i];
+                const glyph_record* gr = (const glyph_record*)(data + fr.glyphs);
+                m_first[i] = total;
+                for(j = 0; j < fr.num_glyphs; j++)
+                {
+                    if(gr[j].data > size || 
+                       gr[j].data_size > size - gr[j].data ||
+                       gr[j].data_type > glyph_data_outline)
+                    {
+                        return false;
+                    }
+                    glyph_cache& gl = m_glyphs[total++];
+                    gl.glyph_index = gr[j].glyph_index;
+                    gl.data        = (int8u*)data + gr[j].data; // Read-only!
+                    gl.data_size   = gr[j].data_size;
+                    gl.data_type   = glyph_data_type(gr[j].data_type);
+                    gl.bounds      = rect_i(gr[j].x1, gr[j].y1, gr[j].x2, gr[j].y2);
+                    gl.advance_x   = gr[j].advance_x;
+                    gl.advance_y   = gr[j].advance_y;
+                }
+            }
+            m_fonts = fonts;
+            m_num_fonts = hdr.num_fonts;
+            return true;
+        }
+
+        file_mapping           m_file;
+        const font_record*     m_fonts;
+        unsigned               m_num_fonts;
+        pod_array<glyph_cache> m_glyphs;
+        pod_array<unsigned>    m_first;
     };
 
 
@@ -254,6 +887,46 @@ namespace agg
 
 
 
+    //--------------------------------------------------font_cache_prewarm_job
+    // Job i requests the glyphs with engine i, taking the codes one at a
+    // time. The glyphs are rendered in parallel and stored in the pool
+    // under the mutex.
+    //------------------------------------------------------------------------
+    template<class FontEngine> struct font_cache_prewarm_job
+    {
+        font_cache_pool* fonts;
+        FontEngine**     engines;
+        const unsigned*  codes;
+        unsigned         num_codes;
+        volatile int     next;
+        unsigned         num_added;
+        mutex            lock;
+
+        void operator() (unsigned i)
+        {
+            FontEngine& engine = *engines[i];
+            for(;;)
+            {
+                unsigned k = unsigned(atomic_fetch_add(&next, 1));
+                if(k >= num_codes) break;
+                if(!engine.prepare_glyph(codes[k])) continue;
+
+                mutex_lock l(lock);
+                if(fonts->find_glyph(codes[k])) continue;
+                glyph_cache* gl = fonts->cache_glyph(codes[k],
+                                                     engine.glyph_index(),
+                                                     engine.data_size(),
+                                                     engine.data_type(),
+                                                     engine.bounds(),
+                                                     engine.advance_x(),
+                                                     engine.advance_y());
+                engine.write_glyph_to(gl->data);
+                ++num_added;
+            }
+        }
+    };
+
+
     //------------------------------------------------------font_cache_manager
     template<class FontEngine> class font_cache_manager
     {
@@ -267,20 +940,48 @@ namespace agg
         typedef typename mono_adaptor_type::embedded_scanline  mono_scanline_type;
 
         //--------------------------------------------------------------------
-        font_cache_manager(font_engine_type& engine, unsigned max_fonts=32) :
-            m_fonts(max_fonts),
+        font_cache_manager(font_engine_type& engine, 
+                           unsigned max_fonts=32,
+                           unsigned max_bytes=0) :
+            m_fonts(max_fonts, max_bytes),
             m_engine(engine),
             m_change_stamp(-1),
+            m_cache_file(0),
+            m_cache_file_font(-1),
             m_prev_glyph(0),
             m_last_glyph(0)
         {}
 
+        //--------------------------------------------------------------------
+        // The glyphs not found in the memory cache are looked up in the 
+        // file before they are requested from the font engine. The file 
+        // must stay open while the glyphs are in use.
+        void cache_file(const font_cache_file* file)
+        {
+            m_cache_file = file;
+            m_change_stamp = -1;
+            m_prev_glyph = m_last_glyph = 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Writes the glyphs of the memory cache and of the cache file 
+        // to the file.
+        bool write_cache_file(const char* file_name) const
+        {
+            return font_cache_file::write(file_name, m_fonts, m_cache_file);
+        }
+
         //--------------------------------------------------------------------
         void reset_last_glyph()
         {
             m_prev_glyph = m_last_glyph = 0;
         }
 
+        //--------------------------------------------------------------------
+        // The memory cache, for its limits and statistics.
+        font_cache_pool&       fonts()       { return m_fonts; }
+        const font_cache_pool& fonts() const { return m_fonts; }
+
         //--------------------------------------------------------------------
         const glyph_cache* glyph(unsigned glyph_code)
         {
@@ -288,11 +989,21 @@ namespace agg
             const glyph_cache* gl = m_fonts.find_glyph(glyph_code);
             if(gl) 
             {
+                m_fonts.touch(gl);
                 m_prev_glyph = m_last_glyph;
                 return m_last_glyph = gl;
             }
             else
             {
+                if(m_cache_file_font >= 0)
+                {
+                    gl = m_cache_file->find_glyph(m_cache_file_font, glyph_code);
+                    if(gl)
+                    {
+                        m_prev_glyph = m_last_glyph;
+                        return m_last_glyph = gl;
+                    }
+                }
                 if(m_engine.prepare_glyph(glyph_code))
                 {
                     m_prev_glyph = m_last_glyph;
@@ -365,12 +1076,86 @@ namespace agg
             for(; from <= to; ++from) glyph(from);
         }
 
+        //--------------------------------------------------------------------
+        // Requests the glyphs that aren't cached yet in parallel, one
+        // thread per engine. The engines must be set up with the same
+        // font and parameters as the engine of the manager, the ones with
+        // a different font signature are not used. The manager's engine
+        // itself may be one of them. Returns the number of glyphs added.
+        unsigned prewarm(const unsigned* codes, unsigned num_codes,
+                         font_engine_type** engines, unsigned num_engines)
+        {
+            synchronize();
+            m_prev_glyph = m_last_glyph = 0;
+
+            pod_array<font_engine_type*> workers(num_engines + 1);
+            unsigned num_workers = 0;
+            unsigned i;
+            for(i = 0; i < num_engines; i++)
+            {
+                if(strcmp(engines[i]->font_signature(), m_engine.font_signature()) == 0)
+                {
+                    workers[num_workers++] = engines[i];
+                }
+            }
+
+            // Only the missing glyphs go to the workers
+            pod_array<unsigned> missing(num_codes);
+            unsigned num_missing = 0;
+            for(i = 0; i < num_codes; i++)
+            {
+                if(m_fonts.find_glyph(codes[i])) continue;
+                if(m_cache_file_font >= 0 &&
+                   m_cache_file->find_glyph(m_cache_file_font, codes[i])) continue;
+                missing[num_missing++] = codes[i];
+            }
+            if(num_missing == 0) return 0;
+
+            if(num_workers == 0)
+            {
+                workers[0] = &m_engine;
+                num_workers = 1;
+            }
+
+            font_cache_prewarm_job<font_engine_type> job;
+            job.fonts     = &m_fonts;
+            job.engines   = workers.data();
+            job.codes     = missing.data();
+            job.num_codes = num_missing;
+            job.next      = 0;
+            job.num_added = 0;
+            parallel_for(job, num_workers, num_workers);
+            return job.num_added;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned prewarm(unsigned from, unsigned to,
+                         font_engine_type** engines, unsigned num_engines)
+        {
+            if(to < from) return 0;
+            pod_array<unsigned> codes(to - from + 1);
+            unsigned i;
+            for(i = 0; i < codes.size(); i++) codes[i] = from + i;
+            return prewarm(codes.data(), codes.size(), engines, num_engines);
+        }
+
+        //--------------------------------------------------------------------
+        unsigned prewarm(const char* text,
+                         font_engine_type** engines, unsigned num_engines)
+        {
+            pod_array<unsigned> codes(unsigned(strlen(text)));
+            unsigned i;
+            for(i = 0; i < codes.size(); i++) codes[i] = int8u(text[i]);
+            return prewarm(codes.data(), codes.size(), engines, num_engines);
+        }
+
         //--------------------------------------------------------------------
         void reset_cache()
         {
             m_fonts.font(m_engine.font_signature(), true);
             m_change_stamp = m_engine.change_stamp();
             m_prev_glyph = m_last_glyph = 0;
+            find_cache_file_font();
         }
 
     private:
@@ -386,21 +1171,34 @@ namespace agg
                 m_fonts.font(m_engine.font_signature());
                 m_change_stamp = m_engine.change_stamp();
                 m_prev_glyph = m_last_glyph = 0;
+                find_cache_file_font();
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void find_cache_file_font()
+        {
+            m_cache_file_font = -1;
+            if(m_cache_file && m_cache_file->is_open())
+            {
+                m_cache_file_font = m_cache_file->find_font(m_engine.font_signature());
             }
         }
 
-        font_cache_pool     m_fonts;
-        font_engine_type&   m_engine;
-        int                 m_change_stamp;
-        double              m_dx;
-        double              m_dy;
-        const glyph_cache*  m_prev_glyph;
-        const glyph_cache*  m_last_glyph;
-        path_adaptor_type   m_path_adaptor;
-        gray8_adaptor_type  m_gray8_adaptor;
-        gray8_scanline_type m_gray8_scanline;
-        mono_adaptor_type   m_mono_adaptor;
-        mono_scanline_type  m_mono_scanline;
+        font_cache_pool        m_fonts;
+        font_engine_type&      m_engine;
+        int                    m_change_stamp;
+        const font_cache_file* m_cache_file;
+        int                    m_cache_file_font;
+        double                 m_dx;
+        double                 m_dy;
+        const glyph_cache*     m_prev_glyph;
+        const glyph_cache*     m_last_glyph;
+        path_adaptor_type      m_path_adaptor;
+        gray8_adaptor_type     m_gray8_adaptor;
+        gray8_scanline_type    m_gray8_scanline;
+        mono_adaptor_type      m_mono_adaptor;
+        mono_scanline_type     m_mono_scanline;
     };
 
 }
@@ -0,0 +1,424 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// The glyph cache shared by several threads. Every thread has its own
+// font engine and shared_font_cache_manager, which has the interface of
+// font_cache_manager, and all the managers use one shared_font_cache:
+//
+//     agg::shared_font_cache cache;
+//     ...
+//     // In each thread
+//     agg::font_engine_freetype_int32 feng;
+//     agg::shared_font_cache_manager<agg::font_engine_freetype_int32>
+//         fman(feng, cache);
+//
+// Looking up a glyph takes no locks. A missing glyph is rasterized under
+// one of the num_stripes mutexes of its font, chosen by the glyph code,
+// so that the threads adding different glyphs rarely wait for each
+// other and the same glyph is never rasterized twice. The fonts and the
+// glyphs are never removed, the pointers stay valid while the cache
+// exists.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_FONT_CACHE_SHARED_INCLUDED
+#define AGG_FONT_CACHE_SHARED_INCLUDED
+
+#include <string.h>
+#include "agg_array.h"
+#include "agg_threads.h"
+#include "agg_font_cache_manager.h"
+
+namespace agg
+{
+
+    //-------------------------------------------------------shared_font_cache
+    class shared_font_cache
+    {
+    public:
+        enum num_stripes_e { num_stripes = 16 };
+
+        //--------------------------------------------------------------------
+        class font
+        {
+        public:
+            enum block_size_e { block_size = 16384-16 };
+
+            //----------------------------------------------------------------
+            ~font()
+            {
+                unsigned i;
+                for(i = 0; i < 256; i++)
+                {
+                    if(m_glyphs[i])
+                    {
+                        pod_allocator<glyph_cache*>::deallocate((glyph_cache**)m_glyphs[i], 256);
+                    }
+                }
+            }
+
+            //----------------------------------------------------------------
+            font() :
+                m_allocator(block_size),
+                m_signature(0),
+                m_next(0)
+            {
+                memset((void*)m_glyphs, 0, sizeof(m_glyphs));
+            }
+
+            //----------------------------------------------------------------
+            void init(const char* font_signature, font* next)
+            {
+                m_signature = (char*)m_allocator.allocate(strlen(font_signature) + 1);
+                strcpy(m_signature, font_signature);
+                m_next = next;
+            }
+
+            //----------------------------------------------------------------
+            const char* signature() const { return m_signature; }
+            font*       next()      const { return m_next; }
+
+            //----------------------------------------------------------------
+            bool font_is(const char* font_signature) const
+            {
+                return strcmp(font_signature, m_signature) == 0;
+            }
+
+            //----------------------------------------------------------------
+            const glyph_cache* find_glyph(unsigned glyph_code) const
+            {
+                glyph_cache* volatile* row =
+                    atomic_load_ptr(&m_glyphs[(glyph_code >> 8) & 0xFF]);
+                if(row)
+                {
+                    return atomic_load_ptr(&row[glyph_code & 0xFF]);
+                }
+                return 0;
+            }
+
+            //----------------------------------------------------------------
+            // Returns the glyph if another thread has cached it meanwhile,
+            // or rasterizes it with "engine", adds it and sets *added to
+            // true. Returns 0 if the engine can't prepare the glyph.
+            template<class FontEngine>
+            const glyph_cache* cache_glyph(unsigned glyph_code,
+                                           FontEngine& engine,
+                                           bool* added)
+            {
+                *added = false;
+                glyph_cache* volatile* row = find_row(glyph_code);
+                unsigned lsb = glyph_code & 0xFF;
+
+                mutex_lock lock(m_stripes[glyph_code % num_stripes]);
+                glyph_cache* glyph = atomic_load_ptr(&row[lsb]);
+                if(glyph) return glyph;
+                if(!engine.prepare_glyph(glyph_code)) return 0;
+
+                {
+                    mutex_lock alloc_lock(m_allocator_mutex);
+                    glyph = (glyph_cache*)m_allocator.allocate(sizeof(glyph_cache),
+                                                               sizeof(double));
+                    glyph->data = m_allocator.allocate(engine.data_size());
+                }
+                glyph->glyph_index = engine.glyph_index();
+                glyph->data_size   = engine.data_size();
+                glyph->data_type   = engine.data_type();
+                glyph->bounds      = engine.bounds();
+                glyph->advance_x   = engine.advance_x();
+                glyph->advance_y   = engine.advance_y();
+                engine.write_glyph_to(glyph->data);
+
+                atomic_store_ptr(&row[lsb], glyph);
+                *added = true;
+                return glyph;
+            }
+
+        private:
+            font(const font&);
+            const font& operator = (const font&);
+
+            //----------------------------------------------------------------
+            glyph_cache* volatile* find_row(unsigned glyph_code)
+            {
+                unsigned msb = (glyph_code >> 8) & 0xFF;
+                glyph_cache* volatile* row = atomic_load_ptr(&m_glyphs[msb]);
+                if(row == 0)
+                {
+                    glyph_cache** new_row = pod_allocator<glyph_cache*>::allocate(256);
+                    memset(new_row, 0, sizeof(glyph_cache*) * 256);
+                    if(atomic_cas_ptr(&m_glyphs[msb],
+                                      (glyph_cache* volatile*)0,
+                                      (glyph_cache* volatile*)new_row))
+                    {
+                        return new_row;
+                    }
+                    pod_allocator<glyph_cache*>::deallocate(new_row, 256);
+                    row = atomic_load_ptr(&m_glyphs[msb]);
+                }
+                return row;
+            }
+
+            glyph_cache* volatile* volatile m_glyphs[256];
+            block_allocator                 m_allocator;
+            mutex                           m_allocator_mutex;
+            mutex                           m_stripes[num_stripes];
+            char*                           m_signature;
+            font*                           m_next;
+        };
+
+
+        //--------------------------------------------------------------------
+        ~shared_font_cache()
+        {
+            font* f = m_fonts;
+            while(f)
+            {
+                font* next = f->next();
+                obj_allocator<font>::deallocate(f);
+                f = next;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        shared_font_cache() : m_fonts(0), m_hits(0), m_misses(0) {}
+
+        //--------------------------------------------------------------------
+        // Finds the font or adds a new one. Only adding takes a lock.
+        font* find_font(const char* font_signature)
+        {
+            font* f = find_font(atomic_load_ptr(&m_fonts), font_signature);
+            if(f) return f;
+
+            mutex_lock lock(m_fonts_mutex);
+            f = find_font(m_fonts, font_signature);
+            if(f == 0)
+            {
+                f = obj_allocator<font>::allocate();
+                f->init(font_signature, m_fonts);
+                atomic_store_ptr(&m_fonts, f);
+            }
+            return f;
+        }
+
+        //--------------------------------------------------------------------
+        // The managers add the number of hits in portions, see
+        // shared_font_cache_manager::flush_hits(), so that the threads
+        // don't compete for the counter.
+        void add_hits(unsigned n)   { atomic_fetch_add(&m_hits, int(n));   }
+        void add_misses(unsigned n) { atomic_fetch_add(&m_misses, int(n)); }
+
+        unsigned hits()   const { return unsigned(m_hits);   }
+        unsigned misses() const { return unsigned(m_misses); }
+
+    private:
+        shared_font_cache(const shared_font_cache&);
+        const shared_font_cache& operator = (const shared_font_cache&);
+
+        //--------------------------------------------------------------------
+        static font* find_font(font* f, const char* font_signature)
+        {
+            for(; f; f = f->next())
+            {
+                if(f->font_is(font_signature)) return f;
+            }
+            return 0;
+        }
+
+        font* volatile m_fonts;
+        mutex          m_fonts_mutex;
+        volatile int   m_hits;
+        volatile int   m_misses;
+    };
+
+
+
+
+    //-----------------------------------------------shared_font_cache_manager
+    // The same as font_cache_manager, but the glyphs are kept in the
+    // shared_font_cache. The manager and the font engine belong to one
+    // thread.
+    //------------------------------------------------------------------------
+    template<class FontEngine> class shared_font_cache_manager
+    {
+    public:
+        typedef FontEngine font_engine_type;
+        typedef shared_font_cache_manager<FontEngine> self_type;
+        typedef typename font_engine_type::path_adaptor_type   path_adaptor_type;
+        typedef typename font_engine_type::gray8_adaptor_type  gray8_adaptor_type;
+        typedef typename gray8_adaptor_type::embedded_scanline gray8_scanline_type;
+        typedef typename font_engine_type::mono_adaptor_type   mono_adaptor_type;
+        typedef typename mono_adaptor_type::embedded_scanline  mono_scanline_type;
+
+        enum flush_hits_e { flush_hits_num = 256 };
+
+        //--------------------------------------------------------------------
+        ~shared_font_cache_manager()
+        {
+            flush_hits();
+        }
+
+        //--------------------------------------------------------------------
+        shared_font_cache_manager(font_engine_type& engine,
+                                  shared_font_cache& cache) :
+            m_cache(cache),
+            m_engine(engine),
+            m_change_stamp(-1),
+            m_font(0),
+            m_prev_glyph(0),
+            m_last_glyph(0),
+            m_hits(0),
+            m_misses(0),
+            m_unflushed_hits(0)
+        {}
+
+        //--------------------------------------------------------------------
+        void reset_last_glyph()
+        {
+            m_prev_glyph = m_last_glyph = 0;
+        }
+
+        //--------------------------------------------------------------------
+        const glyph_cache* glyph(unsigned glyph_code)
+        {
+            synchronize();
+            const glyph_cache* gl = m_font->find_glyph(glyph_code);
+            bool added = false;
+            if(gl == 0)
+            {
+                gl = m_font->cache_glyph(glyph_code, m_engine, &added);
+                if(gl == 0) return 0;
+            }
+            if(added)
+            {
+                ++m_misses;
+                m_cache.add_misses(1);
+            }
+            else
+            {
+                ++m_hits;
+                if(++m_unflushed_hits >= unsigned(flush_hits_num)) flush_hits();
+            }
+            m_prev_glyph = m_last_glyph;
+            return m_last_glyph = gl;
+        }
+
+        //--------------------------------------------------------------------
+        void init_embedded_adaptors(const glyph_cache* gl,
+                                    double x, double y,
+                                    double scale=1.0)
+        {
+            if(gl)
+            {
+                switch(gl->data_type)
+                {
+                default: return;
+                case glyph_data_mono:
+                    m_mono_adaptor.init(gl->data, gl->data_size, x, y);
+                    break;
+
+                case glyph_data_gray8:
+                    m_gray8_adaptor.init(gl->data, gl->data_size, x, y);
+                    break;
+
+                case glyph_data_outline:
+                    m_path_adaptor.init(gl->data, gl->data_size, x, y, scale);
+                    break;
+                }
+            }
+        }
+
+
+        //--------------------------------------------------------------------
+        path_adaptor_type&   path_adaptor()   { return m_path_adaptor;   }
+        gray8_adaptor_type&  gray8_adaptor()  { return m_gray8_adaptor;  }
+        gray8_scanline_type& gray8_scanline() { return m_gray8_scanline; }
+        mono_adaptor_type&   mono_adaptor()   { return m_mono_adaptor;   }
+        mono_scanline_type&  mono_scanline()  { return m_mono_scanline;  }
+
+        //--------------------------------------------------------------------
+        const glyph_cache* perv_glyph() const { return m_prev_glyph; }
+        const glyph_cache* last_glyph() const { return m_last_glyph; }
+
+        //--------------------------------------------------------------------
+        bool add_kerning(double* x, double* y)
+        {
+            if(m_prev_glyph && m_last_glyph)
+            {
+                return m_engine.add_kerning(m_prev_glyph->glyph_index,
+                                            m_last_glyph->glyph_index,
+                                            x, y);
+            }
+            return false;
+        }
+
+        //--------------------------------------------------------------------
+        void precache(unsigned from, unsigned to)
+        {
+            for(; from <= to; ++from) glyph(from);
+        }
+
+        //--------------------------------------------------------------------
+        // The hits and misses of this manager. A miss is a glyph
+        // rasterized by its engine.
+        unsigned hits()   const { return m_hits;   }
+        unsigned misses() const { return m_misses; }
+
+        //--------------------------------------------------------------------
+        // Adds the hits to the counter of the cache. It's done every
+        // flush_hits_num hits and by the destructor.
+        void flush_hits()
+        {
+            if(m_unflushed_hits)
+            {
+                m_cache.add_hits(m_unflushed_hits);
+                m_unflushed_hits = 0;
+            }
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        shared_font_cache_manager(const self_type&);
+        const self_type& operator = (const self_type&);
+
+        //--------------------------------------------------------------------
+        void synchronize()
+        {
+            if(m_change_stamp != m_engine.change_stamp())
+            {
+                m_font = m_cache.find_font(m_engine.font_signature());
+                m_change_stamp = m_engine.change_stamp();
+                m_prev_glyph = m_last_glyph = 0;
+            }
+        }
+
+        shared_font_cache&       m_cache;
+        font_engine_type&        m_engine;
+        int                      m_change_stamp;
+        shared_font_cache::font* m_font;
+        const glyph_cache*       m_prev_glyph;
+        const glyph_cache*       m_last_glyph;
+        unsigned                 m_hits;
+        unsigned                 m_misses;
+        unsigned                 m_unflushed_hits;
+        path_adaptor_type        m_path_adaptor;
+        gray8_adaptor_type       m_gray8_adaptor;
+        gray8_scanline_type      m_gray8_scanline;
+        mono_adaptor_type        m_mono_adaptor;
+        mono_scanline_type       m_mono_scanline;
+    };
+
+}
+
+#endif
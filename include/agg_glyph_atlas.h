@@ -0,0 +1,523 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Glyph atlas: the gray8 and mono glyphs of font_cache_manager unpacked
+// to one gray8 buffer, and the renderer that blits the glyphs from it
+// as rows of covers with blend_solid_hspan() instead of rendering the
+// serialized scanlines of each glyph. The glyphs are placed at integer
+// positions, like by the embedded adaptors, so the result is the same.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_GLYPH_ATLAS_INCLUDED
+#define AGG_GLYPH_ATLAS_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_color_rgba.h"
+#include "agg_rendering_buffer.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_scanline_storage_bin.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_renderer_scanline.h"
+#include "agg_font_cache_manager.h"
+
+namespace agg
+{
+
+    //=============================================================glyph_atlas
+    // The glyphs are found by the font signature and the glyph code. When
+    // there's no room for a glyph the atlas has to be cleared with
+    // remove_all(). The glyphs are packed into shelves, the rows of the
+    // height of the tallest glyph in them.
+    //------------------------------------------------------------------------
+    class glyph_atlas
+    {
+    public:
+        //--------------------------------------------------------------------
+        struct glyph
+        {
+            int      x;      // Position in the atlas
+            int      y;
+            int      width;
+            int      height;
+            int      dx;     // Position relative to the pen
+            int      dy;
+            double   advance_x;
+            double   advance_y;
+        };
+
+        //--------------------------------------------------------------------
+        ~glyph_atlas()
+        {
+            remove_fonts();
+        }
+
+        //--------------------------------------------------------------------
+        glyph_atlas(unsigned width = 1024, unsigned height = 1024) :
+            m_buf(width * height),
+            m_rbuf(&m_buf[0], width, height, width),
+            m_cur_font(0)
+        {
+            remove_all();
+        }
+
+        //--------------------------------------------------------------------
+        unsigned width()  const { return m_rbuf.width();  }
+        unsigned height() const { return m_rbuf.height(); }
+        const rendering_buffer& rbuf() const { return m_rbuf; }
+
+        //--------------------------------------------------------------------
+        // Removes all the glyphs, the previously returned pointers
+        // become invalid, including the ones in the pending batches of
+        // all the renderer_glyph_atlas objects that use the atlas.
+        void remove_all()
+        {
+            remove_fonts();
+            m_shelves.remove_all();
+            m_bottom = 0;
+            m_cur_font = 0;
+        }
+
+        //--------------------------------------------------------------------
+        void font(const char* font_signature)
+        {
+            if(m_cur_font && strcmp(m_cur_font->signature, font_signature) == 0) return;
+            unsigned i;
+            for(i = 0; i < m_fonts.size(); i++)
+            {
+                if(strcmp(m_fonts[i]->signature, font_signature) == 0)
+                {
+                    m_cur_font = m_fonts[i];
+                    return;
+                }
+            }
+            m_cur_font = obj_allocator<font_glyphs>::allocate();
+            m_cur_font->signature = pod_allocator<char>::allocate(strlen(font_signature) + 1);
+            strcpy(m_cur_font->signature, font_signature);
+            memset(m_cur_font->glyphs, 0, sizeof(m_cur_font->glyphs));
+            m_fonts.add(m_cur_font);
+        }
+
+        //--------------------------------------------------------------------
+        const glyph* find_glyph(unsigned glyph_code) const
+        {
+            if(m_cur_font)
+            {
+                const glyph_entry* row = m_cur_font->glyphs[(glyph_code >> 8) & 0xFF];
+                if(row && row[glyph_code & 0xFF].used) return &row[glyph_code & 0xFF].gl;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // Unpacks the gray8 or mono glyph to the atlas. Returns 0 if it's
+        // an outline or there's no room.
+        const glyph* add_glyph(unsigned glyph_code, const glyph_cache& gl)
+        {
+            if(m_cur_font == 0) return 0;
+            if(gl.data_type != glyph_data_gray8 &&
+               gl.data_type != glyph_data_mono) return 0;
+
+            int x1 = 0;
+            int y1 = 0;
+            int x2 = -1;
+            int y2 = -1;
+            serialized_scanlines_adaptor_aa8 aa;
+            serialized_scanlines_adaptor_bin bin;
+            if(gl.data_type == glyph_data_gray8)
+            {
+                aa.init(gl.data, gl.data_size, 0, 0);
+                if(aa.rewind_scanlines())
+                {
+                    x1 = aa.min_x(); y1 = aa.min_y();
+                    x2 = aa.max_x(); y2 = aa.max_y();
+                }
+            }
+            else
+            {
+                bin.init(gl.data, gl.data_size, 0, 0);
+                if(bin.rewind_scanlines())
+                {
+                    x1 = bin.min_x(); y1 = bin.min_y();
+                    x2 = bin.max_x(); y2 = bin.max_y();
+                }
+            }
+
+            // Empty glyphs, like spaces, take no room
+            if(x2 < x1 || y2 < y1)
+            {
+                x1 = y1 = 0;
+                x2 = y2 = -1;
+            }
+            int x = 0;
+            int y = 0;
+            if(x2 >= x1 && !allocate(x2 - x1 + 1, y2 - y1 + 1, &x, &y)) return 0;
+
+            glyph_entry* row = find_row(glyph_code);
+            glyph_entry& entry = row[glyph_code & 0xFF];
+            entry.used         = true;
+            entry.gl.x         = x;
+            entry.gl.y         = y;
+            entry.gl.width     = x2 - x1 + 1;
+            entry.gl.height    = y2 - y1 + 1;
+            entry.gl.dx        = x1;
+            entry.gl.dy        = y1;
+            entry.gl.advance_x = gl.advance_x;
+            entry.gl.advance_y = gl.advance_y;
+
+            unsigned i;
+            for(i = 0; i < unsigned(entry.gl.height); i++)
+            {
+                memset(m_rbuf.row_ptr(y + i) + x, 0, entry.gl.width);
+            }
+            if(gl.data_type == glyph_data_gray8)
+            {
+                serialized_scanlines_adaptor_aa8::embedded_scanline sl;
+                while(aa.sweep_scanline(sl))
+                {
+                    int8u* p = m_rbuf.row_ptr(y + sl.y() - y1) + x - x1;
+                    serialized_scanlines_adaptor_aa8::embedded_scanline::const_iterator
+                        span = sl.begin();
+                    unsigned num_spans = sl.num_spans();
+                    for(;;)
+                    {
+                        if(span->len < 0) memset(p + span->x, *span->covers, -span->len);
+                        else              memcpy(p + span->x, span->covers, span->len);
+                        if(--num_spans == 0) break;
+                        ++span;
+                    }
+                }
+            }
+            else
+            {
+                serialized_scanlines_adaptor_bin::embedded_scanline sl;
+                while(bin.sweep_scanline(sl))
+                {
+                    int8u* p = m_rbuf.row_ptr(y + sl.y() - y1) + x - x1;
+                    serialized_scanlines_adaptor_bin::embedded_scanline::const_iterator
+                        span = sl.begin();
+                    unsigned num_spans = sl.num_spans();
+                    for(;;)
+                    {
+                        memset(p + span->x, cover_full, span->len);
+                        if(--num_spans == 0) break;
+                        ++span;
+                    }
+                }
+            }
+            return &entry.gl;
+        }
+
+    private:
+        glyph_atlas(const glyph_atlas&);
+        const glyph_atlas& operator = (const glyph_atlas&);
+
+        //--------------------------------------------------------------------
+        struct glyph_entry
+        {
+            glyph gl;
+            bool  used;
+        };
+
+        struct font_glyphs
+        {
+            char*        signature;
+            glyph_entry* glyphs[256];
+        };
+
+        struct shelf
+        {
+            int y;
+            int height;
+            int x;
+        };
+
+        //--------------------------------------------------------------------
+        void remove_fonts()
+        {
+            unsigned i, j;
+            for(i = 0; i < m_fonts.size(); i++)
+            {
+                font_glyphs* f = m_fonts[i];
+                for(j = 0; j < 256; j++)
+                {
+                    pod_allocator<glyph_entry>::deallocate(f->glyphs[j], 256);
+                }
+                pod_allocator<char>::deallocate(f->signature, strlen(f->signature) + 1);
+                obj_allocator<font_glyphs>::deallocate(f);
+            }
+            m_fonts.remove_all();
+        }
+
+        //--------------------------------------------------------------------
+        glyph_entry* find_row(unsigned glyph_code)
+        {
+            glyph_entry*& row = m_cur_font->glyphs[(glyph_code >> 8) & 0xFF];
+            if(row == 0)
+            {
+                row = pod_allocator<glyph_entry>::allocate(256);
+                memset(row, 0, sizeof(glyph_entry) * 256);
+            }
+            return row;
+        }
+
+        //--------------------------------------------------------------------
+        // Finds the shelf of the closest height with enough room, or
+        // starts a new one if the waste is too big.
+        bool allocate(int w, int h, int* x, int* y)
+        {
+            if(w > int(width())) return false;
+            int best = -1;
+            unsigned i;
+            for(i = 0; i < m_shelves.size(); i++)
+            {
+                const shelf& s = m_shelves[i];
+                if(s.height >= h && s.x + w <= int(width()))
+                {
+                    if(best < 0 || s.height < m_shelves[best].height) best = int(i);
+                }
+            }
+            if(best < 0 || m_shelves[best].height > h + h / 2)
+            {
+                if(m_bottom + h <= int(height()))
+                {
+                    shelf s;
+                    s.y = m_bottom;
+                    s.height = h;
+                    s.x = 0;
+                    m_shelves.add(s);
+                    m_bottom += h;
+                    best = int(m_shelves.size() - 1);
+                }
+            }
+            if(best < 0) return false;
+            shelf& s = m_shelves[best];
+            *x = s.x;
+            *y = s.y;
+            s.x += w;
+            return true;
+        }
+
+        pod_array<int8u>          m_buf;
+        rendering_buffer          m_rbuf;
+        pod_bvector<font_glyphs*> m_fonts;
+        font_glyphs*              m_cur_font;
+        pod_bvector<shelf>        m_shelves;
+        int                       m_bottom;
+    };
+
+
+
+    //====================================================renderer_glyph_atlas
+    // Renders text from the glyph atlas. The glyphs are collected by
+    // add_glyph() or add_text() and blitted together by render(), or
+    // when the batch is full. The glyphs that can't be put into the
+    // atlas (outlines, or when it's full even after remove_all()) are
+    // rendered with the embedded adaptors of the font cache manager.
+    // The pending glyphs are also blitted by the destructor.
+    //
+    // The renderer clears the atlas itself when it's full, as does
+    // glyph_atlas::remove_all(), which invalidates the pending batches
+    // of the other renderers sharing the atlas. Those must call render()
+    // before another renderer can add glyphs, or before remove_all().
+    //------------------------------------------------------------------------
+    template<class BaseRenderer> class renderer_glyph_atlas
+    {
+    public:
+        typedef BaseRenderer base_ren_type;
+        typedef typename base_ren_type::color_type color_type;
+
+        enum max_batch_e { max_batch = 256 };
+
+        //--------------------------------------------------------------------
+        ~renderer_glyph_atlas() { render(); }
+
+        renderer_glyph_atlas(base_ren_type& ren, glyph_atlas& atlas) :
+            m_ren(&ren),
+            m_atlas(&atlas),
+            m_color(rgba(0, 0, 0)),
+            m_num_glyphs(0)
+        {}
+
+        //--------------------------------------------------------------------
+        void color(const color_type& c) { render(); m_color = c; }
+        const color_type& color() const { return m_color; }
+
+        //--------------------------------------------------------------------
+        // Adds the atlas glyph with the pen at x, y (rounded).
+        void add_glyph(const glyph_atlas::glyph* gl, double x, double y)
+        {
+            if(m_num_glyphs >= unsigned(max_batch)) render();
+            batch_item& item = m_batch[m_num_glyphs++];
+            item.gl = gl;
+            item.x  = iround(x) + gl->dx;
+            item.y  = iround(y) + gl->dy;
+        }
+
+        //--------------------------------------------------------------------
+        // Adds the glyphs of the text with the current font of the cache
+        // manager, starting at *x, *y, and moves the pen.
+        template<class FontCacheManager>
+        void add_text(FontCacheManager& fman, const char* text,
+                      double* x, double* y, bool kerning = true)
+        {
+            for(; *text; ++text)
+            {
+                unsigned code = int8u(*text);
+                const glyph_cache* gl = fman.glyph(code);
+                if(gl == 0) continue;
+                if(kerning) fman.add_kerning(x, y);
+
+                const glyph_atlas::glyph* agl = find_or_add(fman, code, *gl);
+                if(agl)
+                {
+                    add_glyph(agl, *x, *y);
+                }
+                else
+                {
+                    render_glyph(fman, *gl, *x, *y);
+                }
+                *x += gl->advance_x;
+                *y += gl->advance_y;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Blits the collected glyphs.
+        void render()
+        {
+            const rendering_buffer& rbuf = m_atlas->rbuf();
+            rect_i clip = m_ren->clip_box();
+            unsigned i;
+            for(i = 0; i < m_num_glyphs; i++)
+            {
+                const batch_item& item = m_batch[i];
+                const glyph_atlas::glyph& gl = *item.gl;
+                int y1 = item.y;
+                int y2 = item.y + gl.height - 1;
+                if(y1 < clip.y1) y1 = clip.y1;
+                if(y2 > clip.y2) y2 = clip.y2;
+                if(item.x > clip.x2 || item.x + gl.width - 1 < clip.x1) continue;
+                int y;
+                for(y = y1; y <= y2; y++)
+                {
+                    // The empty pixels at the ends of the row are skipped
+                    const int8u* covers = rbuf.row_ptr(gl.y + y - item.y) + gl.x;
+                    int x1 = 0;
+                    int x2 = gl.width - 1;
+                    while(x1 <= x2 && covers[x1] == 0) ++x1;
+                    while(x2 >  x1 && covers[x2] == 0) --x2;
+                    if(x1 <= x2)
+                    {
+                        m_ren->blend_solid_hspan(item.x + x1, y, x2 - x1 + 1,
+                                                 m_color, covers + x1);
+                    }
+                }
+            }
+            m_num_glyphs = 0;
+        }
+
+    private:
+        renderer_glyph_atlas(const renderer_glyph_atlas<BaseRenderer>&);
+        const renderer_glyph_atlas<BaseRenderer>& 
+            operator = (const renderer_glyph_atlas<BaseRenderer>&);
+
+        //--------------------------------------------------------------------
+        struct batch_item
+        {
+            const glyph_atlas::glyph* gl;
+            int x;
+            int y;
+        };
+
+        //--------------------------------------------------------------------
+        template<class FontCacheManager>
+        const glyph_atlas::glyph* find_or_add(FontCacheManager& fman,
+                                              unsigned code,
+                                              const glyph_cache& gl)
+        {
+            if(gl.data_type == glyph_data_outline) return 0;
+            const font_cache* font = fman.fonts().font();
+            if(font == 0) return 0;
+            m_atlas->font(font->signature());
+            const glyph_atlas::glyph* agl = m_atlas->find_glyph(code);
+            if(agl == 0)
+            {
+                agl = m_atlas->add_glyph(code, gl);
+                if(agl == 0)
+                {
+                    // No room, the pending glyphs are blitted before
+                    // the atlas is cleared.
+                    render();
+                    m_atlas->remove_all();
+                    m_atlas->font(font->signature());
+                    agl = m_atlas->add_glyph(code, gl);
+                }
+            }
+            return agl;
+        }
+
+        //--------------------------------------------------------------------
+        template<class FontCacheManager>
+        void render_glyph(FontCacheManager& fman, const glyph_cache& gl,
+                          double x, double y)
+        {
+            render();
+            fman.init_embedded_adaptors(&gl, x, y);
+            switch(gl.data_type)
+            {
+            default: break;
+            case glyph_data_mono:
+                {
+                    renderer_scanline_bin_solid<base_ren_type> ren(*m_ren);
+                    ren.color(m_color);
+                    render_scanlines(fman.mono_adaptor(), fman.mono_scanline(), ren);
+                }
+                break;
+
+            case glyph_data_gray8:
+                {
+                    renderer_scanline_aa_solid<base_ren_type> ren(*m_ren);
+                    ren.color(m_color);
+                    render_scanlines(fman.gray8_adaptor(), fman.gray8_scanline(), ren);
+                }
+                break;
+
+            case glyph_data_outline:
+                {
+                    rasterizer_scanline_aa<> ras;
+                    scanline_u8 sl;
+                    renderer_scanline_aa_solid<base_ren_type> ren(*m_ren);
+                    ren.color(m_color);
+                    ras.add_path(fman.path_adaptor());
+                    render_scanlines(ras, sl, ren);
+                }
+                break;
+            }
+        }
+
+        base_ren_type* m_ren;
+        glyph_atlas*   m_atlas;
+        color_type     m_color;
+        batch_item     m_batch[max_batch];
+        unsigned       m_num_glyphs;
+    };
+
+}
+
+#endif
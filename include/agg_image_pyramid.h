@@ -0,0 +1,388 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Image pyramid (mipmaps) for heavy downscaling. The cost of
+// span_image_resample_* grows with the square of the scale factor,
+// while the cost of sampling a pyramid is constant: the level that
+// has about the right resolution is sampled with the bilinear filter,
+// optionally blending two adjacent levels (trilinear filtering).
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_IMAGE_PYRAMID_INCLUDED
+#define AGG_IMAGE_PYRAMID_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_rendering_buffer.h"
+#include "agg_span_image_filter.h"
+
+namespace agg
+{
+
+    //--------------------------------------------------image_pyramid_filter_e
+    enum image_pyramid_filter_e
+    {
+        image_pyramid_box,      // 2x2 average
+        image_pyramid_gaussian  // 4x4 binomial, (1 3 3 1)/8 in both directions
+    };
+
+    //===========================================================image_pyramid
+    // The levels of the image, each one half the size of the previous one,
+    // down to 1x1. Level 0 is the source image itself, it's not copied, so
+    // it must stay alive while the pyramid is used. The other levels are
+    // calculated by build() and kept in one buffer.
+    //
+    // All the components of the pixels are averaged the same way, so it
+    // works with any pixel format whose pixels are arrays of value_type,
+    // that is, rgba, rgb and gray ones. The averaging is correct for the
+    // premultiplied colors, for the plain ones the semitransparent edges
+    // get somewhat darker, as with any other filter in AGG.
+    //------------------------------------------------------------------------
+    template<class PixFmt> class image_pyramid
+    {
+    public:
+        typedef PixFmt pixfmt_type;
+        typedef typename pixfmt_type::color_type color_type;
+        typedef typename color_type::value_type value_type;
+        typedef typename color_type::calc_type calc_type;
+
+        enum max_levels_e { max_levels = 32 };
+        enum pix_width_e
+        {
+            pix_width      = pixfmt_type::pix_width,
+            num_components = pix_width / sizeof(value_type)
+        };
+
+        //--------------------------------------------------------------------
+        image_pyramid() : m_num_levels(0) {}
+        image_pyramid(rendering_buffer& src,
+                      image_pyramid_filter_e filter = image_pyramid_box) :
+            m_num_levels(0)
+        {
+            build(src, filter);
+        }
+
+        //--------------------------------------------------------------------
+        void build(rendering_buffer& src,
+                   image_pyramid_filter_e filter = image_pyramid_box)
+        {
+            m_levels[0].attach(src.buf(), src.width(), src.height(), src.stride());
+            m_num_levels = 1;
+
+            unsigned w = src.width();
+            unsigned h = src.height();
+            unsigned size = 0;
+            while((w > 1 || h > 1) && m_num_levels < max_levels)
+            {
+                w = (w + 1) >> 1;
+                h = (h + 1) >> 1;
+                size += w * h * pix_width;
+                ++m_num_levels;
+            }
+            m_buf.resize(size);
+
+            int8u* buf = m_buf.data();
+            unsigned i;
+            for(i = 1; i < m_num_levels; i++)
+            {
+                const rendering_buffer& s = m_levels[i - 1];
+                w = (s.width()  + 1) >> 1;
+                h = (s.height() + 1) >> 1;
+                m_levels[i].attach(buf, w, h, w * pix_width);
+                buf += w * h * pix_width;
+                if(filter == image_pyramid_gaussian) downsample_gaussian(s, m_levels[i]);
+                else                                 downsample_box(s, m_levels[i]);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        unsigned num_levels() const { return m_num_levels; }
+        const rendering_buffer& level(unsigned i) const { return m_levels[i]; }
+
+        const value_type* pix_ptr(unsigned i, int x, int y) const
+        {
+            return (const value_type*)(m_levels[i].row_ptr(y) + x * pix_width);
+        }
+
+    private:
+        image_pyramid(const image_pyramid<PixFmt>&);
+        const image_pyramid<PixFmt>& operator = (const image_pyramid<PixFmt>&);
+
+        //--------------------------------------------------------------------
+        static void downsample_box(const rendering_buffer& src,
+                                   rendering_buffer& dst)
+        {
+            unsigned maxx = src.width()  - 1;
+            unsigned maxy = src.height() - 1;
+            unsigned x, y, i;
+            for(y = 0; y < dst.height(); y++)
+            {
+                unsigned y0 = y * 2;
+                unsigned y1 = (y0 < maxy) ? y0 + 1 : maxy;
+                const value_type* s0 = (const value_type*)src.row_ptr(y0);
+                const value_type* s1 = (const value_type*)src.row_ptr(y1);
+                value_type* d = (value_type*)dst.row_ptr(y);
+                for(x = 0; x < dst.width(); x++)
+                {
+                    unsigned x0 = x * 2 * num_components;
+                    unsigned x1 = (x * 2 < maxx) ? x0 + num_components : x0;
+                    for(i = 0; i < num_components; i++)
+                    {
+                        *d++ = value_type((calc_type(s0[x0 + i]) + s0[x1 + i] +
+                                           s1[x0 + i] + s1[x1 + i] + 2) >> 2);
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Taps 2x-1, 2x, 2x+1, 2x+2 with the weights 1, 3, 3, 1, the ones
+        // outside the image are replaced with the nearest edge pixels.
+        // Separable, the horizontal pass goes to m_rows, which keeps the 
+        // last 4 rows of the source, so that each row is filtered once.
+        void downsample_gaussian(const rendering_buffer& src,
+                                 rendering_buffer& dst)
+        {
+            int maxx = src.width()  - 1;
+            int maxy = src.height() - 1;
+            unsigned row_len = dst.width() * num_components;
+            m_rows.resize(row_len * 4);
+            m_offsets.resize(dst.width() * 4);
+
+            unsigned x, y, i, k;
+            for(x = 0; x < dst.width(); x++)
+            {
+                for(k = 0; k < 4; k++)
+                {
+                    int sx = int(x * 2 + k) - 1;
+                    if(sx < 0)    sx = 0;
+                    if(sx > maxx) sx = maxx;
+                    m_offsets[x * 4 + k] = sx * num_components;
+                }
+            }
+
+            int last_row = -2;
+            for(y = 0; y < dst.height(); y++)
+            {
+                int sy = int(y * 2) - 1;
+                for(k = 0; k < 4; k++, sy++)
+                {
+                    if(sy <= last_row) continue;
+                    calc_type* r = &m_rows[row_len * (sy & 3)];
+                    const value_type* s = 
+                        (const value_type*)src.row_ptr(sy < 0 ? 0 : (sy > maxy ? maxy : sy));
+                    const int* offs = &m_offsets[0];
+                    for(x = 0; x < dst.width(); x++, offs += 4)
+                    {
+                        for(i = 0; i < num_components; i++)
+                        {
+                            *r++ = s[offs[0] + i] + (s[offs[1] + i] + 
+                                                     s[offs[2] + i]) * 3 + 
+                                   s[offs[3] + i];
+                        }
+                    }
+                    last_row = sy;
+                }
+
+                sy = int(y * 2) - 1;
+                const calc_type* r0 = &m_rows[row_len * ((sy + 0) & 3)];
+                const calc_type* r1 = &m_rows[row_len * ((sy + 1) & 3)];
+                const calc_type* r2 = &m_rows[row_len * ((sy + 2) & 3)];
+                const calc_type* r3 = &m_rows[row_len * ((sy + 3) & 3)];
+                value_type* d = (value_type*)dst.row_ptr(y);
+                for(i = 0; i < row_len; i++)
+                {
+                    d[i] = value_type((r0[i] + (r1[i] + r2[i]) * 3 + r3[i] + 32) >> 6);
+                }
+            }
+        }
+
+        rendering_buffer     m_levels[max_levels];
+        unsigned             m_num_levels;
+        pod_array<int8u>     m_buf;
+        pod_array<calc_type> m_rows;
+        pod_array<int>       m_offsets;
+    };
+
+
+
+    //=================================================span_image_pyramid_rgba
+    // Samples an image_pyramid of an rgba pixel format. The level is chosen
+    // by the local scale of the interpolator (the larger of the two),
+    // level n has the scale 2^n. The level is sampled with the bilinear
+    // filter, the pixels outside the image are the nearest edge pixels,
+    // as with image_accessor_clone. With trilinear(true) the scales between
+    // 2^n and 2^(n+1) blend the levels n and n+1 linearly.
+    //
+    // The Interpolator must have local_scale(), as span_interpolator_linear
+    // and span_interpolator_persp_* do. The affine interpolators report a
+    // constant scale, the perspective ones the scale at the current pixel,
+    // so the level changes along the span.
+    //------------------------------------------------------------------------
+    template<class Pyramid, class Interpolator>
+    class span_image_pyramid_rgba :
+    public span_image_filter<Pyramid, Interpolator>
+    {
+    public:
+        typedef Pyramid pyramid_type;
+        typedef typename pyramid_type::color_type color_type;
+        typedef typename pyramid_type::pixfmt_type::order_type order_type;
+        typedef Interpolator interpolator_type;
+        typedef span_image_filter<pyramid_type, interpolator_type> base_type;
+        typedef typename color_type::value_type value_type;
+        typedef typename color_type::calc_type calc_type;
+
+        //--------------------------------------------------------------------
+        span_image_pyramid_rgba() : m_trilinear(true) {}
+        span_image_pyramid_rgba(pyramid_type& pyramid,
+                                interpolator_type& inter,
+                                bool trilinear = true) :
+            base_type(pyramid, inter, 0),
+            m_trilinear(trilinear)
+        {}
+
+        //--------------------------------------------------------------------
+        bool trilinear() const { return m_trilinear; }
+        void trilinear(bool v) { m_trilinear = v; }
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            base_type::interpolator().begin(x + base_type::filter_dx_dbl(),
+                                            y + base_type::filter_dy_dbl(), len);
+
+            unsigned num_levels = base_type::source().num_levels();
+            calc_type fg[4];
+            calc_type fg1[4];
+
+            do
+            {
+                int x_hr;
+                int y_hr;
+                int sx;
+                int sy;
+
+                base_type::interpolator().coordinates(&x_hr, &y_hr);
+                base_type::interpolator().local_scale(&sx, &sy);
+                if(sx < sy) sx = sy;
+
+                unsigned level = 0;
+                while(level + 1 < num_levels &&
+                      sx >= (image_subpixel_scale << (level + 1))) ++level;
+
+                sample(level, x_hr, y_hr, fg);
+
+                int t = (sx >> level) - image_subpixel_scale;
+                if(m_trilinear && level + 1 < num_levels && t > 0)
+                {
+                    sample(level + 1, x_hr, y_hr, fg1);
+                    fg[0] = (fg[0] * (image_subpixel_scale - t) + fg1[0] * t +
+                             image_subpixel_scale / 2) >> image_subpixel_shift;
+                    fg[1] = (fg[1] * (image_subpixel_scale - t) + fg1[1] * t +
+                             image_subpixel_scale / 2) >> image_subpixel_shift;
+                    fg[2] = (fg[2] * (image_subpixel_scale - t) + fg1[2] * t +
+                             image_subpixel_scale / 2) >> image_subpixel_shift;
+                    fg[3] = (fg[3] * (image_subpixel_scale - t) + fg1[3] * t +
+                             image_subpixel_scale / 2) >> image_subpixel_shift;
+                }
+
+                span->r = value_type(fg[order_type::R]);
+                span->g = value_type(fg[order_type::G]);
+                span->b = value_type(fg[order_type::B]);
+                span->a = value_type(fg[order_type::A]);
+                ++span;
+                ++base_type::interpolator();
+
+            } while(--len);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        // Bilinear sampling of the level; x_hr, y_hr are the coordinates
+        // in level 0.
+        void sample(unsigned level, int x_hr, int y_hr, calc_type* fg)
+        {
+            const pyramid_type& pyr = base_type::source();
+            int maxx = pyr.level(level).width()  - 1;
+            int maxy = pyr.level(level).height() - 1;
+
+            x_hr = (x_hr >> level) - base_type::filter_dx_int();
+            y_hr = (y_hr >> level) - base_type::filter_dy_int();
+
+            int x0 = x_hr >> image_subpixel_shift;
+            int y0 = y_hr >> image_subpixel_shift;
+            int x1 = x0 + 1;
+            int y1 = y0 + 1;
+            x_hr &= image_subpixel_mask;
+            y_hr &= image_subpixel_mask;
+
+            if(x0 < 0)    x0 = 0;
+            if(x0 > maxx) x0 = maxx;
+            if(x1 < 0)    x1 = 0;
+            if(x1 > maxx) x1 = maxx;
+            if(y0 < 0)    y0 = 0;
+            if(y0 > maxy) y0 = maxy;
+            if(y1 < 0)    y1 = 0;
+            if(y1 > maxy) y1 = maxy;
+
+            fg[0] =
+            fg[1] =
+            fg[2] =
+            fg[3] = image_subpixel_scale * image_subpixel_scale / 2;
+
+            const value_type* p;
+            unsigned weight;
+
+            p = pyr.pix_ptr(level, x0, y0);
+            weight = (image_subpixel_scale - x_hr) * (image_subpixel_scale - y_hr);
+            fg[0] += weight * p[0];
+            fg[1] += weight * p[1];
+            fg[2] += weight * p[2];
+            fg[3] += weight * p[3];
+
+            p = pyr.pix_ptr(level, x1, y0);
+            weight = x_hr * (image_subpixel_scale - y_hr);
+            fg[0] += weight * p[0];
+            fg[1] += weight * p[1];
+            fg[2] += weight * p[2];
+            fg[3] += weight * p[3];
+
+            p = pyr.pix_ptr(level, x0, y1);
+            weight = (image_subpixel_scale - x_hr) * y_hr;
+            fg[0] += weight * p[0];
+            fg[1] += weight * p[1];
+            fg[2] += weight * p[2];
+            fg[3] += weight * p[3];
+
+            p = pyr.pix_ptr(level, x1, y1);
+            weight = x_hr * y_hr;
+            fg[0] += weight * p[0];
+            fg[1] += weight * p[1];
+            fg[2] += weight * p[2];
+            fg[3] += weight * p[3];
+
+            fg[0] >>= image_subpixel_shift * 2;
+            fg[1] >>= image_subpixel_shift * 2;
+            fg[2] >>= image_subpixel_shift * 2;
+            fg[3] >>= image_subpixel_shift * 2;
+        }
+
+        bool m_trilinear;
+    };
+
+}
+
+#endif
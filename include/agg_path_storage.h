@@ -66,6 +66,8 @@ namespace agg
 
         unsigned total_vertices() const;
         unsigned vertex(unsigned idx, double* x, double* y) const;
+        unsigned vertices(unsigned idx, double* x, double* y, unsigned* cmd, 
+                          unsigned max) const;
         unsigned command(unsigned idx) const;
 
     private:
@@ -287,6 +289,40 @@ namespace agg
         return m_cmd_blocks[nb][idx & block_mask];
     }
 
+    //------------------------------------------------------------------------
+    // Copies up to max vertices starting from idx, block by block. 
+    // Returns the number of vertices copied.
+    template<class T, unsigned S, unsigned P>
+    unsigned vertex_block_storage<T,S,P>::vertices(unsigned idx, 
+                                                   double* x, double* y, 
+                                                   unsigned* cmd, 
+                                                   unsigned max) const
+    {
+        if(idx >= m_total_vertices) return 0;
+        unsigned n = m_total_vertices - idx;
+        if(n > max) n = max;
+        unsigned i = 0;
+        while(i < n)
+        {
+            unsigned nb  = (idx + i) >> block_shift;
+            unsigned pos = (idx + i) & block_mask;
+            unsigned len = block_size - pos;
+            if(len > n - i) len = n - i;
+            const T*     pv = m_coord_blocks[nb] + (pos << 1);
+            const int8u* pc = m_cmd_blocks[nb] + pos;
+            do
+            {
+                x[i]   = pv[0];
+                y[i]   = pv[1];
+                cmd[i] = *pc++;
+                pv += 2;
+                ++i;
+            }
+            while(--len);
+        }
+        return n;
+    }
+
     //------------------------------------------------------------------------
     template<class T, unsigned S, unsigned P>
     inline unsigned vertex_block_storage<T,S,P>::command(unsigned idx) const
@@ -699,6 +735,9 @@ namespace agg
         void     rewind(unsigned path_id);
         unsigned vertex(double* x, double* y);
 
+        // Reads a block of vertices, see vertex_block()
+        unsigned vertices(double* x, double* y, unsigned* cmd, unsigned max);
+
         // Arrange the orientation of a polygon, all polygons in a path, 
         // or in all paths. After calling arrange_orientations() or 
         // arrange_orientations_all_paths(), all the polygons will have 
@@ -1210,6 +1249,36 @@ namespace agg
         return m_vertices.vertex(m_iterator++, x, y);
     }
 
+    //------------------------------------------------------------------------
+    template<class VC> 
+    unsigned path_base<VC>::vertices(double* x, double* y, unsigned* cmd, 
+                                     unsigned max)
+    {
+        if(max == 0) return 0;
+        unsigned n = m_vertices.vertices(m_iterator, x, y, cmd, max);
+        unsigned i;
+        for(i = 0; i < n; i++)
+        {
+            if(is_stop(cmd[i])) 
+            {
+                m_iterator += i + 1;
+                return i + 1;
+            }
+        }
+        m_iterator += n;
+        if(n < max) cmd[n++] = path_cmd_stop;
+        return n;
+    }
+
+    //------------------------------------------------------------------------
+    template<class VC> 
+    inline unsigned vertex_block(path_base<VC>& vs, 
+                                 double* x, double* y, unsigned* cmd, 
+                                 unsigned max)
+    {
+        return vs.vertices(x, y, cmd, max);
+    }
+
     //------------------------------------------------------------------------
     template<class VC> 
     unsigned path_base<VC>::perceive_polygon_orientation(unsigned start,
@@ -1511,6 +1580,20 @@ namespace agg
             return v.cmd;
         }
 
+        unsigned vertices(unsigned idx, double* x, double* y, unsigned* cmd, 
+                          unsigned max) const
+        {
+            unsigned n = 0;
+            for(; n < max && idx < m_vertices.size(); ++n, ++idx)
+            {
+                const vertex_type& v = m_vertices[idx];
+                x[n]   = v.x;
+                y[n]   = v.y;
+                cmd[n] = v.cmd;
+            }
+            return n;
+        }
+
         unsigned command(unsigned idx) const
         {
             return m_vertices[idx].cmd;
@@ -1520,6 +1603,33 @@ namespace agg
         Container m_vertices;
     };
 
+    //-------------------------------------------------------------path_reader
+    // Read-only vertex source on top of path_base. It has its own iterator,
+    // so that any number of readers can walk the same path at a time,
+    // for example, from different threads. path_base::rewind()/vertex() 
+    // modify the path's iterator and therefore can't be used that way.
+    //------------------------------------------------------------------------
+    template<class Path> class path_reader
+    {
+    public:
+        typedef Path path_type;
+
+        explicit path_reader(const path_type& path) : 
+            m_path(&path), m_iterator(0) {}
+        void attach(const path_type& path) { m_path = &path; m_iterator = 0; }
+
+        void rewind(unsigned path_id) { m_iterator = path_id; }
+        unsigned vertex(double* x, double* y)
+        {
+            if(m_iterator >= m_path->total_vertices()) return path_cmd_stop;
+            return m_path->vertex(m_iterator++, x, y);
+        }
+
+    private:
+        const path_type* m_path;
+        unsigned         m_iterator;
+    };
+
     //-----------------------------------------------------------path_storage
     typedef path_base<vertex_block_storage<double> > path_storage;
 
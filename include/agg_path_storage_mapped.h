@@ -0,0 +1,390 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Read-only path storage used right from a memory mapped file, so that
+// the processes rendering the same data share the pages.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_PATH_STORAGE_MAPPED_INCLUDED
+#define AGG_PATH_STORAGE_MAPPED_INCLUDED
+
+#include <stdio.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_path_storage.h"
+#include "agg_file_mapping.h"
+
+namespace agg
+{
+
+    //=====================================================path_storage_mapped
+    // A vertex source on a file written by write(). The paths are
+    // numbered from 0 to num_paths()-1 and rewind(path_id) finds the path
+    // at once. The numbers are in the native byte order, a file written
+    // by a different platform or with a different coordinate type is
+    // rejected by open(). The layout is:
+    //
+    //     header
+    //     int32u     [num_paths + 1]   the first vertex of every path and
+    //                                  num_vertices at the end
+    //     value_type [num_vertices]    x
+    //     value_type [num_vertices]    y
+    //     int8u      [num_vertices]    commands
+    //
+    // Every array is padded with zeros to a multiple of 8 bytes. The
+    // offsets and sizes are 32-bit, so the file is limited to 4GB, about
+    // 470M vertices with float and 250M with double, write() fails
+    // beyond that, see max_vertices().
+    // The paths contain no path_cmd_stop, vertex() returns it at the end
+    // of the path.
+    //------------------------------------------------------------------------
+    template<class T> class path_storage_mapped
+    {
+    public:
+        typedef T value_type;
+        enum version_e { version = 1 };
+
+        struct header
+        {
+            char   magic[8];
+            int32u version;
+            int32u byte_order;
+            int32u coord_size;
+            int32u num_paths;
+            int32u num_vertices;
+            int32u file_size;
+        };
+
+        //--------------------------------------------------------------------
+        path_storage_mapped() :
+            m_paths(0),
+            m_x(0),
+            m_y(0),
+            m_cmd(0),
+            m_num_paths(0),
+            m_num_vertices(0),
+            m_iterator(0),
+            m_end(0)
+        {}
+
+        //--------------------------------------------------------------------
+        // Maps the file and checks it. Returns false if the file doesn't
+        // exist or it's invalid.
+        bool open(const char* file_name)
+        {
+            close();
+            if(!m_file.open(file_name)) return false;
+            if(!init())
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        void close()
+        {
+            m_file.close();
+            m_paths = 0;
+            m_x = m_y = 0;
+            m_cmd = 0;
+            m_num_paths = 0;
+            m_num_vertices = 0;
+            m_iterator = m_end = 0;
+        }
+
+        //--------------------------------------------------------------------
+        bool is_open() const { return m_paths != 0; }
+
+        //--------------------------------------------------------------------
+        unsigned num_paths()      const { return m_num_paths; }
+        unsigned total_vertices() const { return m_num_vertices; }
+
+        // The index of the first vertex of the path, num_paths() gives
+        // total_vertices().
+        unsigned path_start(unsigned path_id) const { return m_paths[path_id]; }
+
+        //--------------------------------------------------------------------
+        unsigned vertex(unsigned idx, double* x, double* y) const
+        {
+            *x = m_x[idx];
+            *y = m_y[idx];
+            return m_cmd[idx];
+        }
+
+        unsigned command(unsigned idx) const { return m_cmd[idx]; }
+
+        //--------------------------------------------------------------------
+        // Vertex Source Interface
+        void rewind(unsigned path_id)
+        {
+            if(path_id < m_num_paths)
+            {
+                m_iterator = m_paths[path_id];
+                m_end      = m_paths[path_id + 1];
+            }
+            else
+            {
+                m_iterator = m_end = 0;
+            }
+        }
+
+        unsigned vertex(double* x, double* y)
+        {
+            if(m_iterator >= m_end)
+            {
+                *x = *y = 0.0;
+                return path_cmd_stop;
+            }
+            *x = m_x[m_iterator];
+            *y = m_y[m_iterator];
+            return m_cmd[m_iterator++];
+        }
+
+        //--------------------------------------------------------------------
+        // Reads a block of vertices, see vertex_block()
+        unsigned vertices(double* x, double* y, unsigned* cmd, unsigned max)
+        {
+            if(max == 0) return 0;
+            unsigned n = m_end - m_iterator;
+            if(n > max) n = max;
+            const value_type* px = m_x + m_iterator;
+            const value_type* py = m_y + m_iterator;
+            const int8u*      pc = m_cmd + m_iterator;
+            unsigned i;
+            for(i = 0; i < n; i++)
+            {
+                x[i]   = px[i];
+                y[i]   = py[i];
+                cmd[i] = pc[i];
+            }
+            m_iterator += n;
+            if(n < max)
+            {
+                x[n] = y[n] = 0.0;
+                cmd[n++] = path_cmd_stop;
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        // The greatest number of vertices of a file with num_paths paths,
+        // 0 if even the path offsets don't fit.
+        static unsigned max_vertices(unsigned num_paths)
+        {
+            // In double, as the sizes may not fit in 32 bits
+            double avail = 4294967295.0 - 
+                           align(sizeof(header)) -
+                           ((num_paths + 1.0) * sizeof(int32u) + 7.0) -
+                           3 * 7.0;
+            if(avail <= 0.0) return 0;
+            return unsigned(avail / (2 * sizeof(value_type) + 1));
+        }
+
+        //--------------------------------------------------------------------
+        // Writes the paths of a vertex source given by their ids, the i-th
+        // of them becomes the path i of the file. Returns false if the file
+        // can't be written or the paths don't fit, see max_vertices().
+        // The file is written under a temporary name and renamed, see 
+        // file_replacement, so it can be rewritten while it's open. The 
+        // opened ones keep the old paths until they're opened again.
+        template<class VertexSource>
+        static bool write(const char* file_name, VertexSource& vs,
+                          const unsigned* path_ids, unsigned num_paths)
+        {
+            unsigned max_num_vertices = max_vertices(num_paths);
+            if(max_num_vertices == 0) return false;
+
+            pod_bvector<int32u, 12>     starts;
+            pod_bvector<value_type, 12> xs;
+            pod_bvector<value_type, 12> ys;
+            pod_bvector<int8u, 12>      cmds;
+            unsigned i;
+            for(i = 0; i < num_paths; i++)
+            {
+                starts.add(cmds.size());
+                vs.rewind(path_ids[i]);
+                double x, y;
+                unsigned cmd;
+                while(!is_stop(cmd = vs.vertex(&x, &y)))
+                {
+                    if(cmds.size() >= max_num_vertices) return false;
+                    xs.add(value_type(x));
+                    ys.add(value_type(y));
+                    cmds.add(int8u(cmd));
+                }
+            }
+            starts.add(cmds.size());
+
+            header hdr;
+            memcpy(hdr.magic, magic(), sizeof(hdr.magic));
+            hdr.version      = version;
+            hdr.byte_order   = byte_order();
+            hdr.coord_size   = sizeof(value_type);
+            hdr.num_paths    = num_paths;
+            hdr.num_vertices = cmds.size();
+            hdr.file_size    = file_size(num_paths, cmds.size());
+
+            file_replacement file;
+            FILE* fd = file.create(file_name);
+            return fd &&
+                   fwrite(&hdr, sizeof(hdr), 1, fd) == 1 &&
+                   write_padding(fd, sizeof(hdr)) &&
+                   write_array(fd, starts) &&
+                   write_array(fd, xs) &&
+                   write_array(fd, ys) &&
+                   write_array(fd, cmds) &&
+                   file.commit();
+        }
+
+        //--------------------------------------------------------------------
+        // Writes all the paths of path_storage, which are separated by
+        // path_cmd_stop, see path_base::start_new_path().
+        template<class VC>
+        static bool write(const char* file_name, path_base<VC>& ps)
+        {
+            pod_bvector<unsigned, 12> path_ids;
+            unsigned total = ps.total_vertices();
+            unsigned i;
+            for(i = 0; i < total; i++)
+            {
+                if(i == 0 || is_stop(ps.command(i - 1)))
+                {
+                    if(!is_stop(ps.command(i))) path_ids.add(i);
+                }
+            }
+            pod_array<unsigned> ids(path_ids.size());
+            for(i = 0; i < path_ids.size(); i++) ids[i] = path_ids[i];
+            return write(file_name, ps, ids.data(), ids.size());
+        }
+
+    private:
+        path_storage_mapped(const path_storage_mapped<T>&);
+        const path_storage_mapped<T>& operator = (const path_storage_mapped<T>&);
+
+        //--------------------------------------------------------------------
+        static const char* magic() { return "AGGPATHS"; }
+        static int32u byte_order() { return 0x01020304; }
+        static unsigned align(unsigned v) { return (v + 7) & ~7u; }
+
+        static unsigned x_offset(unsigned num_paths)
+        {
+            return align(sizeof(header)) + align((num_paths + 1) * sizeof(int32u));
+        }
+
+        static unsigned y_offset(unsigned num_paths, unsigned num_vertices)
+        {
+            return x_offset(num_paths) + align(num_vertices * sizeof(value_type));
+        }
+
+        static unsigned cmd_offset(unsigned num_paths, unsigned num_vertices)
+        {
+            return y_offset(num_paths, num_vertices) + align(num_vertices * sizeof(value_type));
+        }
+
+        static unsigned file_size(unsigned num_paths, unsigned num_vertices)
+        {
+            return cmd_offset(num_paths, num_vertices) + align(num_vertices);
+        }
+
+        //--------------------------------------------------------------------
+        static bool write_padding(FILE* fd, unsigned size)
+        {
+            static const int8u zeros[8] = { 0 };
+            return size == align(size) ||
+                   fwrite(zeros, 1, align(size) - size, fd) == align(size) - size;
+        }
+
+        template<class V, unsigned S>
+        static bool write_array(FILE* fd, const pod_bvector<V, S>& v)
+        {
+            unsigned i;
+            for(i = 0; i < v.size(); i += pod_bvector<V, S>::block_size)
+            {
+                unsigned n = v.size() - i;
+                if(n > unsigned(pod_bvector<V, S>::block_size)) n = pod_bvector<V, S>::block_size;
+                if(fwrite(&v[i], sizeof(V), n, fd) != n) return false;
+            }
+            return write_padding(fd, v.size() * sizeof(V));
+        }
+
+        //--------------------------------------------------------------------
+        // Checks the header and the path offsets.
+        bool init()
+        {
+            const int8u* data = m_file.data();
+            unsigned size = m_file.size();
+            if(size < sizeof(header)) return false;
+
+            const header& hdr = *(const header*)data;
+            if(memcmp(hdr.magic, magic(), sizeof(hdr.magic)) != 0 ||
+               hdr.version != version ||
+               hdr.byte_order != byte_order() ||
+               hdr.coord_size != sizeof(value_type) ||
+               hdr.file_size != size ||
+               hdr.num_paths >= size / sizeof(int32u) ||
+               hdr.num_vertices > size / (2 * sizeof(value_type) + 1) ||
+               file_size(hdr.num_paths, hdr.num_vertices) != size)
+            {
+                return false;
+            }
+
+            const int32u* paths = (const int32u*)(data + align(sizeof(header)));
+            unsigned i;
+            for(i = 0; i < hdr.num_paths; i++)
+            {
+                if(paths[i] > paths[i + 1]) return false;
+            }
+            if(paths[0] != 0 || paths[hdr.num_paths] != hdr.num_vertices) return false;
+
+            m_paths        = paths;
+            m_x            = (const value_type*)(data + x_offset(hdr.num_paths));
+            m_y            = (const value_type*)(data + y_offset(hdr.num_paths, hdr.num_vertices));
+            m_cmd          = data + cmd_offset(hdr.num_paths, hdr.num_vertices);
+            m_num_paths    = hdr.num_paths;
+            m_num_vertices = hdr.num_vertices;
+            m_iterator = m_end = 0;
+            return true;
+        }
+
+        file_mapping      m_file;
+        const int32u*     m_paths;
+        const value_type* m_x;
+        const value_type* m_y;
+        const int8u*      m_cmd;
+        unsigned          m_num_paths;
+        unsigned          m_num_vertices;
+        unsigned          m_iterator;
+        unsigned          m_end;
+    };
+
+    //------------------------------------------------------------------------
+    template<class T>
+    inline unsigned vertex_block(path_storage_mapped<T>& vs,
+                                 double* x, double* y, unsigned* cmd,
+                                 unsigned max)
+    {
+        return vs.vertices(x, y, cmd, max);
+    }
+
+    typedef path_storage_mapped<float>  path_storage_mapped32; //----path_storage_mapped32
+    typedef path_storage_mapped<double> path_storage_mapped64; //----path_storage_mapped64
+
+}
+
+#endif
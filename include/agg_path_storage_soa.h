@@ -0,0 +1,358 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Compact vertex container for path_base: float or fixed point int32
+// coordinates, stored as separate arrays of x, y and commands in blocks.
+// A vertex takes 9 bytes instead of 17 in path_storage.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_PATH_STORAGE_SOA_INCLUDED
+#define AGG_PATH_STORAGE_SOA_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_path_storage.h"
+
+namespace agg
+{
+
+    //------------------------------------------------------vertex_coord_float
+    struct vertex_coord_float
+    {
+        typedef float value_type;
+        static value_type to_value(double v)   { return value_type(v); }
+        static double from_value(value_type v) { return v; }
+    };
+
+    //------------------------------------------------------vertex_coord_int32
+    // Fixed point with Shift bits of fraction, like path_storage_integer.
+    // The default one keeps 1/64 of a unit within +/-33 million.
+    template<unsigned Shift=6> struct vertex_coord_int32
+    {
+        typedef int32 value_type;
+        enum coord_scale_e
+        {
+            coord_shift = Shift,
+            coord_scale = 1 << coord_shift
+        };
+        static value_type to_value(double v)   { return value_type(iround(v * coord_scale)); }
+        static double from_value(value_type v) { return double(v) / coord_scale; }
+    };
+
+
+    //======================================================vertex_soa_storage
+    // Every block keeps block_size x values, then y values, then commands.
+    //------------------------------------------------------------------------
+    template<class Coord=vertex_coord_float,
+             unsigned BlockShift=12,
+             unsigned BlockPool=256>
+    class vertex_soa_storage
+    {
+    public:
+        enum block_scale_e
+        {
+            block_shift = BlockShift,
+            block_size  = 1 << block_shift,
+            block_mask  = block_size - 1,
+            block_pool  = BlockPool
+        };
+
+        typedef Coord coord_type;
+        typedef typename coord_type::value_type value_type;
+        typedef vertex_soa_storage<Coord, BlockShift, BlockPool> self_type;
+
+        //--------------------------------------------------------------------
+        ~vertex_soa_storage() { free_all(); }
+
+        vertex_soa_storage() :
+            m_total_vertices(0),
+            m_total_blocks(0),
+            m_max_blocks(0),
+            m_blocks(0)
+        {}
+
+        vertex_soa_storage(const self_type& v) :
+            m_total_vertices(0),
+            m_total_blocks(0),
+            m_max_blocks(0),
+            m_blocks(0)
+        {
+            *this = v;
+        }
+
+        const self_type& operator = (const self_type& v)
+        {
+            if(&v != this)
+            {
+                remove_all();
+                unsigned nb;
+                for(nb = 0; nb < v.m_total_blocks; nb++)
+                {
+                    if(nb >= m_total_blocks) allocate_block(nb);
+                    memcpy(m_blocks[nb], v.m_blocks[nb], block_bytes);
+                }
+                m_total_vertices = v.m_total_vertices;
+            }
+            return *this;
+        }
+
+        //--------------------------------------------------------------------
+        void remove_all() { m_total_vertices = 0; }
+
+        void free_all()
+        {
+            unsigned nb;
+            for(nb = 0; nb < m_total_blocks; nb++)
+            {
+                pod_allocator<int8u>::deallocate(m_blocks[nb], block_bytes);
+            }
+            pod_allocator<int8u*>::deallocate(m_blocks, m_max_blocks);
+            m_total_vertices = 0;
+            m_total_blocks   = 0;
+            m_max_blocks     = 0;
+            m_blocks         = 0;
+        }
+
+        //--------------------------------------------------------------------
+        void add_vertex(double x, double y, unsigned cmd)
+        {
+            unsigned nb = m_total_vertices >> block_shift;
+            if(nb >= m_total_blocks) allocate_block(nb);
+            unsigned i = m_total_vertices & block_mask;
+            xs(nb)[i]   = coord_type::to_value(x);
+            ys(nb)[i]   = coord_type::to_value(y);
+            cmds(nb)[i] = int8u(cmd);
+            ++m_total_vertices;
+        }
+
+        //--------------------------------------------------------------------
+        // Appends n vertices with the same command given by the arrays
+        // of coordinates of any numeric type.
+        template<class V>
+        void add_vertices(const V* x, const V* y, unsigned n, unsigned cmd)
+        {
+            while(n)
+            {
+                unsigned nb = m_total_vertices >> block_shift;
+                if(nb >= m_total_blocks) allocate_block(nb);
+                unsigned i   = m_total_vertices & block_mask;
+                unsigned len = block_size - i;
+                if(len > n) len = n;
+                value_type* px = xs(nb) + i;
+                value_type* py = ys(nb) + i;
+                unsigned j;
+                for(j = 0; j < len; j++)
+                {
+                    px[j] = coord_type::to_value(double(x[j]));
+                    py[j] = coord_type::to_value(double(y[j]));
+                }
+                memset(cmds(nb) + i, int8u(cmd), len);
+                m_total_vertices += len;
+                x += len;
+                y += len;
+                n -= len;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void modify_vertex(unsigned idx, double x, double y)
+        {
+            unsigned nb = idx >> block_shift;
+            xs(nb)[idx & block_mask] = coord_type::to_value(x);
+            ys(nb)[idx & block_mask] = coord_type::to_value(y);
+        }
+
+        void modify_vertex(unsigned idx, double x, double y, unsigned cmd)
+        {
+            modify_vertex(idx, x, y);
+            modify_command(idx, cmd);
+        }
+
+        void modify_command(unsigned idx, unsigned cmd)
+        {
+            cmds(idx >> block_shift)[idx & block_mask] = int8u(cmd);
+        }
+
+        void swap_vertices(unsigned v1, unsigned v2)
+        {
+            double x1, y1, x2, y2;
+            unsigned cmd1 = vertex(v1, &x1, &y1);
+            unsigned cmd2 = vertex(v2, &x2, &y2);
+            modify_vertex(v1, x2, y2, cmd2);
+            modify_vertex(v2, x1, y1, cmd1);
+        }
+
+        //--------------------------------------------------------------------
+        unsigned last_command() const
+        {
+            return m_total_vertices ? command(m_total_vertices - 1) : path_cmd_stop;
+        }
+
+        unsigned last_vertex(double* x, double* y) const
+        {
+            if(m_total_vertices == 0)
+            {
+                *x = *y = 0.0;
+                return path_cmd_stop;
+            }
+            return vertex(m_total_vertices - 1, x, y);
+        }
+
+        unsigned prev_vertex(double* x, double* y) const
+        {
+            if(m_total_vertices < 2)
+            {
+                *x = *y = 0.0;
+                return path_cmd_stop;
+            }
+            return vertex(m_total_vertices - 2, x, y);
+        }
+
+        double last_x() const
+        {
+            if(m_total_vertices == 0) return 0.0;
+            unsigned idx = m_total_vertices - 1;
+            return coord_type::from_value(xs(idx >> block_shift)[idx & block_mask]);
+        }
+
+        double last_y() const
+        {
+            if(m_total_vertices == 0) return 0.0;
+            unsigned idx = m_total_vertices - 1;
+            return coord_type::from_value(ys(idx >> block_shift)[idx & block_mask]);
+        }
+
+        //--------------------------------------------------------------------
+        unsigned total_vertices() const { return m_total_vertices; }
+
+        unsigned vertex(unsigned idx, double* x, double* y) const
+        {
+            unsigned nb = idx >> block_shift;
+            unsigned i  = idx & block_mask;
+            *x = coord_type::from_value(xs(nb)[i]);
+            *y = coord_type::from_value(ys(nb)[i]);
+            return cmds(nb)[i];
+        }
+
+        unsigned command(unsigned idx) const
+        {
+            return cmds(idx >> block_shift)[idx & block_mask];
+        }
+
+        //--------------------------------------------------------------------
+        // Copies up to max vertices starting from idx, see vertex_block().
+        unsigned vertices(unsigned idx, double* x, double* y, unsigned* cmd,
+                          unsigned max) const
+        {
+            if(idx >= m_total_vertices) return 0;
+            unsigned n = m_total_vertices - idx;
+            if(n > max) n = max;
+            unsigned k = 0;
+            while(k < n)
+            {
+                unsigned nb  = (idx + k) >> block_shift;
+                unsigned i   = (idx + k) & block_mask;
+                unsigned len = block_size - i;
+                if(len > n - k) len = n - k;
+                const value_type* px = xs(nb) + i;
+                const value_type* py = ys(nb) + i;
+                const int8u*      pc = cmds(nb) + i;
+                unsigned j;
+                for(j = 0; j < len; j++)
+                {
+                    x[k + j]   = coord_type::from_value(px[j]);
+                    y[k + j]   = coord_type::from_value(py[j]);
+                    cmd[k + j] = pc[j];
+                }
+                k += len;
+            }
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        // The memory taken by the vertices, including the reserved blocks.
+        unsigned byte_size() const
+        {
+            return m_total_blocks * block_bytes + m_max_blocks * sizeof(int8u*);
+        }
+
+    private:
+        enum block_bytes_e
+        {
+            block_bytes = block_size * (2 * sizeof(value_type) + 1)
+        };
+
+        //--------------------------------------------------------------------
+        value_type* xs(unsigned nb) const { return (value_type*)m_blocks[nb]; }
+        value_type* ys(unsigned nb) const { return xs(nb) + block_size; }
+        int8u*      cmds(unsigned nb) const { return (int8u*)(xs(nb) + block_size * 2); }
+
+        //--------------------------------------------------------------------
+        void allocate_block(unsigned nb)
+        {
+            if(nb >= m_max_blocks)
+            {
+                int8u** new_blocks = pod_allocator<int8u*>::allocate(m_max_blocks + block_pool);
+                if(m_blocks)
+                {
+                    memcpy(new_blocks, m_blocks, m_max_blocks * sizeof(int8u*));
+                    pod_allocator<int8u*>::deallocate(m_blocks, m_max_blocks);
+                }
+                m_blocks = new_blocks;
+                m_max_blocks += block_pool;
+            }
+            m_blocks[nb] = pod_allocator<int8u>::allocate(block_bytes);
+            m_total_blocks++;
+        }
+
+        unsigned m_total_vertices;
+        unsigned m_total_blocks;
+        unsigned m_max_blocks;
+        int8u**  m_blocks;
+    };
+
+
+    //-----------------------------------------------------path_storage_float
+    typedef path_base<vertex_soa_storage<vertex_coord_float> >   path_storage_float;
+
+    //-----------------------------------------------------path_storage_int32
+    typedef path_base<vertex_soa_storage<vertex_coord_int32<> > > path_storage_int32;
+
+
+    //===============================================================copy_path
+    // Replaces the vertices of dst with the ones of src, all the paths,
+    // for example, to convert path_storage to path_storage_float and back.
+    //------------------------------------------------------------------------
+    template<class DstContainer, class SrcContainer>
+    void copy_path(path_base<DstContainer>& dst, const path_base<SrcContainer>& src)
+    {
+        dst.remove_all();
+        double   x[256];
+        double   y[256];
+        unsigned cmd[256];
+        unsigned idx = 0;
+        unsigned n;
+        while((n = src.vertices().vertices(idx, x, y, cmd, 256)) != 0)
+        {
+            unsigned i;
+            for(i = 0; i < n; i++) dst.vertices().add_vertex(x[i], y[i], cmd[i]);
+            idx += n;
+        }
+    }
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 #include "agg_basics.h"
 #include "agg_color_rgba.h"
 #include "agg_rendering_buffer.h"
+#include "agg_simd.h"
 
 namespace agg
 {
@@ -224,6 +225,305 @@ namespace agg
     };
 
 
+    //=======================================================span_blender_rgba
+    // Blends whole spans for pixfmt_alpha_blend_rgba. The generic version
+    // isn't enabled, so that the pixel format calls the blender pixel by
+    // pixel. The 8-bit blender_rgba, blender_rgba_pre and blender_rgba_plain
+    // have SSE2 specializations that produce exactly the same result.
+    //------------------------------------------------------------------------
+    template<class Blender> struct span_blender_rgba
+    {
+        typedef typename Blender::color_type color_type;
+        typedef typename color_type::value_type value_type;
+        enum enabled_e { enabled = false };
+
+        static void blend_hline(value_type*, unsigned, 
+                                const color_type&, int8u) {}
+        static void blend_solid_hspan(value_type*, unsigned, 
+                                      const color_type&, const int8u*) {}
+        static void blend_color_hspan(value_type*, unsigned, 
+                                      const color_type*, const int8u*, int8u) {}
+    };
+
+#ifdef AGG_SIMD_SSE2
+    // The SSE2 kernels take 2 pixels of 16-bit lanes: the destination "d",
+    // the source color "s" in the order of the pixel format and "cv",
+    // which is cover+1 for each component. They return the result in
+    // the same form. See the derivations in the comments, they are
+    // the blend_pix() of the respective blenders, combined with the
+    // logic of copy_or_blend_rgba_wrapper.
+
+    //=================================================blender_rgba8_sse2
+    template<class Order> struct blender_rgba8_sse2
+    {
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cv)
+        {
+            // alpha == 255 is a copy, otherwise
+            // c = (d * (256 - alpha) + s * alpha) >> 8
+            // a = alpha + da - ((alpha * da + 255) >> 8)
+            __m128i alpha = sse2_mul8(sse2_broadcast<Order::A>(s), cv);
+            __m128i da    = sse2_broadcast<Order::A>(d);
+            __m128i c = _mm_srli_epi16(
+                _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(256), alpha)),
+                              _mm_mullo_epi16(s, alpha)), 8);
+            __m128i a = _mm_sub_epi16(
+                _mm_add_epi16(alpha, da),
+                _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(alpha, da), 
+                                             _mm_set1_epi16(255)), 8));
+            c = sse2_select(sse2_lane<Order::A>(), a, c);
+            return sse2_select(_mm_cmpeq_epi16(alpha, _mm_set1_epi16(255)), s, c);
+        }
+    };
+
+    //=============================================blender_rgba8_pre_sse2
+    template<class Order> struct blender_rgba8_pre_sse2
+    {
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cv)
+        {
+            // Zero source alpha leaves the pixel as is, otherwise
+            // c = (d * (255 - alpha) + s * cv) >> 8
+            // a = 255 - (((255 - alpha) * (255 - da)) >> 8)
+            // The copy and the blend_pix() without cover are the same
+            // thing with cv == 256. The sum may not fit 16 bits, so
+            // it's calculated with _mm_madd_epi16.
+            __m128i sa    = sse2_broadcast<Order::A>(s);
+            __m128i ialpha = _mm_sub_epi16(_mm_set1_epi16(255), sse2_mul8(sa, cv));
+            __m128i ida   = _mm_sub_epi16(_mm_set1_epi16(255), sse2_broadcast<Order::A>(d));
+            __m128i c = _mm_packs_epi32(
+                _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(d, s), 
+                                              _mm_unpacklo_epi16(ialpha, cv)), 8),
+                _mm_srli_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(d, s), 
+                                              _mm_unpackhi_epi16(ialpha, cv)), 8));
+            __m128i a = _mm_sub_epi16(_mm_set1_epi16(255), sse2_mul8(ialpha, ida));
+            c = sse2_select(sse2_lane<Order::A>(), a, c);
+            return sse2_select(_mm_cmpeq_epi16(sa, _mm_setzero_si128()), d, c);
+        }
+    };
+
+    //===========================================blender_rgba8_plain_sse2
+    template<class Order> struct blender_rgba8_plain_sse2
+    {
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cv)
+        {
+            // alpha == 0 leaves the pixel as is, alpha == 255 is a copy,
+            // otherwise, with r = dc * da,
+            // a' = ((alpha + da) << 8) - alpha * da
+            // c  = ((s << 8) * alpha + r * (256 - alpha)) / a'
+            // a  = a' >> 8
+            __m128i zero  = _mm_setzero_si128();
+            __m128i alpha = sse2_mul8(sse2_broadcast<Order::A>(s), cv);
+            __m128i da    = sse2_broadcast<Order::A>(d);
+            __m128i r     = _mm_mullo_epi16(d, da);
+            __m128i ia    = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+            __m128i ra_lo = _mm_mullo_epi16(r, ia);
+            __m128i ra_hi = _mm_mulhi_epu16(r, ia);
+            __m128i sa    = _mm_mullo_epi16(s, alpha);
+            __m128i ad    = _mm_mullo_epi16(alpha, da);
+            __m128i sum   = _mm_add_epi16(alpha, da);
+
+            __m128i n0 = _mm_add_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(sa, zero), 8),
+                                       _mm_unpacklo_epi16(ra_lo, ra_hi));
+            __m128i n1 = _mm_add_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(sa, zero), 8),
+                                       _mm_unpackhi_epi16(ra_lo, ra_hi));
+            __m128i a0 = _mm_sub_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(sum, zero), 8),
+                                       _mm_unpacklo_epi16(ad, zero));
+            __m128i a1 = _mm_sub_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(sum, zero), 8),
+                                       _mm_unpackhi_epi16(ad, zero));
+
+            // 1/a' for both pixels, the division is by far the most
+            // expensive thing here.
+            __m128d inv = _mm_div_pd(_mm_set1_pd(1.0),
+                                     _mm_max_pd(_mm_cvtepi32_pd(_mm_unpacklo_epi32(a0, a1)),
+                                                _mm_set1_pd(1.0)));
+            __m128i lane = _mm_unpacklo_epi16(sse2_lane<Order::A>(), 
+                                              sse2_lane<Order::A>());
+            __m128i c = _mm_packs_epi32(
+                sse2_select(lane, _mm_srli_epi32(a0, 8), div(n0, _mm_unpacklo_pd(inv, inv))),
+                sse2_select(lane, _mm_srli_epi32(a1, 8), div(n1, _mm_unpackhi_pd(inv, inv))));
+            c = sse2_select(_mm_cmpeq_epi16(alpha, zero), d, c);
+            return sse2_select(_mm_cmpeq_epi16(alpha, _mm_set1_epi16(255)), s, c);
+        }
+
+    private:
+        // n / a' truncated, with n < 2^26 and a' < 2^17. The product with
+        // the rounded reciprocal can be slightly below the exact integer
+        // quotient, the added value compensates that and is less than
+        // 1/a', so it never reaches the next integer.
+        static AGG_INLINE __m128i div(__m128i n, __m128d inv)
+        {
+            __m128d eps = _mm_set1_pd(1.0 / (1 << 20));
+            __m128i q0 = _mm_cvttpd_epi32(
+                _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(n), inv), eps));
+            __m128i q1 = _mm_cvttpd_epi32(
+                _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(n, 8)), inv), eps));
+            return _mm_unpacklo_epi64(q0, q1);
+        }
+    };
+
+    //=================================================span_blender_rgba8_sse2
+    // Processes 4 pixels at a time, the tail is blended in a temporary
+    // buffer with the same code.
+    //------------------------------------------------------------------------
+    template<class Kernel, class Order> struct span_blender_rgba8_sse2
+    {
+        enum enabled_e { enabled = true };
+
+        //--------------------------------------------------------------------
+        static void blend_hline(int8u* p, unsigned len, 
+                                const rgba8& c, int8u cover)
+        {
+            int8u pix[4];
+            pix[Order::R] = c.r;
+            pix[Order::G] = c.g;
+            pix[Order::B] = c.b;
+            pix[Order::A] = c.a;
+            __m128i s = sse2_unpack_lo(sse2_load4(pix));
+            s = _mm_unpacklo_epi64(s, s);
+            __m128i cv = _mm_set1_epi8(char(cover));
+            if(c.a == 255 && cover == 255)
+            {
+                __m128i v = _mm_packus_epi16(s, s);
+                for(; len >= 4; len -= 4)
+                {
+                    _mm_storeu_si128((__m128i*)p, v);
+                    p += 16;
+                }
+                if(len) memcpy(p, &v, len * 4);
+                return;
+            }
+            for(; len >= 4; len -= 4)
+            {
+                blend4(p, s, s, _mm_loadu_si128((const __m128i*)p), cv);
+                p += 16;
+            }
+            if(len)
+            {
+                int8u tmp_p[16];
+                memcpy(tmp_p, p, len * 4);
+                blend4(tmp_p, s, s, _mm_loadu_si128((const __m128i*)tmp_p), cv);
+                memcpy(p, tmp_p, len * 4);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        static void blend_solid_hspan(int8u* p, unsigned len, 
+                                      const rgba8& c, const int8u* covers)
+        {
+            int8u pix[4];
+            pix[Order::R] = c.r;
+            pix[Order::G] = c.g;
+            pix[Order::B] = c.b;
+            pix[Order::A] = c.a;
+            __m128i s = sse2_unpack_lo(sse2_load4(pix));
+            s = _mm_unpacklo_epi64(s, s);
+            for(; len >= 4; len -= 4)
+            {
+                __m128i cv = sse2_load4(covers);
+                if(c.a == 255 && 
+                   (_mm_movemask_epi8(_mm_cmpeq_epi8(cv, _mm_set1_epi8(-1))) & 0xF) == 0xF)
+                {
+                    // Opaque color with full covers, the same copy
+                    // as in the per-pixel code.
+                    _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(s, s));
+                }
+                else
+                {
+                    blend4(p, s, s, _mm_loadu_si128((const __m128i*)p), sse2_expand4(cv));
+                }
+                p += 16;
+                covers += 4;
+            }
+            if(len)
+            {
+                int8u tmp_p[16];
+                int8u tmp_c[4];
+                memcpy(tmp_p, p, len * 4);
+                memcpy(tmp_c, covers, len);
+                blend4(tmp_p, s, s, _mm_loadu_si128((const __m128i*)tmp_p), 
+                       sse2_expand4(sse2_load4(tmp_c)));
+                memcpy(p, tmp_p, len * 4);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        static void blend_color_hspan(int8u* p, unsigned len, 
+                                      const rgba8* colors, 
+                                      const int8u* covers, 
+                                      int8u cover)
+        {
+            __m128i cv = _mm_set1_epi8(char(cover));
+            for(; len >= 4; len -= 4)
+            {
+                if(covers)
+                {
+                    cv = sse2_expand4(sse2_load4(covers));
+                    covers += 4;
+                }
+                __m128i s = _mm_loadu_si128((const __m128i*)colors);
+                __m128i s_lo = sse2_order_rgba<Order>::apply(sse2_unpack_lo(s));
+                __m128i s_hi = sse2_order_rgba<Order>::apply(sse2_unpack_hi(s));
+                if((_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(s, cv), 
+                                                     _mm_set1_epi8(-1))) & 0x8888) == 0x8888)
+                {
+                    // Opaque colors with full covers (the interiors of
+                    // the shapes), a plain copy.
+                    _mm_storeu_si128((__m128i*)p, sse2_pack(s_lo, s_hi));
+                }
+                else
+                {
+                    blend4(p, s_lo, s_hi, _mm_loadu_si128((const __m128i*)p), cv);
+                }
+                p += 16;
+                colors += 4;
+            }
+            if(len)
+            {
+                int8u tmp_p[16];
+                int8u tmp_s[16];
+                memcpy(tmp_p, p, len * 4);
+                memcpy(tmp_s, colors, len * 4);
+                if(covers)
+                {
+                    int8u tmp_c[4];
+                    memcpy(tmp_c, covers, len);
+                    cv = sse2_expand4(sse2_load4(tmp_c));
+                }
+                __m128i s = _mm_loadu_si128((const __m128i*)tmp_s);
+                blend4(tmp_p, 
+                       sse2_order_rgba<Order>::apply(sse2_unpack_lo(s)),
+                       sse2_order_rgba<Order>::apply(sse2_unpack_hi(s)),
+                       _mm_loadu_si128((const __m128i*)tmp_p), 
+                       cv);
+                memcpy(p, tmp_p, len * 4);
+            }
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        static AGG_INLINE void blend4(int8u* p, __m128i s_lo, __m128i s_hi, 
+                                      __m128i d, __m128i covers)
+        {
+            __m128i one = _mm_set1_epi16(1);
+            __m128i lo = Kernel::blend(sse2_unpack_lo(d), s_lo, 
+                                       _mm_add_epi16(sse2_unpack_lo(covers), one));
+            __m128i hi = Kernel::blend(sse2_unpack_hi(d), s_hi, 
+                                       _mm_add_epi16(sse2_unpack_hi(covers), one));
+            _mm_storeu_si128((__m128i*)p, sse2_pack(lo, hi));
+        }
+    };
+
+    //--------------------------------------------------------------------
+    template<class Order> struct span_blender_rgba<blender_rgba<rgba8, Order> > : 
+        span_blender_rgba8_sse2<blender_rgba8_sse2<Order>, Order> {};
+
+    template<class Order> struct span_blender_rgba<blender_rgba_pre<rgba8, Order> > : 
+        span_blender_rgba8_sse2<blender_rgba8_pre_sse2<Order>, Order> {};
+
+    template<class Order> struct span_blender_rgba<blender_rgba_plain<rgba8, Order> > : 
+        span_blender_rgba8_sse2<blender_rgba8_plain_sse2<Order>, Order> {};
+#endif
+
+
 
 
 
@@ -1394,6 +1694,467 @@ namespace agg
 
 
 
+    //=======================================================comp_op_span_rgba
+    // Blends a span with one compositing operation, so that the function
+    // pointer is called once per span instead of once per pixel. The source
+    // is premultiplied as for CompOp::blend_pix(). "inc" is 0 for a solid
+    // color and 1 for an array of colors; if "covers" is 0 "cover" is
+    // used for the whole span. The generic version calls blend_pix() 
+    // for every pixel, the 8-bit Porter-Duff and the simple separable 
+    // operations have SSE2 specializations below.
+    //------------------------------------------------------------------------
+    template<class CompOp> struct comp_op_span_rgba
+    {
+        typedef typename CompOp::color_type color_type;
+        typedef typename CompOp::order_type order_type;
+        typedef typename color_type::value_type value_type;
+
+        static void blend_hspan(value_type* p, 
+                                const color_type* colors, unsigned inc,
+                                const int8u* covers, unsigned cover,
+                                unsigned len)
+        {
+            if(covers)
+            {
+                do
+                {
+                    CompOp::blend_pix(p, colors->r, colors->g, colors->b, colors->a, 
+                                      *covers++);
+                    p += 4;
+                    colors += inc;
+                }
+                while(--len);
+            }
+            else
+            {
+                do
+                {
+                    CompOp::blend_pix(p, colors->r, colors->g, colors->b, colors->a, 
+                                      cover);
+                    p += 4;
+                    colors += inc;
+                }
+                while(--len);
+            }
+        }
+    };
+
+#ifdef AGG_SIMD_SSE2
+    // The SSE2 kernels take 2 pixels of 16-bit lanes: the destination "d",
+    // the source "s" in the order of the pixel format and the cover for
+    // each component. They return the result in the same form and repeat
+    // the integer math of the respective blend_pix() exactly, including
+    // the wrap-around of invalid premultiplied colors. Scaling by cover
+    // "(s * cover + 255) >> 8" doesn't change anything with cover == 255,
+    // so that it's done unconditionally.
+
+    //-------------------------------------------------comp_op_rgba8_sse2_base
+    template<class Order> struct comp_op_rgba8_sse2_base
+    {
+        static AGG_INLINE __m128i k255() { return _mm_set1_epi16(255); }
+        static AGG_INLINE __m128i alpha(__m128i v) { return sse2_broadcast<Order::A>(v); }
+        static AGG_INLINE __m128i lane_a() { return sse2_lane<Order::A>(); }
+
+        // Sa + Da - Sa.Da 
+        static AGG_INLINE __m128i alpha_union(__m128i sa, __m128i da)
+        {
+            return _mm_sub_epi16(_mm_add_epi16(sa, da), sse2_mul255(sa, da));
+        }
+
+        // The pixels with zero scaled source alpha are left as is.
+        static AGG_INLINE __m128i skip_zero(__m128i sa, __m128i d, __m128i r)
+        {
+            return sse2_select(_mm_cmpeq_epi16(sa, _mm_setzero_si128()), d, r);
+        }
+
+        // d.(1 - cover) + x.cover
+        static AGG_INLINE __m128i mix(__m128i d, __m128i x, __m128i cover)
+        {
+            return _mm_add_epi16(sse2_mul255(d, _mm_sub_epi16(k255(), cover)), 
+                                 sse2_mul255(x, cover));
+        }
+    };
+
+    //------------------------------------------------comp_op_rgba8_clear_sse2
+    template<class Order> struct comp_op_rgba8_clear_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i, __m128i cover)
+        {
+            return sse2_mul255(d, _mm_sub_epi16(base::k255(), cover));
+        }
+    };
+
+    //--------------------------------------------------comp_op_rgba8_src_sse2
+    template<class Order> struct comp_op_rgba8_src_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            return base::mix(d, s, cover);
+        }
+    };
+
+    //---------------------------------------------comp_op_rgba8_src_over_sse2
+    template<class Order> struct comp_op_rgba8_src_over_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i c = _mm_add_epi16(s, sse2_mul255(d, _mm_sub_epi16(base::k255(), sa)));
+            return sse2_select(base::lane_a(), base::alpha_union(sa, base::alpha(d)), c);
+        }
+    };
+
+    //---------------------------------------------comp_op_rgba8_dst_over_sse2
+    template<class Order> struct comp_op_rgba8_dst_over_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i da = base::alpha(d);
+            __m128i c = _mm_add_epi16(d, sse2_mul255(s, _mm_sub_epi16(base::k255(), da)));
+            return sse2_select(base::lane_a(), base::alpha_union(base::alpha(s), da), c);
+        }
+    };
+
+    //-----------------------------------------------comp_op_rgba8_src_in_sse2
+    template<class Order> struct comp_op_rgba8_src_in_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            return base::mix(d, sse2_mul255(s, base::alpha(d)), cover);
+        }
+    };
+
+    //-----------------------------------------------comp_op_rgba8_dst_in_sse2
+    template<class Order> struct comp_op_rgba8_dst_in_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            __m128i sa = _mm_sub_epi16(base::k255(), 
+                                       sse2_mul255(cover, _mm_sub_epi16(base::k255(), 
+                                                                        base::alpha(s))));
+            return sse2_mul255(d, sa);
+        }
+    };
+
+    //----------------------------------------------comp_op_rgba8_src_out_sse2
+    template<class Order> struct comp_op_rgba8_src_out_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            return base::mix(d, sse2_mul255(s, _mm_sub_epi16(base::k255(), base::alpha(d))), 
+                             cover);
+        }
+    };
+
+    //----------------------------------------------comp_op_rgba8_dst_out_sse2
+    template<class Order> struct comp_op_rgba8_dst_out_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            // Note that blend_pix() rounds with base_shift, not base_mask.
+            __m128i sa = _mm_sub_epi16(base::k255(), sse2_mul255(base::alpha(s), cover));
+            return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, sa), 
+                                                _mm_set1_epi16(8)), 8);
+        }
+    };
+
+    //---------------------------------------------comp_op_rgba8_src_atop_sse2
+    template<class Order> struct comp_op_rgba8_src_atop_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i c = sse2_dot8(s, base::alpha(d), 
+                                  d, _mm_sub_epi16(base::k255(), base::alpha(s)),
+                                  _mm_setzero_si128());
+            return sse2_select(base::lane_a(), d, c);
+        }
+    };
+
+    //---------------------------------------------comp_op_rgba8_dst_atop_sse2
+    template<class Order> struct comp_op_rgba8_dst_atop_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            // The intermediate color may exceed 255 with invalid
+            // premultiplied colors, so that it's mixed with 32-bit 
+            // products and the full cover case is taken separately.
+            __m128i zero = _mm_setzero_si128();
+            __m128i sa = base::alpha(s);
+            __m128i x = sse2_dot8(d, sa, s, _mm_sub_epi16(base::k255(), base::alpha(d)), zero);
+            x = sse2_select(base::lane_a(), sa, x);
+            __m128i r = _mm_add_epi16(sse2_mul255(d, _mm_sub_epi16(base::k255(), cover)),
+                                      sse2_dot8(x, cover, zero, zero, zero));
+            return sse2_select(_mm_cmpeq_epi16(cover, base::k255()), x, r);
+        }
+    };
+
+    //--------------------------------------------------comp_op_rgba8_xor_sse2
+    template<class Order> struct comp_op_rgba8_xor_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i da = base::alpha(d);
+            __m128i c = sse2_dot8(d, _mm_sub_epi16(base::k255(), sa), 
+                                  s, _mm_sub_epi16(base::k255(), da),
+                                  _mm_setzero_si128());
+            __m128i a = _mm_sub_epi16(_mm_add_epi16(sa, da), 
+                                      _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sa, da), 
+                                                                   _mm_set1_epi16(127)), 7));
+            return base::skip_zero(sa, d, sse2_select(base::lane_a(), a, c));
+        }
+    };
+
+    //-------------------------------------------------comp_op_rgba8_plus_sse2
+    template<class Order> struct comp_op_rgba8_plus_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            return base::skip_zero(base::alpha(s), d, 
+                                   _mm_min_epi16(_mm_add_epi16(d, s), base::k255()));
+        }
+    };
+
+    //------------------------------------------------comp_op_rgba8_minus_sse2
+    template<class Order> struct comp_op_rgba8_minus_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i c = sse2_select(base::lane_a(), 
+                                    base::alpha_union(sa, base::alpha(d)), 
+                                    _mm_subs_epu16(d, s));
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //---------------------------------------------comp_op_rgba8_multiply_sse2
+    template<class Order> struct comp_op_rgba8_multiply_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            // Sca.Dca + Sca.(1 - Da) = Sca.(Dca + 1 - Da)
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i da = base::alpha(d);
+            __m128i c = sse2_dot8(s, _mm_add_epi16(d, _mm_sub_epi16(base::k255(), da)),
+                                  d, _mm_sub_epi16(base::k255(), sa),
+                                  _mm_setzero_si128());
+            c = sse2_select(base::lane_a(), base::alpha_union(sa, da), c);
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //-----------------------------------------------comp_op_rgba8_screen_sse2
+    template<class Order> struct comp_op_rgba8_screen_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            return base::skip_zero(base::alpha(s), d, base::alpha_union(s, d));
+        }
+    };
+
+    //-----------------------------------------------comp_op_rgba8_darken_sse2
+    template<class Order> struct comp_op_rgba8_darken_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i da = base::alpha(d);
+            __m128i m = sse2_min_epu16(_mm_mullo_epi16(s, da), _mm_mullo_epi16(d, sa));
+            __m128i c = sse2_dot8(s, _mm_sub_epi16(base::k255(), da),
+                                  d, _mm_sub_epi16(base::k255(), sa), m);
+            c = sse2_select(base::lane_a(), base::alpha_union(sa, da), c);
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //----------------------------------------------comp_op_rgba8_lighten_sse2
+    template<class Order> struct comp_op_rgba8_lighten_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i da = base::alpha(d);
+            __m128i m = sse2_max_epu16(_mm_mullo_epi16(s, da), _mm_mullo_epi16(d, sa));
+            __m128i c = sse2_dot8(s, _mm_sub_epi16(base::k255(), da),
+                                  d, _mm_sub_epi16(base::k255(), sa), m);
+            c = sse2_select(base::lane_a(), base::alpha_union(sa, da), c);
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //-------------------------------------------comp_op_rgba8_difference_sse2
+    template<class Order> struct comp_op_rgba8_difference_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            // (2.m + 255) >> 8 == (m + 127) >> 7 for integer m
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i da = base::alpha(d);
+            __m128i m = sse2_min_epu16(_mm_mullo_epi16(s, da), _mm_mullo_epi16(d, sa));
+            __m128i c = _mm_sub_epi16(_mm_add_epi16(s, d), 
+                                      _mm_srli_epi16(_mm_add_epi16(m, _mm_set1_epi16(127)), 7));
+            c = sse2_select(base::lane_a(), base::alpha_union(sa, da), c);
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //--------------------------------------------comp_op_rgba8_exclusion_sse2
+    template<class Order> struct comp_op_rgba8_exclusion_sse2 : comp_op_rgba8_sse2_base<Order>
+    {
+        typedef comp_op_rgba8_sse2_base<Order> base;
+        static AGG_INLINE __m128i blend(__m128i d, __m128i s, __m128i cover)
+        {
+            // Sca.Da + Sca.(1 - Da) = Sca, the same for Dca, so that
+            // Dca' = Sca.(1 - Dca) + Dca.(1 - Sca)
+            s = sse2_mul255(s, cover);
+            __m128i sa = base::alpha(s);
+            __m128i c = sse2_dot8(s, _mm_sub_epi16(base::k255(), d),
+                                  d, _mm_sub_epi16(base::k255(), s),
+                                  _mm_setzero_si128());
+            c = sse2_select(base::lane_a(), base::alpha_union(sa, base::alpha(d)), c);
+            return base::skip_zero(sa, d, c);
+        }
+    };
+
+    //==================================================comp_op_span_rgba8_sse2
+    template<class Kernel, class Order> struct comp_op_span_rgba8_sse2
+    {
+        static void blend_hspan(int8u* p, 
+                                const rgba8* colors, unsigned inc,
+                                const int8u* covers, unsigned cover,
+                                unsigned len)
+        {
+            __m128i cv = _mm_set1_epi8(char(cover));
+            __m128i s_lo = _mm_setzero_si128();
+            __m128i s_hi = s_lo;
+            if(inc == 0)
+            {
+                s_lo = sse2_order_rgba<Order>::apply(
+                    sse2_unpack_lo(sse2_load4((const int8u*)colors)));
+                s_lo = s_hi = _mm_unpacklo_epi64(s_lo, s_lo);
+            }
+            for(; len >= 4; len -= 4)
+            {
+                if(covers)
+                {
+                    cv = sse2_expand4(sse2_load4(covers));
+                    covers += 4;
+                }
+                if(inc)
+                {
+                    __m128i s = _mm_loadu_si128((const __m128i*)colors);
+                    s_lo = sse2_order_rgba<Order>::apply(sse2_unpack_lo(s));
+                    s_hi = sse2_order_rgba<Order>::apply(sse2_unpack_hi(s));
+                    colors += 4;
+                }
+                blend4(p, s_lo, s_hi, cv);
+                p += 16;
+            }
+            if(len)
+            {
+                int8u tmp_p[16];
+                memcpy(tmp_p, p, len * 4);
+                if(covers)
+                {
+                    int8u tmp_c[4];
+                    memcpy(tmp_c, covers, len);
+                    cv = sse2_expand4(sse2_load4(tmp_c));
+                }
+                if(inc)
+                {
+                    int8u tmp_s[16];
+                    memcpy(tmp_s, colors, len * 4);
+                    __m128i s = _mm_loadu_si128((const __m128i*)tmp_s);
+                    s_lo = sse2_order_rgba<Order>::apply(sse2_unpack_lo(s));
+                    s_hi = sse2_order_rgba<Order>::apply(sse2_unpack_hi(s));
+                }
+                blend4(tmp_p, s_lo, s_hi, cv);
+                memcpy(p, tmp_p, len * 4);
+            }
+        }
+
+    private:
+        static AGG_INLINE void blend4(int8u* p, __m128i s_lo, __m128i s_hi, __m128i covers)
+        {
+            __m128i d = _mm_loadu_si128((const __m128i*)p);
+            __m128i lo = Kernel::blend(sse2_unpack_lo(d), s_lo, sse2_unpack_lo(covers));
+            __m128i hi = Kernel::blend(sse2_unpack_hi(d), s_hi, sse2_unpack_hi(covers));
+            _mm_storeu_si128((__m128i*)p, sse2_pack(lo, hi));
+        }
+    };
+
+    //--------------------------------------------------------------------
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_clear<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_clear_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_src<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_src_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_src_over<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_src_over_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_dst_over<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_dst_over_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_src_in<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_src_in_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_dst_in<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_dst_in_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_src_out<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_src_out_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_dst_out<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_dst_out_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_src_atop<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_src_atop_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_dst_atop<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_dst_atop_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_xor<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_xor_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_plus<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_plus_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_minus<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_minus_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_multiply<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_multiply_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_screen<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_screen_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_darken<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_darken_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_lighten<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_lighten_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_difference<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_difference_sse2<Order>, Order> {};
+    template<class Order> struct comp_op_span_rgba<comp_op_rgba_exclusion<rgba8, Order> > : 
+        comp_op_span_rgba8_sse2<comp_op_rgba8_exclusion_sse2<Order>, Order> {};
+#endif
+
+
 
 
     //======================================================comp_op_table_rgba
@@ -1445,6 +2206,55 @@ namespace agg
         0
     };
 
+    //=================================================comp_op_span_table_rgba
+    template<class ColorT, class Order> struct comp_op_span_table_rgba
+    {
+        typedef typename ColorT::value_type value_type;
+        typedef void (*comp_op_span_func_type)(value_type* p, 
+                                               const ColorT* colors, 
+                                               unsigned inc,
+                                               const int8u* covers,
+                                               unsigned cover,
+                                               unsigned len);
+        static comp_op_span_func_type g_comp_op_span_func[];
+    };
+
+    //=====================================================g_comp_op_span_func
+    template<class ColorT, class Order> 
+    typename comp_op_span_table_rgba<ColorT, Order>::comp_op_span_func_type
+    comp_op_span_table_rgba<ColorT, Order>::g_comp_op_span_func[] = 
+    {
+        comp_op_span_rgba<comp_op_rgba_clear      <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_src        <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_dst        <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_src_over   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_dst_over   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_src_in     <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_dst_in     <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_src_out    <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_dst_out    <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_src_atop   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_dst_atop   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_xor        <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_plus       <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_minus      <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_multiply   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_screen     <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_overlay    <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_darken     <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_lighten    <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_color_dodge<ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_color_burn <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_hard_light <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_soft_light <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_difference <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_exclusion  <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_contrast   <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_invert     <ColorT,Order> >::blend_hspan,
+        comp_op_span_rgba<comp_op_rgba_invert_rgb <ColorT,Order> >::blend_hspan,
+        0
+    };
+
 
     //==============================================================comp_op_e
     enum comp_op_e
@@ -1677,6 +2487,117 @@ namespace agg
 
 
 
+    //===============================================comp_op_span_adaptor_rgba
+    // Blends spans for pixfmt_custom_blend_rgba, the arguments are the 
+    // same as in comp_op_span_rgba. The generic version calls
+    // Blender::blend_pix() for every pixel. comp_op_adaptor_rgba and
+    // comp_op_adaptor_rgba_pre call the span function of the operation
+    // from comp_op_span_table_rgba, once per span.
+    //------------------------------------------------------------------------
+    template<class Blender> struct comp_op_span_adaptor_rgba
+    {
+        typedef typename Blender::color_type color_type;
+        typedef typename color_type::value_type value_type;
+
+        static void blend_hspan(unsigned op, value_type* p, 
+                                const color_type* colors, unsigned inc,
+                                const int8u* covers, unsigned cover,
+                                unsigned len)
+        {
+            do
+            {
+                Blender::blend_pix(op, p, 
+                                   colors->r, colors->g, colors->b, colors->a, 
+                                   covers ? *covers++ : cover);
+                p += 4;
+                colors += inc;
+            }
+            while(--len);
+        }
+    };
+
+    //--------------------------------------------------------------------
+    template<class ColorT, class Order> 
+    struct comp_op_span_adaptor_rgba<comp_op_adaptor_rgba_pre<ColorT, Order> >
+    {
+        typedef ColorT color_type;
+        typedef typename color_type::value_type value_type;
+
+        static void blend_hspan(unsigned op, value_type* p, 
+                                const color_type* colors, unsigned inc,
+                                const int8u* covers, unsigned cover,
+                                unsigned len)
+        {
+            comp_op_span_table_rgba<ColorT, Order>::g_comp_op_span_func[op]
+                (p, colors, inc, covers, cover, len);
+        }
+    };
+
+    //--------------------------------------------------------------------
+    template<class ColorT, class Order> 
+    struct comp_op_span_adaptor_rgba<comp_op_adaptor_rgba<ColorT, Order> >
+    {
+        typedef ColorT color_type;
+        typedef typename color_type::value_type value_type;
+        enum base_scale_e
+        {  
+            base_shift = color_type::base_shift,
+            base_mask  = color_type::base_mask 
+        };
+        enum buf_size_e { buf_size = 64 };
+
+        // The colors are premultiplied the same way as in 
+        // comp_op_adaptor_rgba, by portions of buf_size.
+        static void blend_hspan(unsigned op, value_type* p, 
+                                const color_type* colors, unsigned inc,
+                                const int8u* covers, unsigned cover,
+                                unsigned len)
+        {
+            color_type buf[buf_size];
+            if(inc == 0)
+            {
+                premultiply(buf, colors, 1);
+                comp_op_span_table_rgba<ColorT, Order>::g_comp_op_span_func[op]
+                    (p, buf, 0, covers, cover, len);
+                return;
+            }
+            while(len)
+            {
+                unsigned n = (len < unsigned(buf_size)) ? len : unsigned(buf_size);
+                premultiply(buf, colors, n);
+                comp_op_span_table_rgba<ColorT, Order>::g_comp_op_span_func[op]
+                    (p, buf, 1, covers, cover, n);
+                p += n << 2;
+                colors += n;
+                if(covers) covers += n;
+                len -= n;
+            }
+        }
+
+    private:
+        static AGG_INLINE void premultiply(color_type* dst, 
+                                           const color_type* src, 
+                                           unsigned n)
+        {
+            do
+            {
+                unsigned ca = src->a;
+                dst->r = (value_type)((src->r * ca + base_mask) >> base_shift);
+                dst->g = (value_type)((src->g * ca + base_mask) >> base_shift);
+                dst->b = (value_type)((src->b * ca + base_mask) >> base_shift);
+                dst->a = (value_type)ca;
+                ++dst;
+                ++src;
+            }
+            while(--n);
+        }
+    };
+
+
+
+
+
+
     //===============================================copy_or_blend_rgba_wrapper
     template<class Blender> struct copy_or_blend_rgba_wrapper
     {
@@ -1762,6 +2683,7 @@ namespace agg
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
         typedef copy_or_blend_rgba_wrapper<blender_type> cob_type;
+        typedef span_blender_rgba<blender_type> span_blender_type;
         enum base_scale_e
         {
             base_shift = color_type::base_shift,
@@ -1906,6 +2828,11 @@ namespace agg
             if (c.a)
             {
                 value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
+                if(span_blender_type::enabled)
+                {
+                    span_blender_type::blend_hline(p, len, c, cover);
+                    return;
+                }
                 calc_type alpha = (calc_type(c.a) * (cover + 1)) >> 8;
                 if(alpha == base_mask)
                 {
@@ -2004,6 +2931,11 @@ namespace agg
             if (c.a)
             {
                 value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
+                if(span_blender_type::enabled)
+                {
+                    span_blender_type::blend_solid_hspan(p, len, c, covers);
+                    return;
+                }
                 do 
                 {
                     calc_type alpha = (calc_type(c.a) * (calc_type(*covers) + 1)) >> 8;
@@ -2101,6 +3033,11 @@ namespace agg
                                int8u cover)
         {
             value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
+            if(span_blender_type::enabled)
+            {
+                span_blender_type::blend_color_hspan(p, len, colors, covers, cover);
+                return;
+            }
             if(covers)
             {
                 do 
@@ -2414,6 +3351,7 @@ namespace agg
         typedef typename blender_type::order_type order_type;
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
+        typedef comp_op_span_adaptor_rgba<blender_type> span_blender_type;
         enum base_scale_e
         {
             base_shift = color_type::base_shift,
@@ -2514,13 +3452,10 @@ namespace agg
         //--------------------------------------------------------------------
         void copy_hline(int x, int y, unsigned len, const color_type& c)
         {
-            value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);;
-            do
-            {
-                blender_type::blend_pix(m_comp_op, p, c.r, c.g, c.b, c.a, 255);
-                p += 4;
-            }
-            while(--len);
+            span_blender_type::blend_hspan(
+                m_comp_op,
+                (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2),
+                &c, 0, 0, 255, len);
         }
 
         //--------------------------------------------------------------------
@@ -2540,14 +3475,10 @@ namespace agg
         void blend_hline(int x, int y, unsigned len, 
                          const color_type& c, int8u cover)
         {
-
-            value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
-            do
-            {
-                blender_type::blend_pix(m_comp_op, p, c.r, c.g, c.b, c.a, cover);
-                p += 4;
-            }
-            while(--len);
+            span_blender_type::blend_hspan(
+                m_comp_op,
+                (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2),
+                &c, 0, 0, cover, len);
         }
 
         //--------------------------------------------------------------------
@@ -2570,15 +3501,10 @@ namespace agg
         void blend_solid_hspan(int x, int y, unsigned len, 
                                const color_type& c, const int8u* covers)
         {
-            value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
-            do 
-            {
-                blender_type::blend_pix(m_comp_op, 
-                                        p, c.r, c.g, c.b, c.a, 
-                                        *covers++);
-                p += 4;
-            }
-            while(--len);
+            span_blender_type::blend_hspan(
+                m_comp_op,
+                (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2),
+                &c, 0, covers, 255, len);
         }
 
         //--------------------------------------------------------------------
@@ -2638,20 +3564,10 @@ namespace agg
                                const int8u* covers,
                                int8u cover)
         {
-            value_type* p = (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2);
-            do 
-            {
-                blender_type::blend_pix(m_comp_op, 
-                                        p, 
-                                        colors->r, 
-                                        colors->g, 
-                                        colors->b, 
-                                        colors->a, 
-                                        covers ? *covers++ : cover);
-                p += 4;
-                ++colors;
-            }
-            while(--len);
+            span_blender_type::blend_hspan(
+                m_comp_op,
+                (value_type*)m_rbuf->row_ptr(x, y, len) + (x << 2),
+                colors, 1, covers, cover, len);
         }
 
         //--------------------------------------------------------------------
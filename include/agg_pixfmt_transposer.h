@@ -16,7 +16,9 @@
 #ifndef AGG_PIXFMT_TRANSPOSER_INCLUDED
 #define AGG_PIXFMT_TRANSPOSER_INCLUDED
 
+#include <string.h>
 #include "agg_basics.h"
+#include "agg_array.h"
 
 namespace agg
 {
@@ -150,6 +152,113 @@ namespace agg
     private:
         pixfmt_type* m_pixf;
     };
+
+    //=================================================pixfmt_transposed_strip
+    // A strip of columns of a pixel format transposed into a contiguous
+    // buffer: row "y" of the strip is column "x1 + y" of the pixel format.
+    // It's the cache-friendly alternative to pixfmt_transposer for the 
+    // algorithms that process the image column by column, such as blur. 
+    // Walking down a column of a large image touches a new cache line 
+    // on every pixel. Instead, load() and store() copy the strip by 
+    // square tiles of tile_size pixels, and the algorithm works with 
+    // contiguous rows in between. The strip has the subset of the pixel
+    // format interface used by stack_blur and recursive_blur.
+    //------------------------------------------------------------------------
+    template<class PixFmt> class pixfmt_transposed_strip
+    {
+    public:
+        typedef PixFmt pixfmt_type;
+        typedef typename pixfmt_type::color_type color_type;
+        typedef typename color_type::value_type value_type;
+
+        enum tile_size_e { tile_size = 32 };
+
+        //--------------------------------------------------------------------
+        pixfmt_transposed_strip() : m_pixf(0), m_x1(0), m_num(0) {}
+        explicit pixfmt_transposed_strip(pixfmt_type& pixf) : 
+            m_pixf(&pixf), m_x1(0), m_num(0) {}
+        void attach(pixfmt_type& pixf) { m_pixf = &pixf; }
+
+        //--------------------------------------------------------------------
+        // Copies "num" columns starting from "x1" to the strip.
+        void load(int x1, unsigned num)
+        {
+            unsigned h = m_pixf->height();
+            m_x1  = x1;
+            m_num = num;
+            m_buf.allocate(h * num);
+
+            unsigned x0, y0, x, y;
+            for(x0 = 0; x0 < num; x0 += tile_size)
+            {
+                unsigned x2 = (x0 + tile_size < num) ? x0 + tile_size : num;
+                for(y0 = 0; y0 < h; y0 += tile_size)
+                {
+                    unsigned y2 = (y0 + tile_size < h) ? y0 + tile_size : h;
+                    for(y = y0; y < y2; y++)
+                    {
+                        for(x = x0; x < x2; x++)
+                        {
+                            m_buf[x * h + y] = m_pixf->pixel(x1 + x, y);
+                        }
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Copies the strip back to the columns it was loaded from.
+        void store()
+        {
+            unsigned h = m_pixf->height();
+            unsigned x0, y0, x, y;
+            for(x0 = 0; x0 < m_num; x0 += tile_size)
+            {
+                unsigned x2 = (x0 + tile_size < m_num) ? x0 + tile_size : m_num;
+                for(y0 = 0; y0 < h; y0 += tile_size)
+                {
+                    unsigned y2 = (y0 + tile_size < h) ? y0 + tile_size : h;
+                    for(y = y0; y < y2; y++)
+                    {
+                        for(x = x0; x < x2; x++)
+                        {
+                            m_pixf->copy_pixel(m_x1 + x, y, m_buf[x * h + y]);
+                        }
+                    }
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------
+        AGG_INLINE unsigned width()  const { return m_pixf->height(); }
+        AGG_INLINE unsigned height() const { return m_num; }
+
+        //--------------------------------------------------------------------
+        AGG_INLINE color_type pixel(int x, int y) const
+        {
+            return m_buf[y * width() + x];
+        }
+
+        //--------------------------------------------------------------------
+        AGG_INLINE void copy_pixel(int x, int y, const color_type& c)
+        {
+            m_buf[y * width() + x] = c;
+        }
+
+        //--------------------------------------------------------------------
+        AGG_INLINE void copy_color_hspan(int x, int y,
+                                         unsigned len, 
+                                         const color_type* colors)
+        {
+            memcpy(&m_buf[y * width() + x], colors, len * sizeof(color_type));
+        }
+
+    private:
+        pixfmt_type*           m_pixf;
+        int                    m_x1;
+        unsigned               m_num;
+        pod_vector<color_type> m_buf;
+    };
 }
 
 #endif
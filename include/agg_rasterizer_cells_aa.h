@@ -38,6 +38,16 @@
 namespace agg
 {
 
+    //------------------------------------------------------------cell_sort_e
+    // The way the cells of each scanline are sorted by X. cell_sort_auto
+    // uses quick sort for short scanlines and radix sort for long ones. 
+    enum cell_sort_e
+    {
+        cell_sort_auto,
+        cell_sort_quick,
+        cell_sort_radix
+    };
+
     //-----------------------------------------------------rasterizer_cells_aa
     // An internal class that implements the main rasterization algorithm.
     // Used in the rasterizer. Should not be used direcly.
@@ -52,6 +62,11 @@ namespace agg
             cell_block_limit = 1024
         };
 
+        enum radix_sort_threshold_e
+        {
+            radix_sort_threshold = 32
+        };
+
         struct sorted_y
         {
             unsigned start;
@@ -69,6 +84,24 @@ namespace agg
         void style(const cell_type& style_cell);
         void line(int x1, int y1, int x2, int y2);
 
+        // Restrict the produced cells to the rows [y1...y2]. Cells in 
+        // the other rows are discarded, the ones inside are exactly 
+        // the same as without the band. The band survives reset().
+        void band(int y1, int y2) { m_band_min_y = y1; m_band_max_y = y2; }
+        void reset_band() { m_band_min_y = -0x7FFFFFFF; m_band_max_y = 0x7FFFFFFF; }
+        int band_min_y() const { return m_band_min_y; }
+        int band_max_y() const { return m_band_max_y; }
+
+        void cell_sort(cell_sort_e s) { m_cell_sort = s; }
+        cell_sort_e cell_sort() const { return m_cell_sort; }
+
+        // The maximal number of cells, rounded up to the cell block size.
+        // The cells that don't fit are dropped and overflow() is set until
+        // the next reset(). The default is 1024 blocks, that is, 4M cells.
+        void max_cells(unsigned num);
+        unsigned max_cells() const { return m_max_cell_blocks << cell_block_shift; }
+        bool overflow() const { return m_overflow; }
+
         int min_x() const { return m_min_x; }
         int min_y() const { return m_min_y; }
         int max_x() const { return m_max_x; }
@@ -111,12 +144,18 @@ namespace agg
         cell_type*              m_curr_cell_ptr;
         pod_vector<cell_type*>  m_sorted_cells;
         pod_vector<sorted_y>    m_sorted_y;
+        pod_vector<cell_type*>  m_sort_buf;
         cell_type               m_curr_cell;
         cell_type               m_style_cell;
         int                     m_min_x;
         int                     m_min_y;
         int                     m_max_x;
         int                     m_max_y;
+        int                     m_band_min_y;
+        int                     m_band_max_y;
+        cell_sort_e             m_cell_sort;
+        unsigned                m_max_cell_blocks;
+        bool                    m_overflow;
         bool                    m_sorted;
     };
 
@@ -150,10 +189,16 @@ namespace agg
         m_curr_cell_ptr(0),
         m_sorted_cells(),
         m_sorted_y(),
+        m_sort_buf(),
         m_min_x(0x7FFFFFFF),
         m_min_y(0x7FFFFFFF),
         m_max_x(-0x7FFFFFFF),
         m_max_y(-0x7FFFFFFF),
+        m_band_min_y(-0x7FFFFFFF),
+        m_band_max_y(0x7FFFFFFF),
+        m_cell_sort(cell_sort_auto),
+        m_max_cell_blocks(cell_block_limit),
+        m_overflow(false),
         m_sorted(false)
     {
         m_style_cell.initial();
@@ -168,6 +213,7 @@ namespace agg
         m_curr_block = 0;
         m_curr_cell.initial();
         m_style_cell.initial();
+        m_overflow = false;
         m_sorted = false;
         m_min_x =  0x7FFFFFFF;
         m_min_y =  0x7FFFFFFF;
@@ -179,11 +225,17 @@ namespace agg
     template<class Cell> 
     AGG_INLINE void rasterizer_cells_aa<Cell>::add_curr_cell()
     {
-        if(m_curr_cell.area | m_curr_cell.cover)
+        if((m_curr_cell.area | m_curr_cell.cover) &&
+           m_curr_cell.y >= m_band_min_y && 
+           m_curr_cell.y <= m_band_max_y)
         {
             if((m_num_cells & cell_block_mask) == 0)
             {
-                if(m_num_blocks >= cell_block_limit) return;
+                if(m_curr_block >= m_max_cell_blocks) 
+                {
+                    m_overflow = true;
+                    return;
+                }
                 allocate_block();
             }
             *m_curr_cell_ptr++ = m_curr_cell;
@@ -191,6 +243,15 @@ namespace agg
         }
     }
 
+    //------------------------------------------------------------------------
+    template<class Cell> 
+    void rasterizer_cells_aa<Cell>::max_cells(unsigned num)
+    {
+        m_max_cell_blocks = (num >> cell_block_shift) + 
+                            ((num & cell_block_mask) != 0);
+        if(m_max_cell_blocks == 0) m_max_cell_blocks = 1;
+    }
+
     //------------------------------------------------------------------------
     template<class Cell> 
     AGG_INLINE void rasterizer_cells_aa<Cell>::set_curr_cell(int x, int y)
@@ -349,6 +410,13 @@ namespace agg
 
         set_curr_cell(ex1, ey1);
 
+        //the line can't produce any cells inside the band
+        if((ey1 < m_band_min_y && ey2 < m_band_min_y) ||
+           (ey1 > m_band_max_y && ey2 > m_band_max_y))
+        {
+            return;
+        }
+
         //everything is on a single hline
         if(ey1 == ey2)
         {
@@ -618,6 +686,61 @@ namespace agg
     }
 
 
+    //------------------------------------------------------------------------
+    // LSD radix sort of the cells by X, 8 bits per pass. All the X values 
+    // must be within [min_x...max_x], "buf" must have room for "num" 
+    // pointers. Passes in which all the cells have the same digit are 
+    // skipped, so that a typical scanline takes two passes. Unlike 
+    // qsort_cells() the sort is stable, which doesn't matter since 
+    // the cells with the same X are accumulated anyway.
+    template<class Cell>
+    void radix_sort_cells(Cell** start, unsigned num, Cell** buf,
+                          int min_x, int max_x)
+    {
+        unsigned count[256];
+        unsigned range = unsigned(max_x - min_x);
+        Cell** src = start;
+        Cell** dst = buf;
+        unsigned shift;
+        unsigned i;
+
+        for(shift = 0; shift < 32 && (range >> shift) != 0; shift += 8)
+        {
+            memset(count, 0, sizeof(count));
+            for(i = 0; i < num; i++)
+            {
+                ++count[(unsigned(src[i]->x - min_x) >> shift) & 0xFF];
+            }
+
+            unsigned digit = (unsigned(src[0]->x - min_x) >> shift) & 0xFF;
+            if(count[digit] == num) continue;
+
+            unsigned pos = 0;
+            for(i = 0; i < 256; i++)
+            {
+                unsigned v = count[i];
+                count[i] = pos;
+                pos += v;
+            }
+
+            for(i = 0; i < num; i++)
+            {
+                Cell* cell = src[i];
+                dst[count[(unsigned(cell->x - min_x) >> shift) & 0xFF]++] = cell;
+            }
+
+            Cell** tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+
+        if(src != start)
+        {
+            memcpy(start, src, num * sizeof(Cell*));
+        }
+    }
+
+
     //------------------------------------------------------------------------
     template<class Cell> 
     void rasterizer_cells_aa<Cell>::sort_cells()
@@ -632,6 +755,10 @@ namespace agg
 
         if(m_num_cells == 0) return;
 
+        // All the cells are inside the band
+        if(m_min_y < m_band_min_y) m_min_y = m_band_min_y;
+        if(m_max_y > m_band_max_y) m_max_y = m_band_max_y;
+
 // DBG: Check to see if min/max works well.
 //for(unsigned nc = 0; nc < m_num_cells; nc++)
 //{
@@ -711,9 +838,25 @@ namespace agg
         }
 
         // Finally arrange the X-arrays
+        unsigned radix_threshold = radix_sort_threshold;
+        if(m_cell_sort == cell_sort_quick) radix_threshold = 0xFFFFFFFF;
+        if(m_cell_sort == cell_sort_radix) radix_threshold = 2;
+
         for(i = 0; i < m_sorted_y.size(); i++)
         {
             const sorted_y& curr_y = m_sorted_y[i];
+            if(curr_y.num >= radix_threshold)
+            {
+                if(m_sort_buf.size() < curr_y.num)
+                {
+                    m_sort_buf.allocate(curr_y.num, 256);
+                }
+                radix_sort_cells(m_sorted_cells.data() + curr_y.start, 
+                                 curr_y.num,
+                                 m_sort_buf.data(),
+                                 m_min_x, m_max_x);
+            }
+            else
             if(curr_y.num)
             {
                 qsort_cells(m_sorted_cells.data() + curr_y.start, curr_y.num);
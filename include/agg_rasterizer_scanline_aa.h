@@ -121,6 +121,8 @@ namespace agg
             aa_mask2  = aa_scale2 - 1
         };
 
+        enum vertex_block_size_e { vertex_block_size = 256 };
+
         //--------------------------------------------------------------------
         rasterizer_scanline_aa() : 
             m_outline(),
@@ -154,7 +156,31 @@ namespace agg
         void reset_clipping();
         void clip_box(double x1, double y1, double x2, double y2);
         void filling_rule(filling_rule_e filling_rule);
+        filling_rule_e filling_rule() const { return m_filling_rule; }
         void auto_close(bool flag) { m_auto_close = flag; }
+        bool auto_close() const { return m_auto_close; }
+
+        //--------------------------------------------------------------------
+        // Produce scanlines only within [y1...y2] (pixel rows). Unlike 
+        // clip_box() the geometry isn't clipped, so the scanlines in the
+        // band are bit-exact copies of the ones without the band. 
+        // Used in rendering the same scene by horizontal bands. 
+        void band(int y1, int y2);
+        void reset_band();
+        int  band_min_y() const { return m_outline.band_min_y(); }
+        int  band_max_y() const { return m_outline.band_max_y(); }
+
+        //--------------------------------------------------------------------
+        // The cell budget. When it's exceeded the extra cells are dropped
+        // and overflow() returns true until reset(). Note that the last 
+        // cell is added in sort(). See also render_path_bounded().
+        void max_cells(unsigned num) { m_outline.max_cells(num); }
+        unsigned max_cells() const { return m_outline.max_cells(); }
+        bool overflow() const { return m_outline.overflow(); }
+
+        //--------------------------------------------------------------------
+        // Optional, cell_sort_auto by default, see cell_sort_e.
+        void cell_sort(cell_sort_e s) { m_outline.cell_sort(s); }
 
         //--------------------------------------------------------------------
         template<class GammaF> void gamma(const GammaF& gamma_function)
@@ -184,18 +210,26 @@ namespace agg
         void edge_d(double x1, double y1, double x2, double y2);
 
         //-------------------------------------------------------------------
+        // The vertices are read in blocks, see vertex_block().
         template<class VertexSource>
         void add_path(VertexSource& vs, unsigned path_id=0)
         {
-            double x;
-            double y;
+            double   x[vertex_block_size];
+            double   y[vertex_block_size];
+            unsigned cmd[vertex_block_size];
 
-            unsigned cmd;
             vs.rewind(path_id);
             if(m_outline.sorted()) reset();
-            while(!is_stop(cmd = vs.vertex(&x, &y)))
+            for(;;)
             {
-                add_vertex(x, y, cmd);
+                unsigned n = vertex_block(vs, x, y, cmd, vertex_block_size);
+                unsigned i;
+                for(i = 0; i < n; i++)
+                {
+                    if(is_stop(cmd[i])) return;
+                    add_vertex(x[i], y[i], cmd[i]);
+                }
+                if(n == 0) return;
             }
         }
         
@@ -204,6 +238,7 @@ namespace agg
         int min_y() const { return m_outline.min_y(); }
         int max_x() const { return m_outline.max_x(); }
         int max_y() const { return m_outline.max_y(); }
+        unsigned total_cells() const { return m_outline.total_cells(); }
 
         //--------------------------------------------------------------------
         void sort();
@@ -353,6 +388,22 @@ namespace agg
         m_clipper.reset_clipping();
     }
 
+    //------------------------------------------------------------------------
+    template<class Clip> 
+    void rasterizer_scanline_aa<Clip>::band(int y1, int y2)
+    {
+        reset();
+        m_outline.band(y1, y2);
+    }
+
+    //------------------------------------------------------------------------
+    template<class Clip> 
+    void rasterizer_scanline_aa<Clip>::reset_band()
+    {
+        reset();
+        m_outline.reset_band();
+    }
+
     //------------------------------------------------------------------------
     template<class Clip> 
     void rasterizer_scanline_aa<Clip>::close_polygon()
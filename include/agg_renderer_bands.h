@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// class renderer_bands
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_RENDERER_BANDS_INCLUDED
+#define AGG_RENDERER_BANDS_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_renderer_base.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_span_allocator.h"
+#include "agg_threads.h"
+
+namespace agg
+{
+
+    //==========================================================renderer_bands
+    // Renders a scene in parallel by splitting the pixel format into
+    // horizontal bands. Every band gets its own rasterizer, scanline,
+    // span allocator and renderer_base clipped to the band rows, and
+    // the whole scene is replayed into each of them. The rasterizer
+    // is restricted with rasterizer_scanline_aa::band(), which drops the
+    // cells outside the band instead of clipping the geometry, so the
+    // result is bit-identical to rendering the scene in one pass.
+    //
+    // The scene is a functor:
+    //
+    //  struct scene
+    //  {
+    //      void operator() (renderer_bands<...>::rasterizer_type& ras,
+    //                       renderer_bands<...>::scanline_type& sl,
+    //                       renderer_bands<...>::base_ren_type& ren,
+    //                       renderer_bands<...>::span_alloc_type& alloc) const;
+    //  };
+    //
+    // It's called concurrently from different threads, so everything
+    // that has a state (vertex converters, span generators, interpolators)
+    // must be created inside the call. Shared data, such as colors, can
+    // be read freely. Note that path_storage keeps its own iterator, so it
+    // has to be read through path_reader.
+    //------------------------------------------------------------------------
+    template<class PixFmt,
+             class Rasterizer = rasterizer_scanline_aa<>,
+             class Scanline   = scanline_u8>
+    class renderer_bands
+    {
+    public:
+        typedef PixFmt                          pixfmt_type;
+        typedef typename pixfmt_type::color_type color_type;
+        typedef renderer_base<pixfmt_type>      base_ren_type;
+        typedef Rasterizer                      rasterizer_type;
+        typedef Scanline                        scanline_type;
+        typedef span_allocator<color_type>      span_alloc_type;
+
+        //--------------------------------------------------------------------
+        renderer_bands() :
+            m_pixf(0), m_clip_box(1, 1, 0, 0), m_num_threads(1), m_num_bands(0) {}
+        explicit renderer_bands(pixfmt_type& pixf, unsigned num_threads=1) :
+            m_pixf(&pixf),
+            m_clip_box(0, 0, pixf.width() - 1, pixf.height() - 1),
+            m_num_threads(num_threads),
+            m_num_bands(0)
+        {}
+        void attach(pixfmt_type& pixf)
+        {
+            m_pixf = &pixf;
+            m_clip_box = rect_i(0, 0, pixf.width() - 1, pixf.height() - 1);
+        }
+
+        //--------------------------------------------------------------------
+        // The clip box of the renderer_base given to the scene,
+        // before it's intersected with the band.
+        bool clip_box(int x1, int y1, int x2, int y2)
+        {
+            rect_i cb(x1, y1, x2, y2);
+            cb.normalize();
+            if(cb.clip(rect_i(0, 0, m_pixf->width() - 1, m_pixf->height() - 1)))
+            {
+                m_clip_box = cb;
+                return true;
+            }
+            m_clip_box = rect_i(1, 1, 0, 0);
+            return false;
+        }
+        const rect_i& clip_box() const { return m_clip_box; }
+
+        //--------------------------------------------------------------------
+        void num_threads(unsigned n) { m_num_threads = n ? n : 1; }
+        unsigned num_threads() const { return m_num_threads; }
+
+        // Number of bands, 0 means one band per thread. More bands than
+        // threads improve the load balancing when the geometry isn't
+        // uniformly distributed, at the cost of replaying the scene
+        // more times.
+        void num_bands(unsigned n) { m_num_bands = n; }
+        unsigned num_bands() const { return m_num_bands; }
+
+        //--------------------------------------------------------------------
+        template<class Scene> void render(const Scene& scene)
+        {
+            if(m_clip_box.x1 > m_clip_box.x2 || m_clip_box.y1 > m_clip_box.y2)
+            {
+                return;
+            }
+
+            unsigned height = unsigned(m_clip_box.y2 - m_clip_box.y1 + 1);
+            unsigned num_bands = m_num_bands ? m_num_bands : m_num_threads;
+            if(num_bands > height) num_bands = height;
+
+            band_job<Scene> job;
+            job.self      = this;
+            job.scene     = &scene;
+            job.num_bands = num_bands;
+            parallel_for(job, num_bands, m_num_threads);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        template<class Scene> struct band_job
+        {
+            const renderer_bands* self;
+            const Scene*          scene;
+            unsigned              num_bands;
+
+            void operator() (unsigned i)
+            {
+                self->render_band(*scene, i, num_bands);
+            }
+        };
+
+        //--------------------------------------------------------------------
+        template<class Scene>
+        void render_band(const Scene& scene, unsigned i, unsigned num_bands) const
+        {
+            int height = m_clip_box.y2 - m_clip_box.y1 + 1;
+            int y1 = m_clip_box.y1 + int(height * i / num_bands);
+            int y2 = m_clip_box.y1 + int(height * (i + 1) / num_bands) - 1;
+
+            rasterizer_type ras;
+            scanline_type   sl;
+            span_alloc_type alloc;
+            base_ren_type   ren(*m_pixf);
+
+            ras.band(y1, y2);
+            ren.clip_box(m_clip_box.x1, y1, m_clip_box.x2, y2);
+            scene(ras, sl, ren, alloc);
+        }
+
+        pixfmt_type* m_pixf;
+        rect_i       m_clip_box;
+        unsigned     m_num_threads;
+        unsigned     m_num_bands;
+    };
+
+}
+
+#endif
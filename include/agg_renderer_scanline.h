@@ -18,10 +18,66 @@
 
 #include "agg_basics.h"
 #include "agg_renderer_base.h"
+#include "agg_span_runs.h"
 
 namespace agg
 {
 
+    //====================================================blend_solid_hspan_aa
+    // Blends a span of a scanline, filling its part [full_x1, full_x1 + 
+    // full_len) where all the covers are cover_full with blend_hline(), 
+    // see span_full_cover().
+    template<class BaseRenderer, class ColorT, class CoverT> 
+    void blend_solid_hspan_aa(BaseRenderer& ren, int x, int y, int len, 
+                              const ColorT& color, const CoverT* covers,
+                              int full_x1, int full_len)
+    {
+        if(full_len)
+        {
+            int x2 = x + len;
+            int f1 = full_x1;
+            int f2 = full_x1 + full_len;
+            if(f1 < x)  f1 = x;
+            if(f2 > x2) f2 = x2;
+            if(f1 < f2)
+            {
+                if(f1 > x) ren.blend_solid_hspan(x, y, f1 - x, color, covers);
+                ren.blend_hline(f1, y, f2 - 1, color, cover_full);
+                if(f2 < x2) ren.blend_solid_hspan(f2, y, x2 - f2, color, 
+                                                  covers + (f2 - x));
+                return;
+            }
+        }
+        ren.blend_solid_hspan(x, y, len, color, covers);
+    }
+
+    //====================================================blend_color_hspan_aa
+    // The same for the generated colors, passing no covers for the fully
+    // covered part. "covers" is 0 if all the pixels have "cover".
+    template<class BaseRenderer, class ColorT, class CoverT> 
+    void blend_color_hspan_aa(BaseRenderer& ren, int x, int y, int len, 
+                              const ColorT* colors, const CoverT* covers,
+                              CoverT cover, int full_x1, int full_len)
+    {
+        if(full_len && covers)
+        {
+            int x2 = x + len;
+            int f1 = full_x1;
+            int f2 = full_x1 + full_len;
+            if(f1 < x)  f1 = x;
+            if(f2 > x2) f2 = x2;
+            if(f1 < f2)
+            {
+                if(f1 > x) ren.blend_color_hspan(x, y, f1 - x, colors, covers, cover);
+                ren.blend_color_hspan(f1, y, f2 - f1, colors + (f1 - x), 0, cover_full);
+                if(f2 < x2) ren.blend_color_hspan(f2, y, x2 - f2, colors + (f2 - x), 
+                                                  covers + (f2 - x), cover);
+                return;
+            }
+        }
+        ren.blend_color_hspan(x, y, len, colors, covers, cover);
+    }
+
     //================================================render_scanline_aa_solid
     template<class Scanline, class BaseRenderer, class ColorT> 
     void render_scanline_aa_solid(const Scanline& sl, 
@@ -37,9 +93,12 @@ namespace agg
             int x = span->x;
             if(span->len > 0)
             {
-                ren.blend_solid_hspan(x, y, (unsigned)span->len, 
-                                      color, 
-                                      span->covers);
+                int full_x1 = 0;
+                int full_len = span_full_cover(*span, &full_x1);
+                blend_solid_hspan_aa(ren, x, y, span->len, 
+                                     color, 
+                                     span->covers,
+                                     full_x1, full_len);
             }
             else
             {
@@ -85,9 +144,12 @@ namespace agg
                     int x = span->x;
                     if(span->len > 0)
                     {
-                        ren.blend_solid_hspan(x, y, (unsigned)span->len, 
-                                              ren_color, 
-                                              span->covers);
+                        int full_x1 = 0;
+                        int full_len = span_full_cover(*span, &full_x1);
+                        blend_solid_hspan_aa(ren, x, y, span->len, 
+                                             ren_color, 
+                                             span->covers,
+                                             full_x1, full_len);
                     }
                     else
                     {
@@ -147,6 +209,65 @@ namespace agg
 
 
 
+    //==========================================================render_span_aa
+    // Renders one span of render_scanline_aa, "covers" is 0 if the cover
+    // is the same for all the pixels. The colors of the span are generated
+    // by one call, the fully covered part is only blended without covers.
+    // The generators that report solid runs (see agg_span_runs.h) are 
+    // rendered by the parts.
+    template<bool Runs> struct render_span_aa
+    {
+        template<class BaseRenderer, class SpanAllocator, 
+                 class SpanGenerator, class CoverT>
+        static void render(BaseRenderer& ren, 
+                           SpanAllocator& alloc, 
+                           SpanGenerator& span_gen,
+                           int x, int y, int len,
+                           const CoverT* covers, CoverT cover,
+                           int full_x1, int full_len)
+        {
+            typename BaseRenderer::color_type* colors = alloc.allocate(len);
+            span_gen.generate(colors, x, y, len);
+            blend_color_hspan_aa(ren, x, y, len, colors, covers, cover, 
+                                 full_x1, full_len);
+        }
+    };
+
+    template<> struct render_span_aa<true>
+    {
+        template<class BaseRenderer, class SpanAllocator, 
+                 class SpanGenerator, class CoverT>
+        static void render(BaseRenderer& ren, 
+                           SpanAllocator& alloc, 
+                           SpanGenerator& span_gen,
+                           int x, int y, int len,
+                           const CoverT* covers, CoverT cover,
+                           int full_x1, int full_len)
+        {
+            typename BaseRenderer::color_type* colors = alloc.allocate(len);
+            do
+            {
+                bool solid = false;
+                int n = span_gen.generate_run(colors, x, y, len, &solid);
+                if(solid)
+                {
+                    if(covers) blend_solid_hspan_aa(ren, x, y, n, *colors, covers, 
+                                                    full_x1, full_len);
+                    else       ren.blend_hline(x, y, x + n - 1, *colors, cover);
+                }
+                else
+                {
+                    blend_color_hspan_aa(ren, x, y, n, colors, covers, cover, 
+                                         full_x1, full_len);
+                }
+                if(covers) covers += n;
+                x   += n;
+                len -= n;
+            }
+            while(len > 0);
+        }
+    };
+
     //======================================================render_scanline_aa
     template<class Scanline, class BaseRenderer, 
              class SpanAllocator, class SpanGenerator> 
@@ -163,11 +284,13 @@ namespace agg
             int len = span->len;
             const typename Scanline::cover_type* covers = span->covers;
 
+            int full_x1 = 0;
+            int full_len = span_full_cover(*span, &full_x1);
             if(len < 0) len = -len;
-            typename BaseRenderer::color_type* colors = alloc.allocate(len);
-            span_gen.generate(colors, x, y, len);
-            ren.blend_color_hspan(x, y, len, colors, 
-                                  (span->len < 0) ? 0 : covers, *covers);
+            render_span_aa<span_generator_runs<SpanGenerator>::enabled != 0>::render(
+                ren, alloc, span_gen, x, y, len,
+                (span->len < 0) ? 0 : covers, *covers,
+                full_x1, full_len);
 
             if(--num_spans == 0) break;
             ++span;
@@ -473,6 +596,68 @@ namespace agg
 
 
 
+    //-----------------------------------------------------render_path_band
+    template<class Rasterizer, class Scanline, class Renderer, 
+             class VertexSource>
+    bool render_path_band(Rasterizer& ras, 
+                          Scanline& sl,
+                          Renderer& ren, 
+                          VertexSource& vs, 
+                          unsigned path_id,
+                          int y1, int y2)
+    {
+        ras.band(y1, y2);
+        ras.add_path(vs, path_id);
+        ras.sort();
+        if(ras.overflow() && y1 < y2)
+        {
+            int ym = y1 + ((y2 - y1) >> 1);
+            bool ok1 = render_path_band(ras, sl, ren, vs, path_id, y1, ym);
+            bool ok2 = render_path_band(ras, sl, ren, vs, path_id, ym + 1, y2);
+            return ok1 && ok2;
+        }
+        render_scanlines(ras, sl, ren);
+        return !ras.overflow();
+    }
+
+    //==================================================render_path_bounded
+    // Renders a path with a rasterizer that has a limited cell budget,
+    // see rasterizer_scanline_aa::max_cells(). If the path doesn't fit
+    // into the budget, its Y-range is split in halves and the path is 
+    // added again for each half with rasterizer_scanline_aa::band(), 
+    // recursively, until every band fits. So, the memory stays bounded 
+    // while the result is the same as with unlimited cells. 
+    // Returns false if a single row alone exceeds the budget, in which 
+    // case it's rendered truncated. The vertex source must be able to 
+    // rewind() more than once.
+    //------------------------------------------------------------------------
+    template<class Rasterizer, class Scanline, class Renderer, 
+             class VertexSource>
+    bool render_path_bounded(Rasterizer& ras, 
+                             Scanline& sl,
+                             Renderer& ren, 
+                             VertexSource& vs, 
+                             unsigned path_id=0)
+    {
+        ras.reset();
+        ras.add_path(vs, path_id);
+        ras.sort();
+        if(ras.overflow() && ras.min_y() < ras.max_y())
+        {
+            int band_y1 = ras.band_min_y();
+            int band_y2 = ras.band_max_y();
+            int y1 = ras.min_y();
+            int y2 = ras.max_y();
+            int ym = y1 + ((y2 - y1) >> 1);
+            bool ok1 = render_path_band(ras, sl, ren, vs, path_id, y1, ym);
+            bool ok2 = render_path_band(ras, sl, ren, vs, path_id, ym + 1, y2);
+            ras.band(band_y1, band_y2);
+            return ok1 && ok2;
+        }
+        render_scanlines(ras, sl, ren);
+        return !ras.overflow();
+    }
+
     //=============================================render_scanlines_compound
     template<class Rasterizer, 
              class ScanlineAA, 
@@ -158,6 +158,80 @@ namespace agg
 
 
 
+    //---------------------------------------------------scanline_compact_aa
+    // The compact serialized format of scanline_storage_aa. All the
+    // integers are variable length (7 bits per byte, the lower first),
+    // the signed ones are zigzag-encoded. The format is:
+    //
+    //     version                     byte, scanline_compact_aa::version
+    //     min_x, min_y, max_x, max_y  signed
+    //     For each scanline:
+    //         y - previous y          unsigned, the first one is from min_y
+    //         num_spans               unsigned
+    //         size of the spans       unsigned, in bytes
+    //         For each span:
+    //             x - previous end    unsigned, the first one is from min_x
+    //             (len << 1) | solid  unsigned
+    //             covers              1 or len values of T as is
+    //
+    // The runs of at least run_min equal covers are written as separate
+    // solid spans.
+    //------------------------------------------------------------------------
+    struct scanline_compact_aa
+    {
+        enum version_e { version = 1 };
+        enum run_min_e { run_min = 8 };
+
+        //--------------------------------------------------------------------
+        // Writes the value if dst isn't null, returns the number of bytes.
+        static unsigned write_uint(int8u* dst, unsigned v)
+        {
+            unsigned n = 1;
+            while(v >= 0x80)
+            {
+                if(dst) *dst++ = int8u(v | 0x80);
+                v >>= 7;
+                ++n;
+            }
+            if(dst) *dst = int8u(v);
+            return n;
+        }
+
+        //--------------------------------------------------------------------
+        static unsigned write_int(int8u* dst, int v)
+        {
+            return write_uint(dst, (unsigned(v) << 1) ^ unsigned(v >> 31));
+        }
+
+        //--------------------------------------------------------------------
+        static AGG_INLINE unsigned read_uint(const int8u*& p)
+        {
+            unsigned v = *p++;
+            if(v < 0x80) return v;
+            v &= 0x7F;
+            unsigned shift = 7;
+            for(;;)
+            {
+                unsigned b = *p++;
+                v |= (b & 0x7F) << shift;
+                if(b < 0x80) return v;
+                shift += 7;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        static int read_int(const int8u*& p)
+        {
+            unsigned v = read_uint(p);
+            return int(v >> 1) ^ -int(v & 1);
+        }
+    };
+
+
+
+
+
+
     //-----------------------------------------------scanline_storage_aa
     template<class T> class scanline_storage_aa
     {
@@ -494,6 +568,21 @@ namespace agg
         }
 
 
+        //---------------------------------------------------------------
+        // The size of the data in the format of scanline_compact_aa,
+        // see serialized_compact_scanlines_adaptor_aa.
+        unsigned byte_size_compact() const
+        {
+            return serialize_compact_impl(0);
+        }
+
+        //---------------------------------------------------------------
+        void serialize_compact(int8u* data) const
+        {
+            serialize_compact_impl(data);
+        }
+
+
         //---------------------------------------------------------------
         const scanline_data& scanline_by_index(unsigned i) const
         {
@@ -513,6 +602,110 @@ namespace agg
         }
 
     private:
+        //---------------------------------------------------------------
+        // Writes the data if "data" isn't null, returns the size.
+        unsigned serialize_compact_impl(int8u* data) const
+        {
+            typedef scanline_compact_aa sc;
+            unsigned size = 1;
+            if(data) *data = int8u(sc::version);
+            size += sc::write_int(data ? data + size : 0, min_x());
+            size += sc::write_int(data ? data + size : 0, min_y());
+            size += sc::write_int(data ? data + size : 0, max_x());
+            size += sc::write_int(data ? data + size : 0, max_y());
+
+            int prev_y = min_y();
+            unsigned i;
+            for(i = 0; i < m_scanlines.size(); ++i)
+            {
+                const scanline_data& sl_this = m_scanlines[i];
+                unsigned num_spans;
+                unsigned spans_size = write_compact_spans(0, sl_this, &num_spans);
+                size += sc::write_uint(data ? data + size : 0, unsigned(sl_this.y - prev_y));
+                size += sc::write_uint(data ? data + size : 0, num_spans);
+                size += sc::write_uint(data ? data + size : 0, spans_size);
+                if(data) write_compact_spans(data + size, sl_this, &num_spans);
+                size += spans_size;
+                prev_y = sl_this.y;
+            }
+            return size;
+        }
+
+        //---------------------------------------------------------------
+        unsigned write_compact_span(int8u* data, unsigned gap, 
+                                    const T* covers, unsigned len, 
+                                    bool solid) const
+        {
+            typedef scanline_compact_aa sc;
+            unsigned size = sc::write_uint(data, gap);
+            size += sc::write_uint(data ? data + size : 0, (len << 1) | unsigned(solid));
+            unsigned n = solid ? sizeof(T) : len * sizeof(T);
+            if(data) memcpy(data + size, covers, n);
+            return size + n;
+        }
+
+        //---------------------------------------------------------------
+        unsigned write_compact_spans(int8u* data, 
+                                     const scanline_data& sl_this,
+                                     unsigned* num_spans) const
+        {
+            unsigned size = 0;
+            int prev_x = min_x();
+            unsigned num = sl_this.num_spans;
+            unsigned span_idx = sl_this.start_span;
+            *num_spans = 0;
+            do
+            {
+                const span_data& sp = m_spans[span_idx++];
+                const T* covers = covers_by_index(sp.covers_id);
+                unsigned gap = unsigned(sp.x - prev_x);
+                if(sp.len < 0)
+                {
+                    size += write_compact_span(data ? data + size : 0, gap, 
+                                               covers, unsigned(-sp.len), true);
+                    ++*num_spans;
+                    prev_x = sp.x - sp.len;
+                    continue;
+                }
+
+                // Split the covers into the runs of equal values and
+                // the rest.
+                unsigned len = unsigned(sp.len);
+                unsigned start = 0;
+                unsigned j = 0;
+                while(j < len)
+                {
+                    unsigned k = j + 1;
+                    while(k < len && covers[k] == covers[j]) ++k;
+                    if(k - j >= unsigned(scanline_compact_aa::run_min))
+                    {
+                        if(j > start)
+                        {
+                            size += write_compact_span(data ? data + size : 0, gap, 
+                                                       covers + start, j - start, false);
+                            ++*num_spans;
+                            gap = 0;
+                        }
+                        size += write_compact_span(data ? data + size : 0, gap, 
+                                                   covers + j, k - j, true);
+                        ++*num_spans;
+                        gap = 0;
+                        start = k;
+                    }
+                    j = k;
+                }
+                if(len > start)
+                {
+                    size += write_compact_span(data ? data + size : 0, gap, 
+                                               covers + start, len - start, false);
+                    ++*num_spans;
+                }
+                prev_x = sp.x + sp.len;
+            }
+            while(--num);
+            return size;
+        }
+
         scanline_cell_storage<T>      m_covers;
         pod_bvector<span_data, 10>    m_spans;
         pod_bvector<scanline_data, 8> m_scanlines;
@@ -808,6 +1001,260 @@ namespace agg
     typedef serialized_scanlines_adaptor_aa<int16u> serialized_scanlines_adaptor_aa16; //----serialized_scanlines_adaptor_aa16
     typedef serialized_scanlines_adaptor_aa<int32u> serialized_scanlines_adaptor_aa32; //----serialized_scanlines_adaptor_aa32
 
+
+
+
+    //----------------------------------serialized_compact_scanlines_adaptor_aa
+    // Reads the data written by scanline_storage_aa::serialize_compact()
+    // in place, the same way as serialized_scanlines_adaptor_aa. The data
+    // of another version produce no scanlines.
+    //------------------------------------------------------------------------
+    template<class T> class serialized_compact_scanlines_adaptor_aa
+    {
+    public:
+        typedef T cover_type;
+
+        //---------------------------------------------------------------------
+        class embedded_scanline
+        {
+        public:
+            typedef T cover_type;
+
+            //-----------------------------------------------------------------
+            class const_iterator
+            {
+            public:
+                struct span
+                {
+                    int32    x;
+                    int32    len; // If negative, it's a solid span, "covers" is valid
+                    const T* covers; 
+                };
+
+                const_iterator() : m_ptr(0) {}
+                const_iterator(const embedded_scanline& sl) :
+                    m_ptr(sl.m_ptr),
+                    m_x(sl.m_x)
+                {
+                    init_span();
+                }
+
+                const span& operator*()  const { return m_span;  }
+                const span* operator->() const { return &m_span; }
+
+                void operator ++ ()
+                {
+                    init_span();
+                }
+
+            private:
+                void init_span()
+                {
+                    m_span.x = m_x + int(scanline_compact_aa::read_uint(m_ptr));
+                    unsigned v = scanline_compact_aa::read_uint(m_ptr);
+                    int len = int(v >> 1);
+                    m_span.covers = (const T*)m_ptr;
+                    if(v & 1)
+                    {
+                        m_span.len = -len;
+                        m_ptr += sizeof(T);
+                    }
+                    else
+                    {
+                        m_span.len = len;
+                        m_ptr += len * sizeof(T);
+                    }
+                    m_x = m_span.x + len;
+                }
+
+                const int8u* m_ptr;
+                span         m_span;
+                int          m_x;
+            };
+
+            friend class const_iterator;
+
+
+            //-----------------------------------------------------------------
+            embedded_scanline() : m_ptr(0), m_y(0), m_num_spans(0), m_x(0) {}
+
+            //-----------------------------------------------------------------
+            void     reset(int, int)     {}
+            unsigned num_spans()   const { return m_num_spans;  }
+            int      y()           const { return m_y;          }
+            const_iterator begin() const { return const_iterator(*this); }
+
+            //-----------------------------------------------------------------
+            void init(const int8u* ptr, int y, unsigned num_spans, int x)
+            {
+                m_ptr       = ptr;
+                m_y         = y;
+                m_num_spans = num_spans;
+                m_x         = x;
+            }
+
+        private:
+            const int8u* m_ptr;
+            int          m_y;
+            unsigned     m_num_spans;
+            int          m_x;
+        };
+
+
+
+    public:
+        //--------------------------------------------------------------------
+        serialized_compact_scanlines_adaptor_aa() :
+            m_data(0),
+            m_end(0),
+            m_ptr(0),
+            m_dx(0),
+            m_dy(0),
+            m_y(0),
+            m_min_x(0x7FFFFFFF),
+            m_min_y(0x7FFFFFFF),
+            m_max_x(-0x7FFFFFFF),
+            m_max_y(-0x7FFFFFFF)
+        {}
+
+        //--------------------------------------------------------------------
+        serialized_compact_scanlines_adaptor_aa(const int8u* data, unsigned size,
+                                                double dx, double dy) :
+            m_data(data),
+            m_end(data + size),
+            m_ptr(data),
+            m_dx(iround(dx)),
+            m_dy(iround(dy)),
+            m_y(0),
+            m_min_x(0x7FFFFFFF),
+            m_min_y(0x7FFFFFFF),
+            m_max_x(-0x7FFFFFFF),
+            m_max_y(-0x7FFFFFFF)
+        {}
+
+        //--------------------------------------------------------------------
+        void init(const int8u* data, unsigned size, double dx, double dy)
+        {
+            m_data  = data;
+            m_end   = data + size;
+            m_ptr   = data;
+            m_dx    = iround(dx);
+            m_dy    = iround(dy);
+            m_y     = 0;
+            m_min_x = 0x7FFFFFFF;
+            m_min_y = 0x7FFFFFFF;
+            m_max_x = -0x7FFFFFFF;
+            m_max_y = -0x7FFFFFFF;
+        }
+
+        // Iterate scanlines interface
+        //--------------------------------------------------------------------
+        bool rewind_scanlines()
+        {
+            m_ptr = m_data;
+            if(m_ptr < m_end)
+            {
+                if(*m_ptr++ != int8u(scanline_compact_aa::version))
+                {
+                    m_ptr = m_end;
+                    return false;
+                }
+                m_min_x = scanline_compact_aa::read_int(m_ptr) + m_dx; 
+                m_min_y = scanline_compact_aa::read_int(m_ptr) + m_dy;
+                m_max_x = scanline_compact_aa::read_int(m_ptr) + m_dx;
+                m_max_y = scanline_compact_aa::read_int(m_ptr) + m_dy;
+                m_y     = m_min_y;
+            }
+            return m_ptr < m_end;
+        }
+
+        //--------------------------------------------------------------------
+        int min_x() const { return m_min_x; }
+        int min_y() const { return m_min_y; }
+        int max_x() const { return m_max_x; }
+        int max_y() const { return m_max_y; }
+
+        //--------------------------------------------------------------------
+        template<class Scanline> bool sweep_scanline(Scanline& sl)
+        {
+            sl.reset_spans();
+            for(;;)
+            {
+                if(m_ptr >= m_end) return false;
+
+                m_y += int(scanline_compact_aa::read_uint(m_ptr));
+                unsigned num_spans = scanline_compact_aa::read_uint(m_ptr);
+                scanline_compact_aa::read_uint(m_ptr); // Skip the size
+                int x = m_min_x;
+
+                do
+                {
+                    x += int(scanline_compact_aa::read_uint(m_ptr));
+                    unsigned v = scanline_compact_aa::read_uint(m_ptr);
+                    unsigned len = v >> 1;
+
+                    if(v & 1)
+                    {
+                        sl.add_span(x, len, *(const T*)m_ptr);
+                        m_ptr += sizeof(T);
+                    }
+                    else
+                    {
+                        sl.add_cells(x, len, (const T*)m_ptr);
+                        m_ptr += len * sizeof(T);
+                    }
+                    x += int(len);
+                }
+                while(--num_spans);
+
+                if(sl.num_spans())
+                {
+                    sl.finalize(m_y);
+                    break;
+                }
+            }
+            return true;
+        }
+
+
+        //--------------------------------------------------------------------
+        // Specialization for embedded_scanline
+        bool sweep_scanline(embedded_scanline& sl)
+        {
+            unsigned num_spans;
+            do
+            {
+                if(m_ptr >= m_end) return false;
+
+                m_y += int(scanline_compact_aa::read_uint(m_ptr));
+                num_spans = scanline_compact_aa::read_uint(m_ptr);
+                unsigned size = scanline_compact_aa::read_uint(m_ptr);
+                sl.init(m_ptr, m_y, num_spans, m_min_x);
+                m_ptr += size;
+            }
+            while(num_spans == 0);
+            return true;
+        }
+
+    private:
+        const int8u* m_data;
+        const int8u* m_end;
+        const int8u* m_ptr;
+        int          m_dx;
+        int          m_dy;
+        int          m_y;
+        int          m_min_x;
+        int          m_min_y;
+        int          m_max_x;
+        int          m_max_y;
+    };
+
+
+
+    typedef serialized_compact_scanlines_adaptor_aa<int8u>  serialized_compact_scanlines_adaptor_aa8;  //----serialized_compact_scanlines_adaptor_aa8
+    typedef serialized_compact_scanlines_adaptor_aa<int16u> serialized_compact_scanlines_adaptor_aa16; //----serialized_compact_scanlines_adaptor_aa16
+    typedef serialized_compact_scanlines_adaptor_aa<int32u> serialized_compact_scanlines_adaptor_aa32; //----serialized_compact_scanlines_adaptor_aa32
+
 }
 
 
@@ -28,6 +28,11 @@
 
 namespace agg
 {
+    enum scanline_full_span_e
+    {
+        scanline_full_span_min = 16  //----scanline_full_span_min
+    };
+
     //=============================================================scanline_u8
     //
     // Unpacked scanline container class
@@ -99,6 +104,13 @@ namespace agg
     // while(--num_spans);  // num_spans cannot be 0, so this loop is quite safe
     //------------------------------------------------------------------------
     //
+    // Every span also keeps the longest fully covered run of at least 
+    // scanline_full_span_min pixels added by add_span() (the interior of 
+    // the shape) in full_x1 and full_len, or full_len is 0. Its covers are
+    // all cover_full, so the renderers can fill it without looking at 
+    // them, see span_full_cover(). The spans themselves are the same.
+    //------------------------------------------------------------------------
+    //
     // The question is: why should we accumulate the whole scanline when we
     // could render just separate spans when they're ready?
     // That's because using the scanline is generally faster. When is consists 
@@ -119,6 +131,8 @@ namespace agg
             coord_type  x;
             coord_type  len;
             cover_type* covers;
+            coord_type  full_x1;
+            coord_type  full_len;
         };
 
         typedef span* iterator;
@@ -160,6 +174,7 @@ namespace agg
                 m_cur_span->x      = (coord_type)(x + m_min_x);
                 m_cur_span->len    = 1;
                 m_cur_span->covers = &m_covers[x];
+                m_cur_span->full_len = 0;
             }
             m_last_x = x;
         }
@@ -179,6 +194,7 @@ namespace agg
                 m_cur_span->x      = (coord_type)(x + m_min_x);
                 m_cur_span->len    = (coord_type)len;
                 m_cur_span->covers = &m_covers[x];
+                m_cur_span->full_len = 0;
             }
             m_last_x = x + len - 1;
         }
@@ -198,6 +214,14 @@ namespace agg
                 m_cur_span->x      = (coord_type)(x + m_min_x);
                 m_cur_span->len    = (coord_type)len;
                 m_cur_span->covers = &m_covers[x];
+                m_cur_span->full_len = 0;
+            }
+            if(cover == cover_full && 
+               len >= scanline_full_span_min && 
+               int(len) > m_cur_span->full_len)
+            {
+                m_cur_span->full_x1  = (coord_type)(x + m_min_x);
+                m_cur_span->full_len = (coord_type)len;
             }
             m_last_x = x + len - 1;
         }
@@ -268,6 +292,7 @@ namespace agg
                                                 base_type::y(), 
                                                 span->covers, 
                                                 span->len);
+                    span->full_len = 0;
                     ++span;
                 }
                 while(--count);
@@ -294,11 +319,13 @@ namespace agg
         {
             span() {}
             span(coord_type x_, coord_type len_, cover_type* covers_) :
-                x(x_), len(len_), covers(covers_) {}
+                x(x_), len(len_), covers(covers_), full_x1(0), full_len(0) {}
 
             coord_type  x;
             coord_type  len;
             cover_type* covers;
+            coord_type  full_x1;
+            coord_type  full_len;
         };
 
         typedef pod_bvector<span, 4> span_array_type;
@@ -412,6 +439,14 @@ namespace agg
                                  coord_type(len), 
                                  &m_covers[x]));
             }
+            span& sp = m_spans.last();
+            if(cover == cover_full && 
+               len >= scanline_full_span_min && 
+               int(len) > sp.full_len)
+            {
+                sp.full_x1  = coord_type(x + m_min_x);
+                sp.full_len = coord_type(len);
+            }
             m_last_x = x + len - 1;
         }
 
@@ -481,6 +516,7 @@ namespace agg
                                                 base_type::y(), 
                                                 span->covers, 
                                                 span->len);
+                    span->full_len = 0;
                     ++span;
                 }
                 while(--count);
@@ -493,6 +529,20 @@ namespace agg
 
 
 
+
+    //=========================================================span_full_cover
+    inline unsigned span_full_cover(const scanline_u8::span& span, int* x1) 
+    { 
+        *x1 = span.full_x1;
+        return unsigned(span.full_len); 
+    }
+
+    inline unsigned span_full_cover(const scanline32_u8::span& span, int* x1) 
+    { 
+        *x1 = span.full_x1;
+        return unsigned(span.full_len); 
+    }
+
 }
 
 #endif
@@ -0,0 +1,405 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Cache of rasterized shapes. The scanlines of a shape are stored in the
+// serialized form of scanline_storage_aa and replayed through
+// serialized_scanlines_adaptor_aa when the same shape is drawn again,
+// for example, in the next frame.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_SHAPE_CACHE_INCLUDED
+#define AGG_SHAPE_CACHE_INCLUDED
+
+#include <math.h>
+#include <string.h>
+#include "agg_array.h"
+#include "agg_bounding_rect.h"
+#include "agg_trans_affine.h"
+#include "agg_conv_transform.h"
+#include "agg_scanline_p.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_renderer_scanline.h"
+
+namespace agg
+{
+
+    //---------------------------------------------------------shape_cache_key
+    // Everything that affects the result of the rasterization, except for
+    // the clipping box, see shape_cache. The matrix has only the fractional
+    // part of the translation (in subpixels), the integer part is applied
+    // when the shape is replayed. The filling rule, auto_close() and the
+    // gamma table are taken from the rasterizer, the table is kept as its
+    // hash. The band and the cell budget of the rasterizer are not, they
+    // must not be set.
+    //------------------------------------------------------------------------
+    struct shape_cache_key
+    {
+        unsigned path_id;
+        double   sx, shy, shx, sy, tx, ty;
+        unsigned filling_rule;
+        unsigned auto_close;
+        unsigned gamma;
+
+        //--------------------------------------------------------------------
+        bool operator == (const shape_cache_key& k) const
+        {
+            return path_id == k.path_id &&
+                   sx == k.sx  && shy == k.shy && shx == k.shx &&
+                   sy == k.sy  && tx  == k.tx  && ty  == k.ty  &&
+                   filling_rule == k.filling_rule &&
+                   auto_close == k.auto_close &&
+                   gamma == k.gamma;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned hash() const
+        {
+            // FNV-1a over the values. Adding 0.0 turns -0.0 into 0.0,
+            // so that the equal keys have the same hash.
+            double d[6] = { sx + 0.0, shy + 0.0, shx + 0.0, sy + 0.0,
+                            tx + 0.0, ty + 0.0 };
+            unsigned u[4] = { path_id, filling_rule, auto_close, gamma };
+            unsigned h = 2166136261u;
+            h = hash_bytes(h, (const int8u*)d, sizeof(d));
+            h = hash_bytes(h, (const int8u*)u, sizeof(u));
+            return h;
+        }
+
+        //--------------------------------------------------------------------
+        template<class Rasterizer>
+        static unsigned gamma_hash(const Rasterizer& ras)
+        {
+            unsigned h = 2166136261u;
+            unsigned i;
+            for(i = 0; i <= unsigned(Rasterizer::aa_mask); i++)
+            {
+                h = (h ^ ras.apply_gamma(i)) * 16777619u;
+            }
+            return h;
+        }
+
+    private:
+        static unsigned hash_bytes(unsigned h, const int8u* p, unsigned len)
+        {
+            while(len--) h = (h ^ *p++) * 16777619u;
+            return h;
+        }
+    };
+
+
+    //-------------------------------------------------------------shape_cache
+    // Stores the rasterized shapes keyed by shape_cache_key and keeps the
+    // total size of their data, byte_size() of scanline_storage_aa plus
+    // sizeof(shape), within the budget, removing the least recently used
+    // shapes.
+    //
+    // The shape is identified by "path_id", which is also passed to
+    // add_path() of the rasterizer, so, a cache serves one vertex source
+    // (the ids must be unique). The shapes that differ only in the integer
+    // part of the translation share the same data, they are not
+    // rasterized again. The fractional part of the translation is rounded
+    // to subpixels, so, the result can slightly differ from the shape
+    // rasterized exactly in its place.
+    //
+    //     agg::shape_cache cache(4 * 1024 * 1024);
+    //     . . .
+    //     cache.render(ras, sl, ren, path, path_id, mtx, clip);
+    //
+    // The clipping box of the rasterizer is replaced with "clip". A shape
+    // that was entirely inside the clipping box is replayed with any
+    // other box that contains it, the clipped one only with the same box
+    // (relative to the integer translation), otherwise it's rasterized
+    // again. The renderer clips the replayed scanlines anyway, so "clip"
+    // can be anything that contains the visible part of the shape, for
+    // example, the whole window.
+    //------------------------------------------------------------------------
+    class shape_cache
+    {
+    public:
+        typedef scanline_storage_aa8              storage_type;
+        typedef serialized_scanlines_adaptor_aa8  adaptor_type;
+
+        //--------------------------------------------------------------------
+        struct shape
+        {
+            shape_cache_key key;
+            unsigned        hash;
+            rect_i          clip;       // Relative to the translation
+            rect_i          bounds;     // The same, invalid if clipped
+            int8u*          data;
+            unsigned        data_size;
+            shape*          next;       // In the hash bucket
+            shape*          lru_prev;   // More recently used
+            shape*          lru_next;   // Less recently used
+        };
+
+        //--------------------------------------------------------------------
+        ~shape_cache()
+        {
+            remove_all();
+            pod_allocator<shape*>::deallocate(m_buckets, m_num_buckets);
+        }
+
+        //--------------------------------------------------------------------
+        shape_cache(unsigned max_bytes = 16*1024*1024) :
+            m_buckets(pod_allocator<shape*>::allocate(initial_buckets)),
+            m_num_buckets(initial_buckets),
+            m_num_shapes(0),
+            m_bytes(0),
+            m_max_bytes(max_bytes),
+            m_lru_first(0),
+            m_lru_last(0),
+            m_hits(0),
+            m_misses(0)
+        {
+            memset(m_buckets, 0, sizeof(shape*) * m_num_buckets);
+        }
+
+        //--------------------------------------------------------------------
+        void max_bytes(unsigned v) { m_max_bytes = v; evict(0); }
+        unsigned max_bytes()  const { return m_max_bytes; }
+        unsigned bytes()      const { return m_bytes; }
+        unsigned num_shapes() const { return m_num_shapes; }
+        unsigned hits()       const { return m_hits; }
+        unsigned misses()     const { return m_misses; }
+
+        //--------------------------------------------------------------------
+        void remove_all()
+        {
+            while(m_lru_first) remove(m_lru_first);
+        }
+
+        //--------------------------------------------------------------------
+        // Returns the scanlines of the shape translated to its place,
+        // rasterizing the shape if it's not in the cache. The adaptor is
+        // valid until the next call.
+        //--------------------------------------------------------------------
+        template<class Rasterizer, class VertexSource>
+        adaptor_type& scanlines(Rasterizer& ras,
+                                VertexSource& vs, unsigned path_id,
+                                const trans_affine& mtx,
+                                const rect_i& clip)
+        {
+            int tx = iround(mtx.tx * poly_subpixel_scale);
+            int ty = iround(mtx.ty * poly_subpixel_scale);
+            int dx = tx >> poly_subpixel_shift;
+            int dy = ty >> poly_subpixel_shift;
+
+            shape_cache_key key;
+            key.path_id      = path_id;
+            key.sx           = mtx.sx;
+            key.shy          = mtx.shy;
+            key.shx          = mtx.shx;
+            key.sy           = mtx.sy;
+            key.tx           = double(tx & poly_subpixel_mask) / poly_subpixel_scale;
+            key.ty           = double(ty & poly_subpixel_mask) / poly_subpixel_scale;
+            key.filling_rule = ras.filling_rule();
+            key.auto_close   = ras.auto_close();
+            key.gamma        = shape_cache_key::gamma_hash(ras);
+            rect_i rel_clip(clip.x1 - dx, clip.y1 - dy, clip.x2 - dx, clip.y2 - dy);
+
+            shape* s = find(key);
+            if(s && fits(s, rel_clip))
+            {
+                ++m_hits;
+                touch(s);
+            }
+            else
+            {
+                ++m_misses;
+                if(s) remove(s);
+                s = rasterize(ras, vs, key, rel_clip);
+            }
+            m_adaptor.init(s->data, s->data_size, dx, dy);
+            return m_adaptor;
+        }
+
+        //--------------------------------------------------------------------
+        template<class Rasterizer, class Scanline, class Renderer, class VertexSource>
+        void render(Rasterizer& ras, Scanline& sl, Renderer& ren,
+                    VertexSource& vs, unsigned path_id,
+                    const trans_affine& mtx,
+                    const rect_i& clip)
+        {
+            render_scanlines(scanlines(ras, vs, path_id, mtx, clip),
+                             sl, ren);
+        }
+
+    private:
+        shape_cache(const shape_cache&);
+        const shape_cache& operator = (const shape_cache&);
+
+        enum initial_buckets_e { initial_buckets = 256 };
+
+        //--------------------------------------------------------------------
+        shape* find(const shape_cache_key& key) const
+        {
+            unsigned h = key.hash();
+            shape* s = m_buckets[h & (m_num_buckets - 1)];
+            while(s)
+            {
+                if(s->hash == h && s->key == key) return s;
+                s = s->next;
+            }
+            return 0;
+        }
+
+        //--------------------------------------------------------------------
+        // True if the shape rasterized with the clipping box "clip" would
+        // be the same. The bounds of the vertices are kept only if they are
+        // inside the box the shape was rasterized with, so, the clipping
+        // didn't change anything. The bounds of the scanlines can't tell
+        // it, the parts clipped entirely produce no cells at all.
+        static bool fits(const shape* s, const rect_i& clip)
+        {
+            if(s->bounds.is_valid())
+            {
+                return s->bounds.x1 > clip.x1 && s->bounds.y1 > clip.y1 &&
+                       s->bounds.x2 < clip.x2 && s->bounds.y2 < clip.y2;
+            }
+            return s->clip.x1 == clip.x1 && s->clip.y1 == clip.y1 &&
+                   s->clip.x2 == clip.x2 && s->clip.y2 == clip.y2;
+        }
+
+        //--------------------------------------------------------------------
+        template<class Rasterizer, class VertexSource>
+        shape* rasterize(Rasterizer& ras, VertexSource& vs,
+                         const shape_cache_key& key,
+                         const rect_i& clip)
+        {
+            trans_affine mtx(key.sx, key.shy, key.shx, key.sy, key.tx, key.ty);
+            conv_transform<VertexSource> trans(vs, mtx);
+            double x1, y1, x2, y2;
+            bool has_vertices = 
+                bounding_rect_single(trans, key.path_id, &x1, &y1, &x2, &y2);
+            ras.reset();
+            ras.clip_box(clip.x1, clip.y1, clip.x2, clip.y2);
+            ras.add_path(trans, key.path_id);
+            m_storage.prepare(); // render_scanlines() doesn't if it's empty
+            render_scanlines(ras, m_sl, m_storage);
+
+            shape* s = obj_allocator<shape>::allocate();
+            s->key       = key;
+            s->hash      = key.hash();
+            s->clip      = clip;
+            s->bounds    = rect_i(1, 1, 0, 0);
+            if(has_vertices)
+            {
+                s->bounds = rect_i(int(floor(x1)), int(floor(y1)),
+                                   int(ceil(x2)),  int(ceil(y2)));
+                if(!fits(s, clip)) s->bounds = rect_i(1, 1, 0, 0);
+            }
+            s->data      = 0;
+            s->data_size = 0;
+            if(m_storage.rewind_scanlines())
+            {
+                // Empty shapes have no data, the adaptor produces nothing
+                s->data_size = m_storage.byte_size();
+                s->data      = pod_allocator<int8u>::allocate(s->data_size);
+                m_storage.serialize(s->data);
+            }
+
+            if(m_num_shapes >= m_num_buckets * 2) rehash(m_num_buckets * 2);
+            shape** bucket = m_buckets + (s->hash & (m_num_buckets - 1));
+            s->next = *bucket;
+            *bucket = s;
+            s->lru_prev = 0;
+            s->lru_next = m_lru_first;
+            if(m_lru_first) m_lru_first->lru_prev = s;
+            else            m_lru_last = s;
+            m_lru_first = s;
+            ++m_num_shapes;
+            m_bytes += s->data_size + sizeof(shape);
+            evict(s);
+            return s;
+        }
+
+        //--------------------------------------------------------------------
+        void touch(shape* s)
+        {
+            if(s == m_lru_first) return;
+            s->lru_prev->lru_next = s->lru_next;
+            if(s->lru_next) s->lru_next->lru_prev = s->lru_prev;
+            else            m_lru_last = s->lru_prev;
+            s->lru_prev = 0;
+            s->lru_next = m_lru_first;
+            m_lru_first->lru_prev = s;
+            m_lru_first = s;
+        }
+
+        //--------------------------------------------------------------------
+        // Removes the least recently used shapes until the data fit
+        // the budget, except for "keep".
+        void evict(const shape* keep)
+        {
+            while(m_bytes > m_max_bytes && m_lru_last && m_lru_last != keep)
+            {
+                remove(m_lru_last);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        void remove(shape* s)
+        {
+            shape** p = m_buckets + (s->hash & (m_num_buckets - 1));
+            while(*p != s) p = &(*p)->next;
+            *p = s->next;
+
+            if(s->lru_prev) s->lru_prev->lru_next = s->lru_next;
+            else            m_lru_first = s->lru_next;
+            if(s->lru_next) s->lru_next->lru_prev = s->lru_prev;
+            else            m_lru_last = s->lru_prev;
+
+            m_bytes -= s->data_size + sizeof(shape);
+            --m_num_shapes;
+            pod_allocator<int8u>::deallocate(s->data, s->data_size);
+            obj_allocator<shape>::deallocate(s);
+        }
+
+        //--------------------------------------------------------------------
+        void rehash(unsigned num_buckets)
+        {
+            shape** buckets = pod_allocator<shape*>::allocate(num_buckets);
+            memset(buckets, 0, sizeof(shape*) * num_buckets);
+            shape* s;
+            for(s = m_lru_first; s; s = s->lru_next)
+            {
+                shape** bucket = buckets + (s->hash & (num_buckets - 1));
+                s->next = *bucket;
+                *bucket = s;
+            }
+            pod_allocator<shape*>::deallocate(m_buckets, m_num_buckets);
+            m_buckets     = buckets;
+            m_num_buckets = num_buckets;
+        }
+
+        shape**      m_buckets;
+        unsigned     m_num_buckets;
+        unsigned     m_num_shapes;
+        unsigned     m_bytes;
+        unsigned     m_max_bytes;
+        shape*       m_lru_first;
+        shape*       m_lru_last;
+        unsigned     m_hits;
+        unsigned     m_misses;
+        scanline_p8  m_sl;
+        storage_type m_storage;
+        adaptor_type m_adaptor;
+    };
+
+}
+
+#endif
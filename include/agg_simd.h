@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// SIMD support. AGG_SIMD_SSE2 is defined when the compiler generates
+// SSE2 code, which is always the case on x86-64. Define AGG_NO_SIMD
+// to use the plain C++ code everywhere.
+//
+// The helpers below work with 8-bit pixels unpacked to 16-bit lanes,
+// 2 pixels of 4 components per __m128i.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_SIMD_INCLUDED
+#define AGG_SIMD_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+
+#ifndef AGG_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SIMD_SSE2
+#endif
+#endif
+
+#ifdef AGG_SIMD_SSE2
+#include <emmintrin.h>
+
+namespace agg
+{
+
+    //-------------------------------------------------------------sse2_load4
+    // Loads 4 bytes, the rest of the register is zero.
+    AGG_INLINE __m128i sse2_load4(const int8u* p)
+    {
+        int32 v;
+        memcpy(&v, p, 4);
+        return _mm_cvtsi32_si128(v);
+    }
+
+    //-----------------------------------------------------------sse2_unpack
+    // 4 pixels of 8-bit components to two registers of 16-bit lanes.
+    AGG_INLINE __m128i sse2_unpack_lo(__m128i v)
+    {
+        return _mm_unpacklo_epi8(v, _mm_setzero_si128());
+    }
+
+    AGG_INLINE __m128i sse2_unpack_hi(__m128i v)
+    {
+        return _mm_unpackhi_epi8(v, _mm_setzero_si128());
+    }
+
+    //-------------------------------------------------------------sse2_pack
+    // The reverse of sse2_unpack. The lanes are truncated to 8 bits, the
+    // same way as the (int8u) cast does in the plain C++ code.
+    AGG_INLINE __m128i sse2_pack(__m128i lo, __m128i hi)
+    {
+        __m128i m = _mm_set1_epi16(0xFF);
+        return _mm_packus_epi16(_mm_and_si128(lo, m), _mm_and_si128(hi, m));
+    }
+
+    //--------------------------------------------------------sse2_expand4
+    // Expands 4 bytes (covers) to 16, each one repeated 4 times, that is,
+    // one per pixel component.
+    AGG_INLINE __m128i sse2_expand4(__m128i v)
+    {
+        v = _mm_unpacklo_epi8(v, v);
+        return _mm_unpacklo_epi16(v, v);
+    }
+
+    //------------------------------------------------------sse2_broadcast
+    // Copies 16-bit lane I of each pixel to all its components.
+    template<int I> AGG_INLINE __m128i sse2_broadcast(__m128i v)
+    {
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(I, I, I, I));
+        return _mm_shufflehi_epi16(v, _MM_SHUFFLE(I, I, I, I));
+    }
+
+    //-----------------------------------------------------------sse2_lane
+    // A mask with all bits set in 16-bit lane I of each pixel.
+    template<int I> AGG_INLINE __m128i sse2_lane()
+    {
+        return _mm_cmpeq_epi16(_mm_set_epi16(3, 2, 1, 0, 3, 2, 1, 0),
+                               _mm_set1_epi16(I));
+    }
+
+    //---------------------------------------------------------sse2_select
+    // mask ? a : b, bitwise.
+    AGG_INLINE __m128i sse2_select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    //-----------------------------------------------------------sse2_mul8
+    // (a * b) >> 8 for 16-bit lanes, the product must fit 16 bits.
+    AGG_INLINE __m128i sse2_mul8(__m128i a, __m128i b)
+    {
+        return _mm_srli_epi16(_mm_mullo_epi16(a, b), 8);
+    }
+
+    //---------------------------------------------------------sse2_mul255
+    // (a * b + 255) >> 8 for 16-bit lanes, the product must fit 16 bits.
+    AGG_INLINE __m128i sse2_mul255(__m128i a, __m128i b)
+    {
+        return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, b), 
+                                            _mm_set1_epi16(255)), 8);
+    }
+
+    //-----------------------------------------------------------sse2_dot8
+    // (a * b + c * d + e + 255) >> 8 with a 32-bit intermediate sum.
+    // a, b, c, d are signed 16-bit, e is unsigned 16-bit, the result
+    // must fit 15 bits.
+    AGG_INLINE __m128i sse2_dot8(__m128i a, __m128i b, 
+                                 __m128i c, __m128i d, 
+                                 __m128i e)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i k = _mm_set1_epi32(255);
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, c), _mm_unpacklo_epi16(b, d));
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, c), _mm_unpackhi_epi16(b, d));
+        lo = _mm_add_epi32(lo, _mm_add_epi32(_mm_unpacklo_epi16(e, zero), k));
+        hi = _mm_add_epi32(hi, _mm_add_epi32(_mm_unpackhi_epi16(e, zero), k));
+        return _mm_packs_epi32(_mm_srli_epi32(lo, 8), _mm_srli_epi32(hi, 8));
+    }
+
+    //-------------------------------------------------------sse2_min_epu16
+    // SSE2 has only the signed 16-bit min/max.
+    AGG_INLINE __m128i sse2_min_epu16(__m128i a, __m128i b)
+    {
+        return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+    }
+
+    AGG_INLINE __m128i sse2_max_epu16(__m128i a, __m128i b)
+    {
+        return _mm_add_epi16(b, _mm_subs_epu16(a, b));
+    }
+
+    //-----------------------------------------------------sse2_mullo_epi32
+    // The low 32 bits of the products of 32-bit lanes. SSE2 multiplies 
+    // only the even lanes, 32x32->64 bits.
+    AGG_INLINE __m128i sse2_mullo_epi32(__m128i a, __m128i b)
+    {
+        __m128i p02 = _mm_mul_epu32(a, b);
+        __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(p02, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(p13, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    //-----------------------------------------------------sse2_min_epu32
+    // SSE2 has only the signed 32-bit compare.
+    AGG_INLINE __m128i sse2_min_epu32(__m128i a, __m128i b)
+    {
+        __m128i bias = _mm_set1_epi32(int(0x80000000));
+        __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+        return sse2_select(gt, b, a);
+    }
+
+    //------------------------------------------------------sse2_order_rgba
+    // The shuffle that converts the components of a 16-bit rgba8 to
+    // the Order of a pixel format (order_rgba, order_bgra and so on).
+    template<class Order> struct sse2_order_rgba
+    {
+        enum shuffle_e
+        {
+            shuffle = (0 << (Order::R * 2)) |
+                      (1 << (Order::G * 2)) |
+                      (2 << (Order::B * 2)) |
+                      (3 << (Order::A * 2))
+        };
+
+        static AGG_INLINE __m128i apply(__m128i v)
+        {
+            v = _mm_shufflelo_epi16(v, shuffle);
+            return _mm_shufflehi_epi16(v, shuffle);
+        }
+    };
+
+}
+
+#endif
+
+#endif
@@ -22,6 +22,8 @@
 #include "agg_basics.h"
 #include "agg_math.h"
 #include "agg_array.h"
+#include "agg_simd.h"
+#include "agg_span_runs.h"
 
 
 namespace agg
@@ -359,6 +361,366 @@ namespace agg
     };
 
 
+    //===================================================gradient_affine_kind
+    // The gradient functions span_gradient_affine works with. The value
+    // of gradient_x and gradient_y is linear along the span, the radial
+    // ones are the distance from the origin.
+    enum gradient_affine_kind_e
+    {
+        gradient_affine_x,
+        gradient_affine_y,
+        gradient_affine_radial
+    };
+
+    template<class GradientF> struct gradient_affine_kind;
+
+    template<> struct gradient_affine_kind<gradient_x>
+    {
+        enum kind_e { kind = gradient_affine_x };
+    };
+
+    template<> struct gradient_affine_kind<gradient_y>
+    {
+        enum kind_e { kind = gradient_affine_y };
+    };
+
+    template<> struct gradient_affine_kind<gradient_radial>
+    {
+        enum kind_e { kind = gradient_affine_radial };
+    };
+
+    template<> struct gradient_affine_kind<gradient_radial_d>
+    {
+        enum kind_e { kind = gradient_affine_radial };
+    };
+
+    template<> struct gradient_affine_kind<gradient_circle>
+    {
+        enum kind_e { kind = gradient_affine_radial };
+    };
+
+
+
+    //===================================================span_gradient_affine
+    // The same as span_gradient for the affine transformations only, that 
+    // is, span_interpolator_linear or span_interpolator_linear_subdiv with
+    // trans_affine, and gradient_x, gradient_y or the radial gradients.
+    // The coordinates are linear along the span, so the start point and 
+    // the step are calculated once per span with the transformer of the
+    // interpolator, and the division by (d2-d1) becomes a multiplication.
+    // For gradient_x and gradient_y the color index is stepped in fixed 
+    // point, the pixels out of the range of the color function are just 
+    // filled with its end colors. For the radial gradients the distance 
+    // is calculated with sqrt, 4 pixels at once with SSE2. The index can 
+    // differ by one from the one of span_gradient, which rounds the 
+    // coordinates to the gradient subpixels (and uses the approximate 
+    // fast_sqrt for gradient_radial).
+    template<class ColorT,
+             class Interpolator,
+             class GradientF, 
+             class ColorF>
+    class span_gradient_affine
+    {
+    public:
+        typedef Interpolator interpolator_type;
+        typedef ColorT color_type;
+
+        enum block_size_e { block_size = 64 };
+
+        //--------------------------------------------------------------------
+        span_gradient_affine() {}
+
+        //--------------------------------------------------------------------
+        span_gradient_affine(interpolator_type& inter,
+                             const GradientF& gradient_function,
+                             const ColorF& color_function,
+                             double d1, double d2) : 
+            m_interpolator(&inter),
+            m_gradient_function(&gradient_function),
+            m_color_function(&color_function),
+            m_d1(iround(d1 * gradient_subpixel_scale)),
+            m_d2(iround(d2 * gradient_subpixel_scale))
+        {}
+
+        //--------------------------------------------------------------------
+        interpolator_type& interpolator() { return *m_interpolator; }
+        const GradientF& gradient_function() const { return *m_gradient_function; }
+        const ColorF& color_function() const { return *m_color_function; }
+        double d1() const { return double(m_d1) / gradient_subpixel_scale; }
+        double d2() const { return double(m_d2) / gradient_subpixel_scale; }
+
+        //--------------------------------------------------------------------
+        void interpolator(interpolator_type& i) { m_interpolator = &i; }
+        void gradient_function(const GradientF& gf) { m_gradient_function = &gf; }
+        void color_function(const ColorF& cf) { m_color_function = &cf; }
+        void d1(double v) { m_d1 = iround(v * gradient_subpixel_scale); }
+        void d2(double v) { m_d2 = iround(v * gradient_subpixel_scale); }
+
+        //--------------------------------------------------------------------
+        void prepare() {}
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {   
+            bool solid;
+            generate_span(span, x, y, len, false, &solid);
+        }
+
+        //--------------------------------------------------------------------
+        // See agg_span_runs.h. The clamped ends of the linear gradients are 
+        // solid runs, the radial gradients are checked for the runs of the
+        // same index.
+        unsigned generate_run(color_type* span, int x, int y, unsigned len,
+                              bool* solid)
+        {
+            return generate_span(span, x, y, len, true, solid);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        // Generates the whole span or, if "runs" is true, its leading part
+        // as generate_run() does.
+        unsigned generate_span(color_type* span, int x, int y, unsigned len,
+                               bool runs, bool* solid)
+        {
+            int dd = m_d2 - m_d1;
+            if(dd < 1) dd = 1;
+            double k = double(m_color_function->size()) / dd;
+
+            // The start point and the step in the gradient subpixels
+            //-----------------
+            double x1 = x + 0.5;
+            double y1 = y + 0.5;
+            double x2 = x1 + len;
+            double y2 = y1;
+            m_interpolator->transformer().transform(&x1, &y1);
+            m_interpolator->transformer().transform(&x2, &y2);
+            x1 *= gradient_subpixel_scale;
+            y1 *= gradient_subpixel_scale;
+            double dx = (x2 * gradient_subpixel_scale - x1) / len;
+            double dy = (y2 * gradient_subpixel_scale - y1) / len;
+
+            switch(int(gradient_affine_kind<GradientF>::kind))
+            {
+            case gradient_affine_x:
+                return generate_linear(span, (x1 - m_d1) * k, dx * k, len, 
+                                       runs, solid);
+
+            case gradient_affine_y:
+                return generate_linear(span, (y1 - m_d1) * k, dy * k, len, 
+                                       runs, solid);
+            }
+            return generate_radial(span, x1, y1, dx, dy, k, len, runs, solid);
+        }
+
+        //--------------------------------------------------------------------
+        AGG_INLINE int clamp_index(double v) const
+        {
+            int size = m_color_function->size();
+            if(v < 0) return 0;
+            if(v >= size) return size - 1;
+            return int(v);
+        }
+
+        //--------------------------------------------------------------------
+        // The index is f + i*df, i = 0...len-1.
+        unsigned generate_linear(color_type* span, double f, double df, 
+                                 unsigned len, bool runs, bool* solid)
+        {
+            int size = m_color_function->size();
+
+            // The pixels i1...i2-1 have the index within [0, size),
+            // the ones before and after are filled with the end colors.
+            //-----------------
+            unsigned i1 = 0;
+            unsigned i2 = len;
+            if(df != 0)
+            {
+                double t1 = -f / df;
+                double t2 = (size - f) / df;
+                if(df < 0) { double t = t1; t1 = t2; t2 = t; }
+                t1 = ceil(t1);
+                t2 = ceil(t2);
+                if(t1 > 0) i1 = (t1 < len) ? unsigned(t1) : len;
+                if(t2 < len) i2 = (t2 > i1) ? unsigned(t2) : i1;
+            }
+            else
+            {
+                if(f < 0 || f >= size) i2 = 0;
+            }
+
+            if(runs)
+            {
+                *solid = true;
+                if(i1)
+                {
+                    *span = (*m_color_function)[clamp_index(f)];
+                    return i1;
+                }
+                if(i2 == 0)
+                {
+                    *span = (*m_color_function)[clamp_index(f + (len - 1) * df)];
+                    return len;
+                }
+                *solid = false;
+                len = i2;
+            }
+
+            unsigned i;
+            const color_type& c1 = (*m_color_function)[clamp_index(f)];
+            for(i = 0; i < i1; i++) *span++ = c1;
+
+            if(i1 < i2)
+            {
+                // 16 bits of the fraction unless the index or the step
+                // are too big to fit int.
+                //-----------------
+                int shift = 16;
+                double lim = size + fabs(df) + 2;
+                while(shift > 0 && lim * (1 << shift) > 1073741824.0) --shift;
+                double scale = 1 << shift;
+                int fx  = iround((f + i1 * df) * scale);
+                int dfx = iround(df * scale);
+                for(; i < i2; i++)
+                {
+                    int d = fx >> shift;
+                    if(d < 0) d = 0;
+                    if(d >= size) d = size - 1;
+                    *span++ = (*m_color_function)[d];
+                    fx += dfx;
+                }
+            }
+
+            if(i < len)
+            {
+                const color_type& c2 = 
+                    (*m_color_function)[clamp_index(f + (len - 1) * df)];
+                for(; i < len; i++) *span++ = c2;
+            }
+            return len;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned generate_radial(color_type* span, 
+                                 double x, double y, 
+                                 double dx, double dy, 
+                                 double k, unsigned len,
+                                 bool runs, bool* solid)
+        {
+            int idx[block_size];
+            double c = -m_d1 * k;
+            double vmax = double(m_color_function->size() - 1);
+            if(runs)
+            {
+                // The leading pixels beyond the radius of the last index
+                // are found from the equation (x + i*dx)^2 + (y + i*dy)^2 
+                // = r^2, one pixel less to be safe about the rounding.
+                //-----------------
+                double r = (vmax - c) / k;
+                double a = dx * dx + dy * dy;
+                double b = x * dx + y * dy;
+                double q = x * x + y * y - r * r;
+                if(q > 0)
+                {
+                    double d = b * b - a * q;
+                    unsigned n = len;
+                    if(b < 0 && d > 0)
+                    {
+                        double t = (-b - sqrt(d)) / a - 1;
+                        n = (t <= 0) ? 0 : ((t < len) ? unsigned(t) : len);
+                    }
+                    if(n)
+                    {
+                        *span = (*m_color_function)[int(vmax)];
+                        *solid = true;
+                        return n;
+                    }
+                }
+            }
+
+            span_run_counter<int> rc;
+            unsigned i = 0;
+            while(i < len)
+            {
+                unsigned n = len - i;
+                if(n > block_size) n = block_size;
+                radial_indices(idx, x + i * dx, y + i * dy, dx, dy, k, c, vmax, n);
+                unsigned j;
+                for(j = 0; j < n; j++)
+                {
+                    if(runs && !rc.add(idx[j]))
+                    {
+                        *solid = rc.solid();
+                        return rc.len();
+                    }
+                    *span++ = (*m_color_function)[idx[j]];
+                }
+                i += n;
+            }
+            *solid = runs && rc.solid();
+            return len;
+        }
+
+        //--------------------------------------------------------------------
+        // idx[i] = clamp(sqrt(x*x + y*y) * k + c), where x = x + i*dx, 
+        // y = y + i*dy, i = 0...n-1.
+        static void radial_indices(int* idx, 
+                                   double x, double y, 
+                                   double dx, double dy, 
+                                   double k, double c, double vmax,
+                                   unsigned n)
+        {
+            unsigned i = 0;
+#ifdef AGG_SIMD_SSE2
+            __m128 vx   = _mm_set1_ps(float(x));
+            __m128 vy   = _mm_set1_ps(float(y));
+            __m128 vdx  = _mm_set1_ps(float(dx));
+            __m128 vdy  = _mm_set1_ps(float(dy));
+            __m128 vk   = _mm_set1_ps(float(k));
+            __m128 vc   = _mm_set1_ps(float(c));
+            __m128 vmx  = _mm_set1_ps(float(vmax));
+            __m128 zero = _mm_setzero_ps();
+            __m128 vi   = _mm_set_ps(3, 2, 1, 0);
+            __m128 four = _mm_set1_ps(4);
+            for(; i + 4 <= n; i += 4)
+            {
+                __m128 px = _mm_add_ps(vx, _mm_mul_ps(vi, vdx));
+                __m128 py = _mm_add_ps(vy, _mm_mul_ps(vi, vdy));
+                __m128 r  = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(px, px), 
+                                                   _mm_mul_ps(py, py)));
+                __m128 v  = _mm_add_ps(_mm_mul_ps(r, vk), vc);
+                v = _mm_min_ps(_mm_max_ps(v, zero), vmx);
+                _mm_storeu_si128((__m128i*)(idx + i), _mm_cvttps_epi32(v));
+                vi = _mm_add_ps(vi, four);
+            }
+#endif
+            for(; i < n; i++)
+            {
+                double px = x + i * dx;
+                double py = y + i * dy;
+                double v = sqrt(px * px + py * py) * k + c;
+                if(v < 0) v = 0;
+                if(v > vmax) v = vmax;
+                idx[i] = int(v);
+            }
+        }
+
+        interpolator_type* m_interpolator;
+        const GradientF*   m_gradient_function;
+        const ColorF*      m_color_function;
+        int                m_d1;
+        int                m_d2;
+    };
+
+    template<class ColorT, class Interpolator, class GradientF, class ColorF>
+    struct span_generator_runs<span_gradient_affine<ColorT, Interpolator, 
+                                                    GradientF, ColorF> >
+    {
+        enum enabled_e { enabled = true };
+    };
+
+
+
 }
 
 #endif
@@ -23,7 +23,11 @@
 #ifndef AGG_SPAN_IMAGE_FILTER_RGBA_INCLUDED
 #define AGG_SPAN_IMAGE_FILTER_RGBA_INCLUDED
 
+#include <string.h>
 #include "agg_basics.h"
+#include "agg_array.h"
+#include "agg_simd.h"
+#include "agg_span_runs.h"
 #include "agg_color_rgba.h"
 #include "agg_span_image_filter.h"
 
@@ -78,7 +82,155 @@ namespace agg
 
             } while(--len);
         }
+
+        //--------------------------------------------------------------------
+        // See agg_span_runs.h. The pixels taken from the same address are
+        // reported as solid runs, such as the background of 
+        // image_accessor_clip or the magnified pixels of the image.
+        unsigned generate_run(color_type* span, int x, int y, unsigned len,
+                              bool* solid)
+        {
+            span_run_counter<const value_type*> rc;
+            base_type::interpolator().begin(x + base_type::filter_dx_dbl(), 
+                                            y + base_type::filter_dy_dbl(), len);
+            do
+            {
+                base_type::interpolator().coordinates(&x, &y);
+                const value_type* fg_ptr = (const value_type*)
+                    base_type::source().span(x >> image_subpixel_shift, 
+                                             y >> image_subpixel_shift, 
+                                             1);
+                if(!rc.add(fg_ptr)) break;
+                span->r = fg_ptr[order_type::R];
+                span->g = fg_ptr[order_type::G];
+                span->b = fg_ptr[order_type::B];
+                span->a = fg_ptr[order_type::A];
+                ++span;
+                ++base_type::interpolator();
+
+            } while(--len);
+            *solid = rc.solid();
+            return rc.len();
+        }
+    };
+
+    template<class Source, class Interpolator> 
+    struct span_generator_runs<span_image_filter_rgba_nn<Source, Interpolator> >
+    {
+        enum enabled_e { enabled = true };
+    };
+
+
+
+    //==================================================image_filter_rgba_simd
+    // One pixel of the bilinear and 2x2 filters from the taps p00, p10 of
+    // the row y_lr and p01, p11 of the row y_lr+1. The generic version 
+    // isn't enabled and the span generators calculate the pixels with 
+    // the plain C++ code. The one for rgba8 has an SSE2 specialization 
+    // that gives exactly the same result.
+    //
+    // When it's enabled the span generators take the coordinates from
+    // the interpolator by blocks of block_size. It keeps the interpolator
+    // out of the loop that writes the span, so that the compiler doesn't
+    // have to reload it after every pixel.
+    //------------------------------------------------------------------------
+    template<class ColorT, class Order> struct image_filter_rgba_simd
+    {
+        enum enabled_e    { enabled = false };
+        enum block_size_e { block_size = 1 };
+
+        static void bilinear(ColorT*, 
+                             const int8u*, const int8u*, 
+                             const int8u*, const int8u*, 
+                             int, int) {}
+
+        static void filter_2x2(ColorT*, 
+                               const int8u*, const int8u*, 
+                               const int8u*, const int8u*, 
+                               int, int, int, int) {}
+    };
+
+#ifdef AGG_SIMD_SSE2
+    template<class Order> struct image_filter_rgba_simd<rgba8, Order>
+    {
+        enum enabled_e    { enabled = true };
+        enum block_size_e { block_size = 64 };
+
+        // The pairs of 16-bit lanes (p0[i], p1[i]), i = 0...3
+        static AGG_INLINE __m128i taps(const int8u* p0, const int8u* p1)
+        {
+            return sse2_unpack_lo(_mm_unpacklo_epi8(sse2_load4(p0), sse2_load4(p1)));
+        }
+
+        static AGG_INLINE void store(rgba8* span, __m128i fg)
+        {
+            fg = _mm_shuffle_epi32(fg, _MM_SHUFFLE(Order::A, Order::B, Order::G, Order::R));
+            fg = _mm_packs_epi32(fg, fg);
+            int32 v = _mm_cvtsi128_si32(_mm_packus_epi16(fg, fg));
+            memcpy((void*)span, &v, 4);
+        }
+
+        // The sum of the taps by the weights is calculated in two steps,
+        // first the rows with _mm_madd_epi16, then the rows by y_hr in 
+        // float. All the values are integers less than 2^24, so float 
+        // is exact here.
+        static AGG_INLINE void bilinear(rgba8* span, 
+                                        const int8u* p00, const int8u* p10,
+                                        const int8u* p01, const int8u* p11,
+                                        int x_hr, int y_hr)
+        {
+            __m128i wx = _mm_set1_epi32((x_hr << 16) | (image_subpixel_scale - x_hr));
+            __m128 fg0 = _mm_cvtepi32_ps(_mm_madd_epi16(taps(p00, p10), wx));
+            __m128 fg1 = _mm_cvtepi32_ps(_mm_madd_epi16(taps(p01, p11), wx));
+            fg0 = _mm_mul_ps(fg0, _mm_set1_ps(float(image_subpixel_scale - y_hr)));
+            fg1 = _mm_mul_ps(fg1, _mm_set1_ps(float(y_hr)));
+            fg0 = _mm_add_ps(_mm_add_ps(fg0, fg1), 
+                             _mm_set1_ps(float(image_subpixel_scale * 
+                                               image_subpixel_scale / 2)));
+            store(span, _mm_srli_epi32(_mm_cvttps_epi32(fg0), 
+                                       image_subpixel_shift * 2));
+        }
+
+        // The weights normally fit 16 bits and the sum is calculated 
+        // with _mm_madd_epi16, otherwise with 32-bit products. In both 
+        // cases it's modulo 2^32, as the unsigned arithmetic of the 
+        // plain C++ code.
+        static AGG_INLINE void filter_2x2(rgba8* span, 
+                                          const int8u* p00, const int8u* p10,
+                                          const int8u* p01, const int8u* p11,
+                                          int w00, int w10, int w01, int w11)
+        {
+            __m128i t = taps(p00, p10);
+            __m128i b = taps(p01, p11);
+            __m128i fg;
+            if(unsigned((w00 + 0x8000) | (w10 + 0x8000) | 
+                        (w01 + 0x8000) | (w11 + 0x8000)) < 0x10000)
+            {
+                fg = _mm_add_epi32(
+                    _mm_madd_epi16(t, _mm_set1_epi32((w10 << 16) | (w00 & 0xFFFF))),
+                    _mm_madd_epi16(b, _mm_set1_epi32((w11 << 16) | (w01 & 0xFFFF))));
+            }
+            else
+            {
+                __m128i lo = _mm_set1_epi32(0xFFFF);
+                fg = _mm_add_epi32(
+                    _mm_add_epi32(
+                        sse2_mullo_epi32(_mm_and_si128(t, lo), _mm_set1_epi32(w00)),
+                        sse2_mullo_epi32(_mm_srli_epi32(t, 16), _mm_set1_epi32(w10))),
+                    _mm_add_epi32(
+                        sse2_mullo_epi32(_mm_and_si128(b, lo), _mm_set1_epi32(w01)),
+                        sse2_mullo_epi32(_mm_srli_epi32(b, 16), _mm_set1_epi32(w11))));
+            }
+            fg = _mm_srli_epi32(_mm_add_epi32(fg, _mm_set1_epi32(image_filter_scale / 2)), 
+                                image_filter_shift);
+
+            // a = min(fg[A], base_mask), fg[R,G,B] = min(fg[R,G,B], a)
+            __m128i a = _mm_shuffle_epi32(fg, _MM_SHUFFLE(Order::A, Order::A, Order::A, Order::A));
+            a = sse2_min_epu32(a, _mm_set1_epi32(rgba8::base_mask));
+            store(span, sse2_min_epu32(fg, a));
+        }
     };
+#endif
 
 
 
@@ -95,6 +247,7 @@ namespace agg
         typedef span_image_filter<source_type, interpolator_type> base_type;
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
+        typedef image_filter_rgba_simd<color_type, order_type> simd_type;
         enum base_scale_e
         {
             base_shift = color_type::base_shift,
@@ -115,6 +268,40 @@ namespace agg
             base_type::interpolator().begin(x + base_type::filter_dx_dbl(), 
                                             y + base_type::filter_dy_dbl(), len);
 
+            if(simd_type::enabled)
+            {
+                int xy[simd_type::block_size * 2];
+                do
+                {
+                    unsigned n = len;
+                    if(n > simd_type::block_size) n = simd_type::block_size;
+                    len -= n;
+
+                    unsigned i;
+                    for(i = 0; i < n; i++)
+                    {
+                        base_type::interpolator().coordinates(xy + i * 2, xy + i * 2 + 1);
+                        ++base_type::interpolator();
+                    }
+
+                    for(i = 0; i < n; i++)
+                    {
+                        int x_hr = xy[i * 2]     - base_type::filter_dx_int();
+                        int y_hr = xy[i * 2 + 1] - base_type::filter_dy_int();
+                        const int8u* p00 = base_type::source().span(x_hr >> image_subpixel_shift, 
+                                                                    y_hr >> image_subpixel_shift, 2);
+                        const int8u* p10 = base_type::source().next_x();
+                        const int8u* p01 = base_type::source().next_y();
+                        const int8u* p11 = base_type::source().next_x();
+                        simd_type::bilinear(span++, p00, p10, p01, p11,
+                                            x_hr & image_subpixel_mask,
+                                            y_hr & image_subpixel_mask);
+                    }
+                }
+                while(len);
+                return;
+            }
+
             calc_type fg[4];
             const value_type *fg_ptr;
 
@@ -196,6 +383,7 @@ namespace agg
         typedef span_image_filter<source_type, interpolator_type> base_type;
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
+        typedef image_filter_rgba_simd<color_type, order_type> simd_type;
         enum base_scale_e
         {
             base_shift = color_type::base_shift,
@@ -230,12 +418,38 @@ namespace agg
             int maxx = base_type::source().width() - 1;
             int maxy = base_type::source().height() - 1;
 
+            int xy[simd_type::block_size * 2];
+            unsigned i = 0;
+            unsigned n = 0;
+
             do
             {
                 int x_hr;
                 int y_hr;
 
-                base_type::interpolator().coordinates(&x_hr, &y_hr);
+                if(simd_type::enabled)
+                {
+                    // The coordinates are taken by blocks, see 
+                    // span_image_filter_rgba_bilinear
+                    if(i == n)
+                    {
+                        n = len;
+                        if(n > simd_type::block_size) n = simd_type::block_size;
+                        for(i = 0; i < n; i++)
+                        {
+                            base_type::interpolator().coordinates(xy + i * 2, xy + i * 2 + 1);
+                            ++base_type::interpolator();
+                        }
+                        i = 0;
+                    }
+                    x_hr = xy[i * 2];
+                    y_hr = xy[i * 2 + 1];
+                    ++i;
+                }
+                else
+                {
+                    base_type::interpolator().coordinates(&x_hr, &y_hr);
+                }
 
                 x_hr -= base_type::filter_dx_int();
                 y_hr -= base_type::filter_dy_int();
@@ -245,6 +459,19 @@ namespace agg
 
                 unsigned weight;
 
+                if(simd_type::enabled &&
+                   x_lr >= 0    && y_lr >= 0 &&
+                   x_lr <  maxx && y_lr <  maxy) 
+                {
+                    const int8u* p0 = base_type::source().row_ptr(y_lr) + (x_lr << 2);
+                    const int8u* p1 = base_type::source().row_ptr(y_lr + 1) + (x_lr << 2);
+                    simd_type::bilinear(span, p0, p0 + 4, p1, p1 + 4,
+                                        x_hr & image_subpixel_mask,
+                                        y_hr & image_subpixel_mask);
+                    ++span;
+                    continue;
+                }
+
                 if(x_lr >= 0    && y_lr >= 0 &&
                    x_lr <  maxx && y_lr <  maxy) 
                 {
@@ -413,7 +640,7 @@ namespace agg
                 span->b = (value_type)fg[order_type::B];
                 span->a = (value_type)fg[order_type::A];
                 ++span;
-                ++base_type::interpolator();
+                if(!simd_type::enabled) ++base_type::interpolator();
 
             } while(--len);
         }
@@ -435,6 +662,7 @@ namespace agg
         typedef span_image_filter<source_type, interpolator_type> base_type;
         typedef typename color_type::value_type value_type;
         typedef typename color_type::calc_type calc_type;
+        typedef image_filter_rgba_simd<color_type, order_type> simd_type;
         enum base_scale_e
         {
             base_shift = color_type::base_shift,
@@ -463,6 +691,48 @@ namespace agg
                                         ((base_type::filter().diameter()/2 - 1) << 
                                           image_subpixel_shift);
 
+            if(simd_type::enabled)
+            {
+                int xy[simd_type::block_size * 2];
+                do
+                {
+                    unsigned n = len;
+                    if(n > simd_type::block_size) n = simd_type::block_size;
+                    len -= n;
+
+                    unsigned i;
+                    for(i = 0; i < n; i++)
+                    {
+                        base_type::interpolator().coordinates(xy + i * 2, xy + i * 2 + 1);
+                        ++base_type::interpolator();
+                    }
+
+                    for(i = 0; i < n; i++)
+                    {
+                        int x_hr = xy[i * 2]     - base_type::filter_dx_int();
+                        int y_hr = xy[i * 2 + 1] - base_type::filter_dy_int();
+                        const int8u* p00 = base_type::source().span(x_hr >> image_subpixel_shift, 
+                                                                    y_hr >> image_subpixel_shift, 2);
+                        const int8u* p10 = base_type::source().next_x();
+                        const int8u* p01 = base_type::source().next_y();
+                        const int8u* p11 = base_type::source().next_x();
+                        const int16* wx = weight_array + (x_hr & image_subpixel_mask);
+                        const int16* wy = weight_array + (y_hr & image_subpixel_mask);
+                        simd_type::filter_2x2(span++, p00, p10, p01, p11,
+                            (wx[image_subpixel_scale] * wy[image_subpixel_scale] + 
+                             image_filter_scale / 2) >> image_filter_shift,
+                            (wx[0] * wy[image_subpixel_scale] + 
+                             image_filter_scale / 2) >> image_filter_shift,
+                            (wx[image_subpixel_scale] * wy[0] + 
+                             image_filter_scale / 2) >> image_filter_shift,
+                            (wx[0] * wy[0] + 
+                             image_filter_scale / 2) >> image_filter_shift);
+                    }
+                }
+                while(len);
+                return;
+            }
+
             do
             {
                 int x_hr;
@@ -785,6 +1055,279 @@ namespace agg
 
 
 
+    //=====================================span_image_resample_rgba_separable
+    // The same filter as span_image_resample_rgba_affine, but if the 
+    // transformation is scaling and translation only it's applied in two 
+    // passes, horizontally to the source rows and then vertically, which 
+    // costs O(diameter) per pixel instead of O(diameter^2). The weights 
+    // of the columns are calculated once and the rows filtered horizontally
+    // are kept for the next scanlines. The result can differ from the 2D 
+    // filter only by rounding. With rotation or skewing it works exactly 
+    // as span_image_resample_rgba_affine.
+    //------------------------------------------------------------------------
+    template<class Source> 
+    class span_image_resample_rgba_separable : 
+    public span_image_resample_rgba_affine<Source>
+    {
+    public:
+        typedef Source source_type;
+        typedef typename source_type::color_type color_type;
+        typedef typename source_type::order_type order_type;
+        typedef span_image_resample_rgba_affine<source_type> base_type;
+        typedef typename base_type::interpolator_type interpolator_type;
+        typedef typename color_type::value_type value_type;
+        enum base_scale_e
+        {
+            base_shift = color_type::base_shift,
+            base_mask  = color_type::base_mask
+        };
+        enum no_row_e { no_row = 0x7FFFFFFF };
+
+        //--------------------------------------------------------------------
+        span_image_resample_rgba_separable() : m_separable(false) {}
+        span_image_resample_rgba_separable(source_type& src, 
+                                           interpolator_type& inter,
+                                           const image_filter_lut& filter) :
+            base_type(src, inter, filter),
+            m_separable(false)
+        {}
+
+        //--------------------------------------------------------------------
+        bool separable() const { return m_separable; }
+
+        //--------------------------------------------------------------------
+        void prepare() 
+        {
+            base_type::prepare();
+            const trans_affine& mtx = base_type::interpolator().transformer();
+            m_separable = mtx.shx == 0.0 && mtx.shy == 0.0;
+
+            int filter_scale = base_type::filter().diameter() << image_subpixel_shift;
+            m_num_rows = (filter_scale + base_type::m_ry_inv - 1) / base_type::m_ry_inv + 1;
+            m_row_y.allocate(m_num_rows);
+            m_row_x1.allocate(m_num_rows);
+            m_row_x2.allocate(m_num_rows);
+            m_x1 = m_x2 = 0;
+        }
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            if(!m_separable)
+            {
+                base_type::generate(span, x, y, len);
+                return;
+            }
+
+            if(x < m_x1 || x + int(len) > m_x2) calc_columns(x, x + len);
+
+            int diameter     = base_type::filter().diameter();
+            int filter_scale = diameter << image_subpixel_shift;
+            int radius_y     = (diameter * base_type::m_ry) >> 1;
+
+            const int16* weight_array = base_type::filter().weight_array();
+
+            // The same coordinate as the interpolator gives, it's 
+            // constant along the span.
+            double tx = x + base_type::filter_dx_dbl();
+            double ty = y + base_type::filter_dy_dbl();
+            base_type::interpolator().transformer().transform(&tx, &ty);
+            y = iround(ty * image_subpixel_scale) + 
+                base_type::filter_dy_int() - radius_y;
+
+            int y_lr = y >> image_subpixel_shift;
+            int y_hr = ((image_subpixel_mask - (y & image_subpixel_mask)) * 
+                            base_type::m_ry_inv) >> 
+                                image_subpixel_shift;
+
+            m_sum.allocate(len * 4);
+            int64* sum = &m_sum[0];
+            memset(sum, 0, sizeof(int64) * len * 4);
+
+            int64 total_y = 0;
+            unsigned i;
+            for(;;)
+            {
+                int weight_y = weight_array[y_hr];
+                const int64* row = filtered_row(y_lr, x, len);
+                for(i = 0; i < len * 4; i++)
+                {
+                    sum[i] += row[i] * weight_y;
+                }
+                total_y += weight_y;
+                y_hr += base_type::m_ry_inv;
+                if(y_hr >= filter_scale) break;
+                ++y_lr;
+            }
+
+            const int64* total_x = &m_col_total[x - m_x1];
+            int64 fg[4];
+            do
+            {
+                int64 total_weight = *total_x++ * total_y;
+
+                fg[0] = (sum[0] + total_weight / 2) / total_weight;
+                fg[1] = (sum[1] + total_weight / 2) / total_weight;
+                fg[2] = (sum[2] + total_weight / 2) / total_weight;
+                fg[3] = (sum[3] + total_weight / 2) / total_weight;
+                sum += 4;
+
+                if(fg[0] < 0) fg[0] = 0;
+                if(fg[1] < 0) fg[1] = 0;
+                if(fg[2] < 0) fg[2] = 0;
+                if(fg[3] < 0) fg[3] = 0;
+
+                if(fg[order_type::A] > base_mask)         fg[order_type::A] = base_mask;
+                if(fg[order_type::R] > fg[order_type::A]) fg[order_type::R] = fg[order_type::A];
+                if(fg[order_type::G] > fg[order_type::A]) fg[order_type::G] = fg[order_type::A];
+                if(fg[order_type::B] > fg[order_type::A]) fg[order_type::B] = fg[order_type::A];
+
+                span->r = (value_type)fg[order_type::R];
+                span->g = (value_type)fg[order_type::G];
+                span->b = (value_type)fg[order_type::B];
+                span->a = (value_type)fg[order_type::A];
+                ++span;
+            } while(--len);
+        }
+
+    private:
+        //--------------------------------------------------------------------
+        // Calculates the first source pixel and the weights for the output 
+        // columns x1...x2-1, together with the ones calculated before. 
+        // The filtered rows are discarded.
+        void calc_columns(int x1, int x2)
+        {
+            if(m_x1 < m_x2)
+            {
+                if(x1 > m_x1) x1 = m_x1;
+                if(x2 < m_x2) x2 = m_x2;
+            }
+            m_x1 = x1;
+            m_x2 = x2;
+
+            unsigned num_cols = unsigned(x2 - x1);
+            int diameter      = base_type::filter().diameter();
+            int filter_scale  = diameter << image_subpixel_shift;
+            int radius_x      = (diameter * base_type::m_rx) >> 1;
+            unsigned max_taps = 
+                (filter_scale + base_type::m_rx_inv - 1) / base_type::m_rx_inv + 1;
+
+            const int16* weight_array = base_type::filter().weight_array();
+
+            m_col_x.allocate(num_cols);
+            m_col_start.allocate(num_cols + 1);
+            m_col_total.allocate(num_cols);
+            m_col_weights.allocate(num_cols * max_taps);
+
+            unsigned num_weights = 0;
+            unsigned i;
+            for(i = 0; i < num_cols; i++)
+            {
+                double tx = x1 + int(i) + base_type::filter_dx_dbl();
+                double ty = base_type::filter_dy_dbl();
+                base_type::interpolator().transformer().transform(&tx, &ty);
+                int x = iround(tx * image_subpixel_scale) + 
+                        base_type::filter_dx_int() - radius_x;
+
+                int x_hr = ((image_subpixel_mask - (x & image_subpixel_mask)) * 
+                                base_type::m_rx_inv) >> 
+                                    image_subpixel_shift;
+                int64 total_weight = 0;
+
+                m_col_x[i] = x >> image_subpixel_shift;
+                m_col_start[i] = num_weights;
+                for(;;)
+                {
+                    int weight = weight_array[x_hr];
+                    m_col_weights[num_weights++] = weight;
+                    total_weight += weight;
+                    x_hr += base_type::m_rx_inv;
+                    if(x_hr >= filter_scale) break;
+                }
+                m_col_total[i] = total_weight;
+            }
+            m_col_start[num_cols] = num_weights;
+
+            m_rows.allocate(m_num_rows * num_cols * 4);
+            for(i = 0; i < m_num_rows; i++) m_row_y[i] = no_row;
+        }
+
+        //--------------------------------------------------------------------
+        // Returns source row y filtered horizontally, starting from 
+        // output column x. Only the columns that aren't kept already 
+        // are calculated.
+        const int64* filtered_row(int y, int x, unsigned len)
+        {
+            unsigned slot = unsigned(y % int(m_num_rows) + int(m_num_rows)) % m_num_rows;
+            int64* row = &m_rows[slot * (m_x2 - m_x1) * 4];
+            int x2 = x + int(len);
+            if(m_row_y[slot] != y)
+            {
+                m_row_y[slot]  = y;
+                m_row_x1[slot] = m_row_x2[slot] = x;
+            }
+            if(x < m_row_x1[slot])
+            {
+                filter_row(row, y, x, m_row_x1[slot]);
+                m_row_x1[slot] = x;
+            }
+            if(x2 > m_row_x2[slot])
+            {
+                filter_row(row, y, m_row_x2[slot], x2);
+                m_row_x2[slot] = x2;
+            }
+            return row + (x - m_x1) * 4;
+        }
+
+        //--------------------------------------------------------------------
+        void filter_row(int64* row, int y, int x1, int x2)
+        {
+            unsigned i   = unsigned(x1 - m_x1);
+            unsigned end = unsigned(x2 - m_x1);
+            int64* dst   = row + i * 4;
+            for(; i < end; i++)
+            {
+                const int* weights = &m_col_weights[m_col_start[i]];
+                unsigned taps = m_col_start[i + 1] - m_col_start[i];
+                const value_type* fg_ptr = 
+                    (const value_type*)base_type::source().span(m_col_x[i], y, taps);
+                int64 fg[4];
+                fg[0] = fg[1] = fg[2] = fg[3] = 0;
+                for(;;)
+                {
+                    int weight = *weights++;
+                    fg[0] += fg_ptr[0] * weight;
+                    fg[1] += fg_ptr[1] * weight;
+                    fg[2] += fg_ptr[2] * weight;
+                    fg[3] += fg_ptr[3] * weight;
+                    if(--taps == 0) break;
+                    fg_ptr = (const value_type*)base_type::source().next_x();
+                }
+                dst[0] = fg[0];
+                dst[1] = fg[1];
+                dst[2] = fg[2];
+                dst[3] = fg[3];
+                dst += 4;
+            }
+        }
+
+        bool                 m_separable;
+        int                  m_x1;
+        int                  m_x2;
+        unsigned             m_num_rows;
+        pod_vector<int>      m_col_x;
+        pod_vector<unsigned> m_col_start;
+        pod_vector<int64>    m_col_total;
+        pod_vector<int>      m_col_weights;
+        pod_vector<int64>    m_rows;
+        pod_vector<int>      m_row_y;
+        pod_vector<int>      m_row_x1;
+        pod_vector<int>      m_row_x2;
+        pod_vector<int64>    m_sum;
+    };
+
+
+
     //==============================================span_image_resample_rgba
     template<class Source, class Interpolator>
     class span_image_resample_rgba : 
@@ -94,6 +94,20 @@ namespace agg
             *y = m_li_y.y();
         }
 
+        //----------------------------------------------------------------
+        // The scale of the transformation, subpixel_scale means 1:1, the 
+        // same as the one of span_interpolator_persp_*. It's constant 
+        // for the affine transformations, so it's calculated from the 
+        // transformer, which must have scaling_abs().
+        void local_scale(int* x, int* y) const
+        {
+            double sx;
+            double sy;
+            m_trans->scaling_abs(&sx, &sy);
+            *x = iround(sx * subpixel_scale);
+            *y = iround(sy * subpixel_scale);
+        }
+
     private:
         const trans_type* m_trans;
         dda2_line_interpolator m_li_x;
@@ -209,6 +223,20 @@ namespace agg
             *y = m_li_y.y();
         }
 
+        //----------------------------------------------------------------
+        // The scale of the transformation, subpixel_scale means 1:1, the 
+        // same as the one of span_interpolator_persp_*. It's constant 
+        // for the affine transformations, so it's calculated from the 
+        // transformer, which must have scaling_abs().
+        void local_scale(int* x, int* y) const
+        {
+            double sx;
+            double sy;
+            m_trans->scaling_abs(&sx, &sy);
+            *x = iround(sx * subpixel_scale);
+            *y = iround(sy * subpixel_scale);
+        }
+
     private:
         unsigned m_subdiv_shift;
         unsigned m_subdiv_size;
@@ -0,0 +1,103 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Solid runs in the span generators. A span generator can report the
+// parts of the span that have the same color, so that render_scanline_aa
+// renders them with blend_solid_hspan or blend_hline instead of
+// blend_color_hspan. The generator specializes span_generator_runs
+// with enabled = true and has the method:
+//
+//     unsigned generate_run(color_type* span, int x, int y, unsigned len,
+//                           bool* solid);
+//
+// It generates the leading part of the span (x, y, len) and returns its
+// length, 1...len. If *solid is true all the pixels of the part have the
+// color span[0] and the others don't have to be generated. The rest of
+// the span is requested with the next calls.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_SPAN_RUNS_INCLUDED
+#define AGG_SPAN_RUNS_INCLUDED
+
+#include "agg_basics.h"
+
+namespace agg
+{
+
+    enum span_solid_run_e
+    {
+        span_solid_run_min = 16  //----span_solid_run_min
+    };
+
+    //=====================================================span_generator_runs
+    template<class SpanGenerator> struct span_generator_runs
+    {
+        enum enabled_e { enabled = false };
+    };
+
+    //========================================================span_run_counter
+    // Helps the generators that calculate the span pixel by pixel to find
+    // the leading part. A value that identifies the color (an index or
+    // a pointer) is added for each pixel, add() returns false when the
+    // part is complete: it's a solid run that ends before this pixel, or
+    // it's not solid and a solid run of span_solid_run_min pixels starts
+    // right after it. The pixels of this run are not in the part.
+    //------------------------------------------------------------------------
+    template<class T> class span_run_counter
+    {
+    public:
+        span_run_counter() : m_len(0), m_run(0), m_last(), m_solid(false) {}
+
+        //--------------------------------------------------------------------
+        bool add(const T& v)
+        {
+            if(m_len && v == m_last)
+            {
+                ++m_run;
+            }
+            else
+            {
+                if(m_run == m_len && m_run >= unsigned(span_solid_run_min))
+                {
+                    return false;
+                }
+                m_run = 1;
+                m_last = v;
+            }
+            ++m_len;
+            m_solid = m_run == m_len;
+            if(!m_solid && m_run >= unsigned(span_solid_run_min))
+            {
+                m_len -= m_run;
+                return false;
+            }
+            return true;
+        }
+
+        //--------------------------------------------------------------------
+        unsigned len()   const { return m_len; }
+        bool     solid() const { return m_solid; }
+
+    private:
+        unsigned m_len;
+        unsigned m_run;
+        T        m_last;
+        bool     m_solid;
+    };
+
+}
+
+#endif
@@ -0,0 +1,257 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Minimal threading support: atomic counter and pointers, mutex and 
+// parallel_for.
+// Uses Win32 threads on Windows and POSIX threads elsewhere. Define
+// AGG_NO_THREADS to turn everything into plain serial code.
+//
+//----------------------------------------------------------------------------
+
+#ifndef AGG_THREADS_INCLUDED
+#define AGG_THREADS_INCLUDED
+
+#include "agg_basics.h"
+
+#ifndef AGG_NO_THREADS
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
+namespace agg
+{
+
+    //-----------------------------------------------------atomic_fetch_add
+    // Atomically adds "v" to "*p" and returns the previous value.
+    inline int atomic_fetch_add(volatile int* p, int v)
+    {
+#if defined(AGG_NO_THREADS)
+        int r = *p;
+        *p += v;
+        return r;
+#elif defined(_WIN32)
+        return (int)InterlockedExchangeAdd((volatile LONG*)p, (LONG)v);
+#else
+        return __sync_fetch_and_add(p, v);
+#endif
+    }
+
+
+    //-----------------------------------------------------atomic_load_ptr
+    // Reads the pointer written by atomic_store_ptr() or atomic_cas_ptr()
+    // in another thread, so that the data it points to are visible too.
+    template<class T> inline T* atomic_load_ptr(T* const volatile* p)
+    {
+#if defined(AGG_NO_THREADS)
+        return *p;
+#elif defined(_WIN32)
+        T* v = *p;
+        MemoryBarrier();
+        return v;
+#elif defined(__ATOMIC_ACQUIRE)
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+        T* v = *p;
+        __sync_synchronize();
+        return v;
+#endif
+    }
+
+    //----------------------------------------------------atomic_store_ptr
+    // Writes the pointer after all the previous writes of this thread.
+    template<class T> inline void atomic_store_ptr(T* volatile* p, T* v)
+    {
+#if defined(AGG_NO_THREADS)
+        *p = v;
+#elif defined(_WIN32)
+        InterlockedExchangePointer((PVOID volatile*)p, (PVOID)v);
+#elif defined(__ATOMIC_RELEASE)
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#else
+        __sync_synchronize();
+        *p = v;
+#endif
+    }
+
+    //------------------------------------------------------atomic_cas_ptr
+    // Writes "v" like atomic_store_ptr() if "*p" is equal to "cmp". 
+    // Returns true if it's written.
+    template<class T> inline bool atomic_cas_ptr(T* volatile* p, T* cmp, T* v)
+    {
+#if defined(AGG_NO_THREADS)
+        if(*p != cmp) return false;
+        *p = v;
+        return true;
+#elif defined(_WIN32)
+        return InterlockedCompareExchangePointer((PVOID volatile*)p, 
+                                                 (PVOID)v, 
+                                                 (PVOID)cmp) == (PVOID)cmp;
+#else
+        return __sync_bool_compare_and_swap(p, cmp, v);
+#endif
+    }
+
+
+    //===================================================================mutex
+    class mutex
+    {
+    public:
+#if defined(AGG_NO_THREADS)
+        mutex() {}
+        void lock() {}
+        void unlock() {}
+#elif defined(_WIN32)
+        ~mutex() { DeleteCriticalSection(&m_cs); }
+        mutex() { InitializeCriticalSection(&m_cs); }
+        void lock()   { EnterCriticalSection(&m_cs); }
+        void unlock() { LeaveCriticalSection(&m_cs); }
+#else
+        ~mutex() { pthread_mutex_destroy(&m_mutex); }
+        mutex() { pthread_mutex_init(&m_mutex, 0); }
+        void lock()   { pthread_mutex_lock(&m_mutex); }
+        void unlock() { pthread_mutex_unlock(&m_mutex); }
+#endif
+
+    private:
+        mutex(const mutex&);
+        const mutex& operator = (const mutex&);
+
+#if defined(AGG_NO_THREADS)
+#elif defined(_WIN32)
+        CRITICAL_SECTION m_cs;
+#else
+        pthread_mutex_t  m_mutex;
+#endif
+    };
+
+
+    //==============================================================mutex_lock
+    // Locks the mutex for the lifetime of the object.
+    class mutex_lock
+    {
+    public:
+        ~mutex_lock() { m_mutex.unlock(); }
+        explicit mutex_lock(mutex& m) : m_mutex(m) { m_mutex.lock(); }
+
+    private:
+        mutex_lock(const mutex_lock&);
+        const mutex_lock& operator = (const mutex_lock&);
+
+        mutex& m_mutex;
+    };
+
+
+    //------------------------------------------------------parallel_for_ctx
+    template<class Job> struct parallel_for_ctx
+    {
+        Job*         job;
+        unsigned     num_jobs;
+        volatile int next;
+
+        void run()
+        {
+            for(;;)
+            {
+                unsigned i = unsigned(atomic_fetch_add(&next, 1));
+                if(i >= num_jobs) break;
+                (*job)(i);
+            }
+        }
+    };
+
+#ifndef AGG_NO_THREADS
+    //---------------------------------------------------parallel_for_thread
+#if defined(_WIN32)
+    template<class Job> DWORD WINAPI parallel_for_thread(LPVOID arg)
+    {
+        ((parallel_for_ctx<Job>*)arg)->run();
+        return 0;
+    }
+#else
+    template<class Job> void* parallel_for_thread(void* arg)
+    {
+        ((parallel_for_ctx<Job>*)arg)->run();
+        return 0;
+    }
+#endif
+#endif
+
+
+    //============================================================parallel_for
+    // Calls job(i) for every i in [0, num_jobs) using up to num_threads
+    // threads, the calling one included. Jobs are handed out dynamically,
+    // one at a time, so their execution order is not defined. The function
+    // returns when all the jobs are done. If a thread cannot be created
+    // the remaining ones simply take more jobs.
+    //------------------------------------------------------------------------
+    template<class Job>
+    void parallel_for(Job& job, unsigned num_jobs, unsigned num_threads)
+    {
+        parallel_for_ctx<Job> ctx;
+        ctx.job      = &job;
+        ctx.num_jobs = num_jobs;
+        ctx.next     = 0;
+
+        if(num_threads > num_jobs) num_threads = num_jobs;
+
+#ifndef AGG_NO_THREADS
+        if(num_threads > 1)
+        {
+            unsigned num_extra = num_threads - 1;
+            unsigned num_started = 0;
+            unsigned i;
+#if defined(_WIN32)
+            HANDLE* threads = pod_allocator<HANDLE>::allocate(num_extra);
+            for(i = 0; i < num_extra; i++)
+            {
+                HANDLE h = CreateThread(0, 0, parallel_for_thread<Job>, &ctx, 0, 0);
+                if(h) threads[num_started++] = h;
+            }
+            ctx.run();
+            for(i = 0; i < num_started; i++)
+            {
+                WaitForSingleObject(threads[i], INFINITE);
+                CloseHandle(threads[i]);
+            }
+            pod_allocator<HANDLE>::deallocate(threads, num_extra);
+#else
+            pthread_t* threads = pod_allocator<pthread_t>::allocate(num_extra);
+            for(i = 0; i < num_extra; i++)
+            {
+                if(pthread_create(&threads[num_started], 0,
+                                  parallel_for_thread<Job>, &ctx) == 0)
+                {
+                    ++num_started;
+                }
+            }
+            ctx.run();
+            for(i = 0; i < num_started; i++)
+            {
+                pthread_join(threads[i], 0);
+            }
+            pod_allocator<pthread_t>::deallocate(threads, num_extra);
+#endif
+            return;
+        }
+#endif
+        ctx.run();
+    }
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include <math.h>
 #include "agg_basics.h"
+#include "agg_simd.h"
 
 namespace agg
 {
@@ -254,6 +255,11 @@ namespace agg
         // invert() the matrix and then use direct transformations. 
         void inverse_transform(double* x, double* y) const;
 
+        // Direct transformation of n points stored as separate arrays
+        // of x and y. The result is the same as of transform().
+        void transform_array(double* x, double* y, unsigned n) const;
+        void transform_array(float*  x, float*  y, unsigned n) const;
+
         //-------------------------------------------- Auxiliary
         // Calculate the determinant of matrix
         double determinant() const
@@ -315,6 +321,72 @@ namespace agg
         *y = b * sx - a * shy;
     }
 
+    //------------------------------------------------------------------------
+    inline void trans_affine::transform_array(double* x, double* y, unsigned n) const
+    {
+        unsigned i = 0;
+#ifdef AGG_SIMD_SSE2
+        __m128d vsx  = _mm_set1_pd(sx);
+        __m128d vshy = _mm_set1_pd(shy);
+        __m128d vshx = _mm_set1_pd(shx);
+        __m128d vsy  = _mm_set1_pd(sy);
+        __m128d vtx  = _mm_set1_pd(tx);
+        __m128d vty  = _mm_set1_pd(ty);
+        for(; i + 2 <= n; i += 2)
+        {
+            __m128d vx = _mm_loadu_pd(x + i);
+            __m128d vy = _mm_loadu_pd(y + i);
+            _mm_storeu_pd(x + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vsx), 
+                                                       _mm_mul_pd(vy, vshx)), vtx));
+            _mm_storeu_pd(y + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vshy), 
+                                                       _mm_mul_pd(vy, vsy)), vty));
+        }
+#endif
+        for(; i < n; i++) transform(x + i, y + i);
+    }
+
+    //------------------------------------------------------------------------
+    // The calculations are done in double, like for the single points.
+    inline void trans_affine::transform_array(float* x, float* y, unsigned n) const
+    {
+        unsigned i = 0;
+#ifdef AGG_SIMD_SSE2
+        __m128d vsx  = _mm_set1_pd(sx);
+        __m128d vshy = _mm_set1_pd(shy);
+        __m128d vshx = _mm_set1_pd(shx);
+        __m128d vsy  = _mm_set1_pd(sy);
+        __m128d vtx  = _mm_set1_pd(tx);
+        __m128d vty  = _mm_set1_pd(ty);
+        for(; i + 4 <= n; i += 4)
+        {
+            __m128 vx = _mm_loadu_ps(x + i);
+            __m128 vy = _mm_loadu_ps(y + i);
+            __m128d x1 = _mm_cvtps_pd(vx);
+            __m128d y1 = _mm_cvtps_pd(vy);
+            __m128d x2 = _mm_cvtps_pd(_mm_movehl_ps(vx, vx));
+            __m128d y2 = _mm_cvtps_pd(_mm_movehl_ps(vy, vy));
+            _mm_storeu_ps(x + i, _mm_movelh_ps(
+                _mm_cvtpd_ps(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x1, vsx), 
+                                                   _mm_mul_pd(y1, vshx)), vtx)),
+                _mm_cvtpd_ps(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x2, vsx), 
+                                                   _mm_mul_pd(y2, vshx)), vtx))));
+            _mm_storeu_ps(y + i, _mm_movelh_ps(
+                _mm_cvtpd_ps(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x1, vshy), 
+                                                   _mm_mul_pd(y1, vsy)), vty)),
+                _mm_cvtpd_ps(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x2, vshy), 
+                                                   _mm_mul_pd(y2, vsy)), vty))));
+        }
+#endif
+        for(; i < n; i++)
+        {
+            double px = x[i];
+            double py = y[i];
+            transform(&px, &py);
+            x[i] = float(px);
+            y[i] = float(py);
+        }
+    }
+
     //------------------------------------------------------------------------
     inline double trans_affine::scale() const
     {
@@ -511,6 +583,26 @@ namespace agg
         {}
     };
 
+
+    //=========================================================transform_array
+    // Transforms n points stored as separate arrays of x and y with any
+    // transformer, calling its transform() for every point. There are
+    // overloads for the transformations having transform_array().
+    //------------------------------------------------------------------------
+    template<class Transformer> 
+    void transform_array(const Transformer& trans, double* x, double* y, unsigned n)
+    {
+        unsigned i;
+        for(i = 0; i < n; i++) trans.transform(x + i, y + i);
+    }
+
+    //------------------------------------------------------------------------
+    inline void transform_array(const trans_affine& trans, 
+                                double* x, double* y, unsigned n)
+    {
+        trans.transform_array(x, y, n);
+    }
+
 }
 
 
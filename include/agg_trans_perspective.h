@@ -204,6 +204,11 @@ namespace agg
         // direct transformations. 
         void inverse_transform(double* x, double* y) const;
 
+        // Direct transformation of n points stored as separate arrays
+        // of x and y. The result is the same as of transform().
+        void transform_array(double* x, double* y, unsigned n) const;
+        void transform_array(float*  x, float*  y, unsigned n) const;
+
 
         //---------------------------------------------------------- Auxiliary
         const trans_perspective& from_affine(const trans_affine& a);
@@ -576,6 +581,68 @@ namespace agg
         *py = m * (x*shy + y*sy  + ty);
     }
 
+    //------------------------------------------------------------------------
+    inline void trans_perspective::transform_array(double* x, double* y, 
+                                                   unsigned n) const
+    {
+        unsigned i = 0;
+#ifdef AGG_SIMD_SSE2
+        __m128d vsx  = _mm_set1_pd(sx);
+        __m128d vshy = _mm_set1_pd(shy);
+        __m128d vw0  = _mm_set1_pd(w0);
+        __m128d vshx = _mm_set1_pd(shx);
+        __m128d vsy  = _mm_set1_pd(sy);
+        __m128d vw1  = _mm_set1_pd(w1);
+        __m128d vtx  = _mm_set1_pd(tx);
+        __m128d vty  = _mm_set1_pd(ty);
+        __m128d vw2  = _mm_set1_pd(w2);
+        __m128d one  = _mm_set1_pd(1.0);
+        for(; i + 2 <= n; i += 2)
+        {
+            __m128d vx = _mm_loadu_pd(x + i);
+            __m128d vy = _mm_loadu_pd(y + i);
+            __m128d d  = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vw0), 
+                                               _mm_mul_pd(vy, vw1)), vw2);
+            __m128d px = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vsx), 
+                                               _mm_mul_pd(vy, vshx)), vtx);
+            __m128d py = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vshy), 
+                                               _mm_mul_pd(vy, vsy)), vty);
+            __m128d m  = _mm_div_pd(one, d);
+            _mm_storeu_pd(x + i, _mm_mul_pd(m, px));
+            _mm_storeu_pd(y + i, _mm_mul_pd(m, py));
+        }
+#endif
+        for(; i < n; i++) transform(x + i, y + i);
+    }
+
+    //------------------------------------------------------------------------
+    // The calculations are done in double, like for the single points.
+    inline void trans_perspective::transform_array(float* x, float* y, 
+                                                   unsigned n) const
+    {
+        double bx[64];
+        double by[64];
+        while(n)
+        {
+            unsigned len = (n < 64) ? n : 64;
+            unsigned i;
+            for(i = 0; i < len; i++)
+            {
+                bx[i] = x[i];
+                by[i] = y[i];
+            }
+            transform_array(bx, by, len);
+            for(i = 0; i < len; i++)
+            {
+                x[i] = float(bx[i]);
+                y[i] = float(by[i]);
+            }
+            x += len;
+            y += len;
+            n -= len;
+        }
+    }
+
     //------------------------------------------------------------------------
     inline void trans_perspective::transform_affine(double* x, double* y) const
     {
@@ -724,6 +791,12 @@ namespace agg
         *y = sqrt(shy * shy + sy  * sy);
     }
 
+    //------------------------------------------------------------------------
+    inline void transform_array(const trans_perspective& trans, 
+                                double* x, double* y, unsigned n)
+    {
+        trans.transform_array(x, y, n);
+    }
 
 }
 